@@ -0,0 +1,177 @@
+#include "autobaud.h"
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "timer1/timer1.h"
+#include "bits/bits.h"
+#include "utils/utils.h"
+
+
+//! Число интервалов между спадами в символе синхронизации.
+#define AUTOBAUD_INTERVALS      4
+//! Число бит в интервалах символа синхронизации.
+#define AUTOBAUD_BITS           (AUTOBAUD_INTERVALS * 2)
+
+/**
+ * Состояние измерения.
+ */
+typedef struct _Autobaud_State {
+    //! Число переполнений таймера (старшая часть времени).
+    volatile uint16_t overflows;
+    //! Время первого спада.
+    uint32_t first_time;
+    //! Время предыдущего спада.
+    uint32_t prev_time;
+    //! Первый интервал.
+    uint32_t first_interval;
+    //! Число измеренных интервалов.
+    uint8_t intervals;
+    //! Флаг наличия первого спада.
+    bool started;
+    //! Измеренная длительность бита.
+    uint32_t bit_clocks;
+    //! Сохранённые каллбэки таймера.
+    timer_callback_t saved_capture_callback;
+    timer_callback_t saved_overflow_callback;
+    //! Будущее.
+    future_t future;
+}autobaud_state_t;
+
+static autobaud_state_t autobaud_state;
+
+
+/**
+ * Освобождает таймер 1 и завершает будущее.
+ * @param err Код ошибки.
+ */
+static void autobaud_finish(err_t err)
+{
+    timer1_stop();
+    
+    timer1_set_capture_callback(autobaud_state.saved_capture_callback);
+    timer1_set_overflow_callback(autobaud_state.saved_overflow_callback);
+    
+    future_finish(&autobaud_state.future, int_to_pvoid(err));
+}
+
+/**
+ * Начинает измерение с указанного спада.
+ * @param time Время спада.
+ */
+ALWAYS_INLINE static void autobaud_restart(uint32_t time)
+{
+    autobaud_state.first_time = time;
+    autobaud_state.prev_time = time;
+    autobaud_state.intervals = 0;
+    autobaud_state.started = true;
+}
+
+static void autobaud_overflow(void)
+{
+    autobaud_state.overflows ++;
+}
+
+static void autobaud_capture(void)
+{
+    uint16_t icr = ICR1;
+    uint16_t overflows = autobaud_state.overflows;
+    uint32_t time, interval, diff;
+    
+    // Переполнение, произошедшее до захвата, ещё не обработано.
+    if(BIT_TEST(TIFR, TOV1) && icr < 0x8000) overflows ++;
+    
+    time = ((uint32_t)overflows << 16) | icr;
+    
+    if(!autobaud_state.started){
+        autobaud_restart(time);
+        return;
+    }
+    
+    interval = time - autobaud_state.prev_time;
+    
+    if(autobaud_state.intervals == 0){
+        autobaud_state.first_interval = interval;
+    }else{
+        diff = (interval > autobaud_state.first_interval) ?
+                interval - autobaud_state.first_interval :
+                autobaud_state.first_interval - interval;
+        
+        if(diff > autobaud_state.first_interval / AUTOBAUD_TOLERANCE_DIV){
+            // Начнём заново с предыдущего спада.
+            autobaud_restart(autobaud_state.prev_time);
+            autobaud_state.first_interval = interval;
+        }
+    }
+    
+    autobaud_state.prev_time = time;
+    
+    if(++ autobaud_state.intervals < AUTOBAUD_INTERVALS) return;
+    
+    autobaud_state.bit_clocks = (time - autobaud_state.first_time + AUTOBAUD_BITS / 2) / AUTOBAUD_BITS;
+    
+    autobaud_finish(E_NO_ERROR);
+}
+
+err_t autobaud_start(void)
+{
+    if(future_running(&autobaud_state.future)) return E_BUSY;
+    
+    err_t err = timer1_set_mode(TIMER1_MODE_NORMAL);
+    if(err != E_NO_ERROR) return err;
+    
+    err = timer1_set_clock(TIMER1_CLOCK_INTERNAL_SCALE_1);
+    if(err != E_NO_ERROR) return err;
+    
+    timer1_set_ic_edge(TIMER1_INPUT_CAPTURE_FALLING_EDGE);
+    timer1_enable_ic_noise_canseler();
+    
+    autobaud_state.overflows = 0;
+    autobaud_state.started = false;
+    autobaud_state.intervals = 0;
+    autobaud_state.bit_clocks = 0;
+    
+    future_init(&autobaud_state.future);
+    future_start(&autobaud_state.future);
+    
+    timer1_set_counter_value(0);
+    // Сбросим флаги захвата и переполнения.
+    timer1_clear_icf();
+    TIFR = BIT(TOV1);
+    
+    autobaud_state.saved_overflow_callback = timer1_set_overflow_callback(autobaud_overflow);
+    autobaud_state.saved_capture_callback = timer1_set_capture_callback(autobaud_capture);
+    
+    return timer1_start();
+}
+
+void autobaud_stop(void)
+{
+    __interrupts_save_disable();
+    
+    if(future_running(&autobaud_state.future)){
+        autobaud_finish(E_AUTOBAUD_ABORTED);
+    }
+    
+    __interrupts_restore();
+}
+
+bool autobaud_running(void)
+{
+    return future_running(&autobaud_state.future);
+}
+
+future_t* autobaud_future(void)
+{
+    return &autobaud_state.future;
+}
+
+uint32_t autobaud_bit_clocks(void)
+{
+    return autobaud_state.bit_clocks;
+}
+
+err_t autobaud_baud(uart_baud_t* baud)
+{
+    if(autobaud_state.bit_clocks == 0) return E_INVALID_VALUE;
+    
+    return uart_calc_baud_clocks(autobaud_state.bit_clocks, baud);
+}
@@ -0,0 +1,84 @@
+/**
+ * @file autobaud.h
+ * Библиотека автоматического определения скорости UART.
+ *
+ * Скорость определяется по символу синхронизации 0x55 ('U'),
+ * в котором спады на линии (старт-бит и биты 1, 3, 5, 7)
+ * следуют ровно через два бита.
+ * Моменты спадов измеряются захватом таймера 1 (вход ICP1),
+ * поэтому линия RXD должна быть соединена с входом ICP1.
+ * Длительность бита вычисляется по четырём интервалам
+ * между спадами, каждый из которых проверяется на соответствие первому,
+ * что отсеивает мусор и прочие символы.
+ *
+ * На время измерения таймер 1 используется монопольно:
+ * режим NORMAL, тактирование без делителя, захват по спаду.
+ * Обработчик захвата должен успевать за два бита,
+ * что при 16 МГц соответствует скоростям до 115200 бод.
+ */
+
+#ifndef AUTOBAUD_H
+#define	AUTOBAUD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "errors/errors.h"
+#include "future/future.h"
+#include "uart/uart.h"
+
+
+//! Коды ошибок автоопределения скорости.
+#define E_AUTOBAUD              (E_USER + 70)
+//! Измерение прервано.
+#define E_AUTOBAUD_ABORTED      (E_AUTOBAUD + 1)
+
+//! Символ синхронизации.
+#define AUTOBAUD_SYNC_CHAR      0x55
+
+//! Допустимое отклонение интервала между спадами от первого, 1/N.
+#ifndef AUTOBAUD_TOLERANCE_DIV
+#define AUTOBAUD_TOLERANCE_DIV  4
+#endif
+
+
+/**
+ * Запускает измерение скорости.
+ * По окончании измерения будущее autobaud_future()
+ * завершается с кодом ошибки в качестве результата.
+ * @return Код ошибки.
+ */
+extern err_t autobaud_start(void);
+
+/**
+ * Прерывает измерение скорости.
+ * Будущее завершается с кодом E_AUTOBAUD_ABORTED.
+ */
+extern void autobaud_stop(void);
+
+/**
+ * Получает флаг выполнения измерения.
+ * @return Флаг выполнения измерения.
+ */
+extern bool autobaud_running(void);
+
+/**
+ * Получает будущее измерения скорости.
+ * @return Будущее.
+ */
+extern future_t* autobaud_future(void);
+
+/**
+ * Получает измеренную длительность бита.
+ * @return Длительность бита, такты процессора.
+ */
+extern uint32_t autobaud_bit_clocks(void);
+
+/**
+ * Вычисляет наилучшие значения UBRR и U2X
+ * для измеренной длительности бита.
+ * @param baud Параметры скорости передачи.
+ * @return Код ошибки.
+ */
+extern err_t autobaud_baud(uart_baud_t* baud);
+
+#endif	/* AUTOBAUD_H */
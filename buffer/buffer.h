@@ -8,6 +8,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include "buffer_defs.h"
 #include "defs/defs.h"
 
@@ -68,7 +69,7 @@ ALWAYS_INLINE static void buffer_next(buffer_t* buffer)
  * @param buffer Буфер.
  * @return Оставшееся число байт.
  */
-ALWAYS_INLINE static uint8_t buffer_remain(buffer_t* buffer)
+ALWAYS_INLINE static size_t buffer_remain(buffer_t* buffer)
 {
     return buffer->size - buffer->pos;
 }
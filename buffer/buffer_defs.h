@@ -39,7 +39,7 @@
 /**
  * Устанавливает значение V буфера с адресом PTR на позиции P со смещением O.
  */
-#define BUFFER_POS_SET_OFFSET(PTR, P, V) (PTR[P + O] = V)
+#define BUFFER_POS_SET_OFFSET(PTR, P, O, V) (PTR[P + O] = V)
 
 #endif	/* BUFFER_DEFS_H */
 
@@ -0,0 +1,155 @@
+/**
+ * @file buffer_list.h
+ * Функции для работы со списком буферов.
+ *
+ * Список позволяет передать за одну транзакцию
+ * данные из нескольких несмежных областей памяти
+ * (заголовок, адрес регистра, данные, CRC)
+ * без их предварительного копирования в общий буфер.
+ */
+
+#ifndef BUFFER_LIST_H
+#define	BUFFER_LIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "buffer.h"
+#include "defs/defs.h"
+
+
+/**
+ * Структура списка буферов.
+ */
+typedef struct _BufferList {
+    buffer_t* buffers;
+    size_t count;
+    size_t index;
+}buffer_list_t;
+
+
+/**
+ * Инициализирует список буферов.
+ * Буферы должны существовать всё время использования списка.
+ * @param list Список буферов.
+ * @param buffers Массив буферов.
+ * @param count Число буферов.
+ */
+ALWAYS_INLINE static void buffer_list_init(buffer_list_t* list, buffer_t* buffers, size_t count)
+{
+    list->buffers = buffers;
+    list->count = (buffers != NULL) ? count : 0;
+    list->index = 0;
+}
+
+/**
+ * Сбрасывает позиции всех буферов списка.
+ * @param list Список буферов.
+ */
+ALWAYS_INLINE static void buffer_list_reset(buffer_list_t* list)
+{
+    size_t i;
+    for(i = 0; i < list->count; i ++){
+        buffer_reset(&list->buffers[i]);
+    }
+    list->index = 0;
+}
+
+/**
+ * Получает флаг валидности списка буферов.
+ * @param list Список буферов.
+ * @return Флаг валидности списка буферов.
+ */
+ALWAYS_INLINE static bool buffer_list_valid(buffer_list_t* list)
+{
+    return list->buffers != NULL && list->count != 0;
+}
+
+/**
+ * Получает суммарный размер буферов списка.
+ * @param list Список буферов.
+ * @return Суммарный размер буферов.
+ */
+ALWAYS_INLINE static size_t buffer_list_size(buffer_list_t* list)
+{
+    size_t i;
+    size_t size = 0;
+    for(i = 0; i < list->count; i ++){
+        size += list->buffers[i].size;
+    }
+    return size;
+}
+
+/**
+ * Получает суммарную позицию в буферах списка.
+ * @param list Список буферов.
+ * @return Число пройденных байт.
+ */
+ALWAYS_INLINE static size_t buffer_list_pos(buffer_list_t* list)
+{
+    size_t i;
+    size_t pos = 0;
+    for(i = 0; i < list->count; i ++){
+        pos += list->buffers[i].pos;
+    }
+    return pos;
+}
+
+/**
+ * Получает флаг наличия следующего байта в списке.
+ * Переходит к следующему буферу, если текущий закончился,
+ * пустые буферы пропускаются.
+ * @param list Список буферов.
+ * @return Флаг наличия следующего байта в списке.
+ */
+ALWAYS_INLINE static bool buffer_list_has_next(buffer_list_t* list)
+{
+    while(list->index < list->count){
+        if(buffer_has_next(&list->buffers[list->index])) return true;
+        list->index ++;
+    }
+    return false;
+}
+
+/**
+ * Получает флаг нахождения указателя перед концом списка.
+ * @param list Список буферов.
+ * @return Флаг нахождения указателя перед концом списка.
+ */
+ALWAYS_INLINE static bool buffer_list_at_last(buffer_list_t* list)
+{
+    size_t i;
+    
+    if(!buffer_list_has_next(list)) return false;
+    if(!buffer_at_last(&list->buffers[list->index])) return false;
+    
+    for(i = list->index + 1; i < list->count; i ++){
+        if(buffer_has_next(&list->buffers[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * Получает байт из списка в текущей позиции, инкрементируя указатель.
+ * Должна вызываться после buffer_list_has_next.
+ * @param list Список буферов.
+ * @return Байт из списка в текущей позиции.
+ */
+ALWAYS_INLINE static uint8_t buffer_list_get_next(buffer_list_t* list)
+{
+    return buffer_get_next(&list->buffers[list->index]);
+}
+
+/**
+ * Записывает байт в список в текущую позицию, инкрементируя указатель.
+ * Должна вызываться после buffer_list_has_next.
+ * @param list Список буферов.
+ * @param byte Байт.
+ */
+ALWAYS_INLINE static void buffer_list_set_next(buffer_list_t* list, uint8_t byte)
+{
+    buffer_set_next(&list->buffers[list->index], byte);
+}
+
+
+#endif	/* BUFFER_LIST_H */
@@ -3,6 +3,53 @@
 #include "utils/utils.h"
 
 
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+/**
+ * Проверяет достижение верхнего порога заполнения.
+ * @param buffer Кольцевой буфер.
+ */
+static void circular_buffer_check_high_watermark(circular_buffer_t* buffer)
+{
+    if(buffer->above_high_watermark || buffer->watermark_callback == NULL) return;
+    
+    if(buffer->count >= buffer->high_watermark){
+        buffer->above_high_watermark = true;
+        buffer->watermark_callback(buffer, true);
+    }
+}
+
+/**
+ * Проверяет снижение заполнения до нижнего порога.
+ * @param buffer Кольцевой буфер.
+ */
+static void circular_buffer_check_low_watermark(circular_buffer_t* buffer)
+{
+    if(!buffer->above_high_watermark) return;
+    
+    if(buffer->count <= buffer->low_watermark){
+        buffer->above_high_watermark = false;
+        if(buffer->watermark_callback) buffer->watermark_callback(buffer, false);
+    }
+}
+#else
+#define circular_buffer_check_high_watermark(buffer)
+#define circular_buffer_check_low_watermark(buffer)
+#endif
+
+/**
+ * Удаляет данные из кольцевого буфера.
+ * @param buffer Кольцевой буфер.
+ * @param size Размер данных, не более размера данных в буфере.
+ */
+static void circular_buffer_drop(circular_buffer_t* buffer, size_t size)
+{
+    // Увеличим позицию.
+    buffer->get += size;
+    if(buffer->get >= buffer->size) buffer->get -= buffer->size;
+    // Счётчик.
+    buffer->count -= size;
+}
+
 void circular_buffer_init(circular_buffer_t* buffer, uint8_t* ptr, size_t size)
 {
     buffer->ptr = ptr;
@@ -10,6 +57,14 @@ void circular_buffer_init(circular_buffer_t* buffer, uint8_t* ptr, size_t size)
     buffer->get = 0;
     buffer->size = size;
     buffer->count = 0;
+    buffer->dropped = 0;
+    buffer->overwrite = false;
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+    buffer->high_watermark = 0;
+    buffer->low_watermark = 0;
+    buffer->watermark_callback = NULL;
+    buffer->above_high_watermark = false;
+#endif
 }
 
 void circular_buffer_reset(circular_buffer_t* buffer)
@@ -17,6 +72,10 @@ void circular_buffer_reset(circular_buffer_t* buffer)
     buffer->put = 0;
     buffer->get = 0;
     buffer->count = 0;
+    buffer->dropped = 0;
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+    buffer->above_high_watermark = false;
+#endif
 }
 
 bool circular_buffer_valid(circular_buffer_t* buffer)
@@ -39,9 +98,53 @@ size_t circular_buffer_avail_size(circular_buffer_t* buffer)
     return buffer->count;
 }
 
+bool circular_buffer_overwrite(circular_buffer_t* buffer)
+{
+    return buffer->overwrite;
+}
+
+void circular_buffer_set_overwrite(circular_buffer_t* buffer, bool overwrite)
+{
+    buffer->overwrite = overwrite;
+}
+
+size_t circular_buffer_dropped(circular_buffer_t* buffer)
+{
+    return buffer->dropped;
+}
+
+void circular_buffer_reset_dropped(circular_buffer_t* buffer)
+{
+    buffer->dropped = 0;
+}
+
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+void circular_buffer_set_watermarks(circular_buffer_t* buffer, size_t high, size_t low,
+                                    circular_buffer_watermark_callback_t callback)
+{
+    buffer->high_watermark = high;
+    buffer->low_watermark = low;
+    buffer->watermark_callback = callback;
+    buffer->above_high_watermark = false;
+}
+
+bool circular_buffer_above_high_watermark(circular_buffer_t* buffer)
+{
+    return buffer->above_high_watermark;
+}
+#endif
+
 size_t circular_buffer_put(circular_buffer_t* buffer, uint8_t data)
 {
-    if(buffer->count == buffer->size) return 0;
+    if(buffer->count == buffer->size){
+        if(!buffer->overwrite) return 0;
+        
+        // Вытесним самый старый байт.
+        CYCLIC_INC(buffer->get, 0, buffer->size);
+        
+        buffer->count --;
+        buffer->dropped ++;
+    }
     
     buffer->ptr[buffer->put] = data;
     
@@ -49,6 +152,8 @@ size_t circular_buffer_put(circular_buffer_t* buffer, uint8_t data)
     
     buffer->count ++;
     
+    circular_buffer_check_high_watermark(buffer);
+    
     return 1;
 }
 
@@ -62,6 +167,8 @@ size_t circular_buffer_get(circular_buffer_t* buffer, uint8_t* data)
     
     buffer->count --;
     
+    circular_buffer_check_low_watermark(buffer);
+    
     return 1;
 }
 
@@ -77,6 +184,21 @@ size_t circular_buffer_peek(circular_buffer_t* buffer, uint8_t* data)
 size_t circular_buffer_write(circular_buffer_t* buffer, const uint8_t* data, size_t size)
 {
     size_t n, part1;//, part2;
+    size_t res_size = size;
+    
+    // Если места недостаточно в режиме перезаписи - вытесним старые данные.
+    if(buffer->overwrite && buffer->size - buffer->count < size){
+        // Если данные больше буфера - запишем только их конец.
+        if(size > buffer->size){
+            n = size - buffer->size;
+            buffer->dropped += n;
+            data += n;
+            size = buffer->size;
+        }
+        n = size - (buffer->size - buffer->count);
+        buffer->dropped += n;
+        circular_buffer_drop(buffer, n);
+    }
     
     // Если места недостаточно или размер данных равен 0 - возврат 0.
     if(buffer->size - buffer->count < size || size == 0) return 0;
@@ -135,7 +257,9 @@ size_t circular_buffer_write(circular_buffer_t* buffer, const uint8_t* data, siz
         buffer->count += size;
     }
     
-    return size;
+    circular_buffer_check_high_watermark(buffer);
+    
+    return res_size;
 }
 
 size_t circular_buffer_read(circular_buffer_t* buffer, uint8_t* data, size_t size)
@@ -205,6 +329,61 @@ size_t circular_buffer_read(circular_buffer_t* buffer, uint8_t* data, size_t siz
         buffer->get += n;
     }
     
+    circular_buffer_check_low_watermark(buffer);
+    
     return res_size;
 }
 
+size_t circular_buffer_write_region(circular_buffer_t* buffer, uint8_t** ptr)
+{
+    *ptr = buffer->ptr + buffer->put;
+    
+    // Буфер полон.
+    if(buffer->count == buffer->size) return 0;
+    
+    // Свободное место до конца памяти буфера.
+    if(buffer->put >= buffer->get) return buffer->size - buffer->put;
+    
+    // Свободное место до индекса чтения.
+    return buffer->get - buffer->put;
+}
+
+size_t circular_buffer_commit(circular_buffer_t* buffer, size_t size)
+{
+    size = MIN(size, buffer->size - buffer->count);
+    
+    // Увеличим позицию.
+    buffer->put += size;
+    if(buffer->put >= buffer->size) buffer->put -= buffer->size;
+    // Счётчик.
+    buffer->count += size;
+    
+    circular_buffer_check_high_watermark(buffer);
+    
+    return size;
+}
+
+size_t circular_buffer_peek_region(circular_buffer_t* buffer, const uint8_t** ptr)
+{
+    *ptr = buffer->ptr + buffer->get;
+    
+    // Буфер пуст.
+    if(buffer->count == 0) return 0;
+    
+    // Данные до индекса записи.
+    if(buffer->get < buffer->put) return buffer->put - buffer->get;
+    
+    // Данные до конца памяти буфера.
+    return buffer->size - buffer->get;
+}
+
+size_t circular_buffer_consume(circular_buffer_t* buffer, size_t size)
+{
+    size = MIN(size, buffer->count);
+    
+    circular_buffer_drop(buffer, size);
+    
+    circular_buffer_check_low_watermark(buffer);
+    
+    return size;
+}
@@ -11,16 +11,41 @@
 #include <stdbool.h>
 
 
+//! Тип кольцевого буфера.
+typedef struct _CircularBuffer circular_buffer_t;
+
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+/**
+ * Тип каллбэка пересечения порогов заполнения.
+ * Вызывается из контекста писателя при достижении верхнего порога
+ * и из контекста читателя при снижении до нижнего порога.
+ * @param buffer Кольцевой буфер.
+ * @param high true при достижении верхнего порога, false - нижнего.
+ */
+typedef void (*circular_buffer_watermark_callback_t)(circular_buffer_t* buffer, bool high);
+#endif
+
 /**
  * Структура кольцевого буфера.
+ * Пороги заполнения доступны при определённом
+ * CIRCULAR_BUFFER_WATERMARKS, который должен быть
+ * одинаковым для всех единиц трансляции.
  */
-typedef struct _CircularBuffer {
+struct _CircularBuffer {
     uint8_t* ptr;
     size_t put;
     size_t get;
     size_t size;
     size_t count;
-}circular_buffer_t;
+    size_t dropped;
+    bool overwrite;
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+    size_t high_watermark;
+    size_t low_watermark;
+    circular_buffer_watermark_callback_t watermark_callback;
+    bool above_high_watermark;
+#endif
+};
 
 
 /**
@@ -65,8 +90,65 @@ extern size_t circular_buffer_free_size(circular_buffer_t* buffer);
  */
 extern size_t circular_buffer_avail_size(circular_buffer_t* buffer);
 
+/**
+ * Получает флаг режима перезаписи.
+ * @param buffer Кольцевой буфер.
+ * @return Флаг режима перезаписи.
+ */
+extern bool circular_buffer_overwrite(circular_buffer_t* buffer);
+
+/**
+ * Устанавливает режим перезаписи.
+ * В режиме перезаписи при нехватке места
+ * самые старые данные вытесняются новыми.
+ * Вытеснение сдвигает индекс чтения, поэтому запись
+ * делает недействительной область circular_buffer_peek_region,
+ * а последующий circular_buffer_consume извлечёт новые данные.
+ * Если запись выполняется в прерывании, чтение без копирования
+ * в режиме перезаписи недопустимо.
+ * @param buffer Кольцевой буфер.
+ * @param overwrite Флаг режима перезаписи.
+ */
+extern void circular_buffer_set_overwrite(circular_buffer_t* buffer, bool overwrite);
+
+/**
+ * Получает число данных, вытесненных в режиме перезаписи.
+ * @param buffer Кольцевой буфер.
+ * @return Число вытесненных данных.
+ */
+extern size_t circular_buffer_dropped(circular_buffer_t* buffer);
+
+/**
+ * Сбрасывает счётчик вытесненных данных.
+ * @param buffer Кольцевой буфер.
+ */
+extern void circular_buffer_reset_dropped(circular_buffer_t* buffer);
+
+#ifdef CIRCULAR_BUFFER_WATERMARKS
+/**
+ * Устанавливает пороги заполнения кольцевого буфера.
+ * Каллбэк вызывается однократно при достижении верхнего порога,
+ * и однократно при последующем снижении заполнения до нижнего порога.
+ * @param buffer Кольцевой буфер.
+ * @param high Верхний порог, не более размера буфера.
+ * @param low Нижний порог, меньше верхнего.
+ * @param callback Каллбэк, NULL для отключения.
+ */
+extern void circular_buffer_set_watermarks(circular_buffer_t* buffer, size_t high, size_t low,
+                                           circular_buffer_watermark_callback_t callback);
+
+/**
+ * Получает флаг нахождения заполнения выше верхнего порога
+ * (верхний порог достигнут, а нижний после этого - нет).
+ * @param buffer Кольцевой буфер.
+ * @return Флаг нахождения заполнения выше верхнего порога.
+ */
+extern bool circular_buffer_above_high_watermark(circular_buffer_t* buffer);
+#endif
+
 /**
  * Помещает байт данных в кольцевой буфер.
+ * В режиме перезаписи всегда помещает байт, вытесняя самый старый.
  * @param buffer Кольцевой буфер.
  * @param data Байт данных.
  * @return Число помещённых данных в кольцевой буфер (ноль если места недостаточно).
@@ -91,6 +173,8 @@ extern size_t circular_buffer_peek(circular_buffer_t* buffer, uint8_t* data);
 
 /**
  * Помещает данные в кольцевой буфер.
+ * В режиме перезаписи всегда помещает данные, вытесняя самые старые;
+ * если данные больше буфера - сохраняется их конец.
  * @param buffer Кольцевой буфер.
  * @param data Данные.
  * @param size Размер данных.
@@ -107,5 +191,44 @@ extern size_t circular_buffer_write(circular_buffer_t* buffer, const uint8_t* da
  */
 extern size_t circular_buffer_read(circular_buffer_t* buffer, uint8_t* data, size_t size);
 
+/**
+ * Получает наибольшую непрерывную область кольцевого буфера,
+ * доступную для записи без копирования.
+ * После записи данных в область их необходимо зафиксировать
+ * вызовом circular_buffer_commit.
+ * @param buffer Кольцевой буфер.
+ * @param ptr Указатель для адреса области.
+ * @return Размер области (ноль если места нет).
+ */
+extern size_t circular_buffer_write_region(circular_buffer_t* buffer, uint8_t** ptr);
+
+/**
+ * Фиксирует данные, записанные в область
+ * полученную circular_buffer_write_region.
+ * @param buffer Кольцевой буфер.
+ * @param size Размер записанных данных.
+ * @return Число зафиксированных данных (не более свободного места).
+ */
+extern size_t circular_buffer_commit(circular_buffer_t* buffer, size_t size);
+
+/**
+ * Получает наибольшую непрерывную область кольцевого буфера
+ * с данными, доступную для чтения без копирования.
+ * Данные остаются в буфере до вызова circular_buffer_consume.
+ * В режиме перезаписи область действительна только до следующей записи.
+ * @param buffer Кольцевой буфер.
+ * @param ptr Указатель для адреса области.
+ * @return Размер области (ноль если нет данных).
+ */
+extern size_t circular_buffer_peek_region(circular_buffer_t* buffer, const uint8_t** ptr);
+
+/**
+ * Извлекает данные из кольцевого буфера без копирования.
+ * @param buffer Кольцевой буфер.
+ * @param size Размер данных.
+ * @return Число извлечённых данных (не более размера данных в буфере).
+ */
+extern size_t circular_buffer_consume(circular_buffer_t* buffer, size_t size);
+
 #endif	/* CIRCULAR_BUFFER_H */
 
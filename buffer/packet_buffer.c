@@ -0,0 +1,94 @@
+
+#include "packet_buffer.h"
+#include "utils/utils.h"
+
+
+void packet_buffer_init(packet_buffer_t* buffer, uint8_t* ptr, size_t size)
+{
+    circular_buffer_init(&buffer->buffer, ptr, size);
+}
+
+void packet_buffer_reset(packet_buffer_t* buffer)
+{
+    circular_buffer_reset(&buffer->buffer);
+}
+
+bool packet_buffer_valid(packet_buffer_t* buffer)
+{
+    return circular_buffer_valid(&buffer->buffer);
+}
+
+size_t packet_buffer_free_size(packet_buffer_t* buffer)
+{
+    size_t free_size = circular_buffer_free_size(&buffer->buffer);
+    
+    if(free_size <= PACKET_BUFFER_HEADER_SIZE) return 0;
+    
+    return MIN(free_size - PACKET_BUFFER_HEADER_SIZE, PACKET_BUFFER_PACKET_SIZE_MAX);
+}
+
+size_t packet_buffer_next_size(packet_buffer_t* buffer)
+{
+    uint8_t size;
+    
+    if(!circular_buffer_peek(&buffer->buffer, &size)) return 0;
+    
+    // Пакет ещё не помещён целиком.
+    if(circular_buffer_avail_size(&buffer->buffer) < PACKET_BUFFER_HEADER_SIZE + size) return 0;
+    
+    return size;
+}
+
+size_t packet_buffer_write(packet_buffer_t* buffer, const uint8_t* data, size_t size)
+{
+    if(size == 0 || size > PACKET_BUFFER_PACKET_SIZE_MAX) return 0;
+    // Места должно хватить и для заголовка, и для данных.
+    if(circular_buffer_free_size(&buffer->buffer) < PACKET_BUFFER_HEADER_SIZE + size) return 0;
+    
+    circular_buffer_put(&buffer->buffer, (packet_buffer_size_t)size);
+    circular_buffer_write(&buffer->buffer, data, size);
+    
+    return size;
+}
+
+size_t packet_buffer_read(packet_buffer_t* buffer, uint8_t* data, size_t size)
+{
+    size_t packet_size = packet_buffer_next_size(buffer);
+    
+    if(packet_size == 0 || packet_size > size) return 0;
+    
+    circular_buffer_consume(&buffer->buffer, PACKET_BUFFER_HEADER_SIZE);
+    circular_buffer_read(&buffer->buffer, data, packet_size);
+    
+    return packet_size;
+}
+
+size_t packet_buffer_read_batch(packet_buffer_t* buffer, uint8_t* data, size_t size,
+                                packet_buffer_size_t* sizes, size_t count)
+{
+    size_t packet_size;
+    size_t n = 0;
+    
+    while(n < count){
+        packet_size = packet_buffer_read(buffer, data, size);
+        if(packet_size == 0) break;
+        
+        sizes[n ++] = (packet_buffer_size_t)packet_size;
+        
+        data += packet_size;
+        size -= packet_size;
+    }
+    
+    return n;
+}
+
+size_t packet_buffer_skip(packet_buffer_t* buffer)
+{
+    size_t packet_size = packet_buffer_next_size(buffer);
+    
+    if(packet_size == 0) return 0;
+    
+    circular_buffer_consume(&buffer->buffer, PACKET_BUFFER_HEADER_SIZE + packet_size);
+    
+    return packet_size;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file packet_buffer.h
+ * Функции для работы с буфером пакетов переменной длины
+ * на основе кольцевого буфера.
+ *
+ * Каждый пакет хранится с заголовком, содержащим его длину.
+ * Пакет помещается в буфер целиком, либо не помещается вовсе,
+ * незавершённый пакет читателю не виден.
+ */
+
+#ifndef PACKET_BUFFER_H
+#define	PACKET_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "circular_buffer.h"
+
+
+/**
+ * Тип длины пакета (заголовок пакета).
+ */
+typedef uint8_t packet_buffer_size_t;
+
+//! Размер заголовка пакета.
+#define PACKET_BUFFER_HEADER_SIZE sizeof(packet_buffer_size_t)
+
+//! Максимальный размер пакета.
+#define PACKET_BUFFER_PACKET_SIZE_MAX 255
+
+/**
+ * Структура буфера пакетов.
+ */
+typedef struct _PacketBuffer {
+    circular_buffer_t buffer;
+}packet_buffer_t;
+
+
+/**
+ * Инициализирует буфер пакетов.
+ * @param buffer Буфер пакетов.
+ * @param ptr Указатель на память для буфера.
+ * @param size Размер буфера.
+ */
+extern void packet_buffer_init(packet_buffer_t* buffer, uint8_t* ptr, size_t size);
+
+/**
+ * Сбрасывает буфер пакетов.
+ * @param buffer Буфер пакетов.
+ */
+extern void packet_buffer_reset(packet_buffer_t* buffer);
+
+/**
+ * Получает флаг валидности буфера пакетов.
+ * @param buffer Буфер пакетов.
+ * @return Флаг валидности буфера пакетов.
+ */
+extern bool packet_buffer_valid(packet_buffer_t* buffer);
+
+/**
+ * Получает максимальный размер пакета,
+ * который может быть помещён в буфер.
+ * @param buffer Буфер пакетов.
+ * @return Максимальный размер пакета.
+ */
+extern size_t packet_buffer_free_size(packet_buffer_t* buffer);
+
+/**
+ * Получает размер следующего пакета без извлечения из буфера.
+ * @param buffer Буфер пакетов.
+ * @return Размер пакета (ноль если пакетов нет).
+ */
+extern size_t packet_buffer_next_size(packet_buffer_t* buffer);
+
+/**
+ * Помещает пакет в буфер.
+ * @param buffer Буфер пакетов.
+ * @param data Данные пакета.
+ * @param size Размер пакета.
+ * @return Размер помещённого пакета (ноль если места недостаточно).
+ */
+extern size_t packet_buffer_write(packet_buffer_t* buffer, const uint8_t* data, size_t size);
+
+/**
+ * Извлекает пакет из буфера.
+ * Если пакет не умещается в буфер для данных - он остаётся в буфере пакетов.
+ * @param buffer Буфер пакетов.
+ * @param data Буфер для данных пакета.
+ * @param size Размер буфера для данных.
+ * @return Размер извлечённого пакета (ноль если пакетов нет).
+ */
+extern size_t packet_buffer_read(packet_buffer_t* buffer, uint8_t* data, size_t size);
+
+/**
+ * Извлекает несколько пакетов из буфера.
+ * Данные пакетов размещаются подряд,
+ * размеры пакетов записываются в массив sizes.
+ * @param buffer Буфер пакетов.
+ * @param data Буфер для данных пакетов.
+ * @param size Размер буфера для данных.
+ * @param sizes Массив для размеров пакетов.
+ * @param count Максимальное число пакетов.
+ * @return Число извлечённых пакетов.
+ */
+extern size_t packet_buffer_read_batch(packet_buffer_t* buffer, uint8_t* data, size_t size,
+                                       packet_buffer_size_t* sizes, size_t count);
+
+/**
+ * Удаляет следующий пакет из буфера.
+ * @param buffer Буфер пакетов.
+ * @return Размер удалённого пакета (ноль если пакетов нет).
+ */
+extern size_t packet_buffer_skip(packet_buffer_t* buffer);
+
+#endif	/* PACKET_BUFFER_H */
@@ -0,0 +1,101 @@
+
+#include "record_queue.h"
+#include <string.h>
+#include "utils/utils.h"
+
+
+err_t record_queue_init(record_queue_t* queue, uint8_t* ptr, size_t record_size, size_t capacity)
+{
+    if(ptr == NULL) return E_NULL_POINTER;
+    if(record_size == 0 || capacity == 0) return E_INVALID_VALUE;
+    
+    circular_buffer_init(&queue->buffer, ptr, record_size * capacity);
+    
+    queue->record_size = record_size;
+    queue->capacity = capacity;
+    queue->count = 0;
+    
+    return E_NO_ERROR;
+}
+
+void record_queue_reset(record_queue_t* queue)
+{
+    circular_buffer_reset(&queue->buffer);
+    
+    queue->count = 0;
+}
+
+size_t record_queue_record_size(record_queue_t* queue)
+{
+    return queue->record_size;
+}
+
+size_t record_queue_capacity(record_queue_t* queue)
+{
+    return queue->capacity;
+}
+
+size_t record_queue_count(record_queue_t* queue)
+{
+    return queue->count;
+}
+
+size_t record_queue_free_count(record_queue_t* queue)
+{
+    return queue->capacity - queue->count;
+}
+
+size_t record_queue_push(record_queue_t* queue, const void* record)
+{
+    // Запись помещается целиком, либо не помещается вовсе.
+    if(circular_buffer_write(&queue->buffer, record, queue->record_size) == 0) return 0;
+    
+    queue->count ++;
+    
+    return 1;
+}
+
+size_t record_queue_pop(record_queue_t* queue, void* record)
+{
+    if(queue->count == 0) return 0;
+    
+    circular_buffer_read(&queue->buffer, record, queue->record_size);
+    
+    queue->count --;
+    
+    return 1;
+}
+
+size_t record_queue_pop_n(record_queue_t* queue, void* records, size_t count)
+{
+    count = MIN(count, queue->count);
+    
+    if(count == 0) return 0;
+    
+    // Размер данных в буфере кратен размеру записи,
+    // поэтому извлекаются только целые записи.
+    circular_buffer_read(&queue->buffer, records, queue->record_size * count);
+    
+    queue->count -= count;
+    
+    return count;
+}
+
+size_t record_queue_peek(record_queue_t* queue, void* record)
+{
+    const uint8_t* ptr;
+    size_t part1;
+    
+    if(queue->count == 0) return 0;
+    
+    // Запись может быть разделена концом памяти буфера.
+    part1 = MIN(circular_buffer_peek_region(&queue->buffer, &ptr), queue->record_size);
+    
+    memcpy(record, ptr, part1);
+    
+    if(part1 < queue->record_size){
+        memcpy((uint8_t*)record + part1, queue->buffer.ptr, queue->record_size - part1);
+    }
+    
+    return 1;
+}
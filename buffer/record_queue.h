@@ -0,0 +1,129 @@
+/**
+ * @file record_queue.h
+ * Функции для работы с очередью записей фиксированного размера
+ * на основе кольцевого буфера.
+ *
+ * Записи помещаются и извлекаются только целиком.
+ * При обращении к очереди из прерывания и из основного цикла
+ * доступ из основного цикла необходимо выполнять
+ * с запрещёнными прерываниями.
+ */
+
+#ifndef RECORD_QUEUE_H
+#define	RECORD_QUEUE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "errors/errors.h"
+#include "circular_buffer.h"
+
+
+/**
+ * Объявляет память для очереди записей.
+ * @param NAME Имя массива памяти.
+ * @param TYPE Тип записи.
+ * @param COUNT Число записей.
+ */
+#define RECORD_QUEUE_MEMORY(NAME, TYPE, COUNT) uint8_t NAME[sizeof(TYPE) * (COUNT)]
+
+/**
+ * Инициализирует очередь записей в памяти,
+ * объявленной с помощью RECORD_QUEUE_MEMORY.
+ * @param QUEUE Очередь записей.
+ * @param NAME Имя массива памяти.
+ * @param TYPE Тип записи.
+ */
+#define RECORD_QUEUE_INIT(QUEUE, NAME, TYPE)\
+                record_queue_init(QUEUE, NAME, sizeof(TYPE), sizeof(NAME) / sizeof(TYPE))
+                
+/**
+ * Структура очереди записей.
+ */
+typedef struct _RecordQueue {
+    circular_buffer_t buffer;
+    size_t record_size;
+    size_t capacity;
+    size_t count;
+}record_queue_t;
+
+
+/**
+ * Инициализирует очередь записей.
+ * @param queue Очередь записей.
+ * @param ptr Указатель на память для очереди
+ * размером не менее record_size * capacity.
+ * @param record_size Размер записи.
+ * @param capacity Число записей.
+ * @return Код ошибки.
+ */
+extern err_t record_queue_init(record_queue_t* queue, uint8_t* ptr, size_t record_size, size_t capacity);
+
+/**
+ * Сбрасывает очередь записей.
+ * @param queue Очередь записей.
+ */
+extern void record_queue_reset(record_queue_t* queue);
+
+/**
+ * Получает размер записи.
+ * @param queue Очередь записей.
+ * @return Размер записи.
+ */
+extern size_t record_queue_record_size(record_queue_t* queue);
+
+/**
+ * Получает максимальное число записей в очереди.
+ * @param queue Очередь записей.
+ * @return Максимальное число записей.
+ */
+extern size_t record_queue_capacity(record_queue_t* queue);
+
+/**
+ * Получает число записей в очереди.
+ * @param queue Очередь записей.
+ * @return Число записей.
+ */
+extern size_t record_queue_count(record_queue_t* queue);
+
+/**
+ * Получает число свободных мест для записей в очереди.
+ * @param queue Очередь записей.
+ * @return Число свободных мест.
+ */
+extern size_t record_queue_free_count(record_queue_t* queue);
+
+/**
+ * Помещает запись в очередь.
+ * @param queue Очередь записей.
+ * @param record Запись.
+ * @return Число помещённых записей (ноль если места недостаточно).
+ */
+extern size_t record_queue_push(record_queue_t* queue, const void* record);
+
+/**
+ * Извлекает запись из очереди.
+ * @param queue Очередь записей.
+ * @param record Указатель на запись.
+ * @return Число извлечённых записей (ноль если очередь пуста).
+ */
+extern size_t record_queue_pop(record_queue_t* queue, void* record);
+
+/**
+ * Извлекает несколько записей из очереди.
+ * @param queue Очередь записей.
+ * @param records Указатель на массив записей.
+ * @param count Максимальное число записей.
+ * @return Число извлечённых записей.
+ */
+extern size_t record_queue_pop_n(record_queue_t* queue, void* records, size_t count);
+
+/**
+ * Получает запись из очереди без извлечения.
+ * @param queue Очередь записей.
+ * @param record Указатель на запись.
+ * @return Число полученных записей (ноль если очередь пуста).
+ */
+extern size_t record_queue_peek(record_queue_t* queue, void* record);
+
+#endif	/* RECORD_QUEUE_H */
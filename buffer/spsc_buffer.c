@@ -0,0 +1,214 @@
+
+#include "spsc_buffer.h"
+#include <string.h>
+#include "utils/utils.h"
+
+
+/**
+ * Барьер памяти.
+ * Не позволяет переупорядочить доступ к данным
+ * буфера и публикацию индекса.
+ */
+#ifdef __AVR__
+#define spsc_buffer_barrier() __asm__ __volatile__("" ::: "memory")
+#else
+#define spsc_buffer_barrier() __sync_synchronize()
+#endif
+
+
+err_t spsc_buffer_init(spsc_buffer_t* buffer, uint8_t* ptr, size_t size)
+{
+    if(ptr == NULL) return E_NULL_POINTER;
+    // Размер должен быть ненулевой степенью двойки.
+    if(size == 0 || (size & (size - 1)) != 0) return E_INVALID_VALUE;
+    if(size > SPSC_BUFFER_SIZE_MAX) return E_OUT_OF_RANGE;
+    
+    buffer->ptr = ptr;
+    buffer->mask = (spsc_buffer_index_t)(size - 1);
+    buffer->put = 0;
+    buffer->get = 0;
+    
+    return E_NO_ERROR;
+}
+
+void spsc_buffer_reset(spsc_buffer_t* buffer)
+{
+    buffer->put = 0;
+    buffer->get = 0;
+}
+
+bool spsc_buffer_valid(spsc_buffer_t* buffer)
+{
+    return buffer->ptr != NULL;
+}
+
+size_t spsc_buffer_size(spsc_buffer_t* buffer)
+{
+    return (size_t)buffer->mask + 1;
+}
+
+size_t spsc_buffer_free_size(spsc_buffer_t* buffer)
+{
+    return spsc_buffer_size(buffer) - spsc_buffer_avail_size(buffer);
+}
+
+size_t spsc_buffer_avail_size(spsc_buffer_t* buffer)
+{
+    return (spsc_buffer_index_t)(buffer->put - buffer->get);
+}
+
+size_t spsc_buffer_put(spsc_buffer_t* buffer, uint8_t data)
+{
+    spsc_buffer_index_t put = buffer->put;
+    
+    // Буфер полон.
+    if((spsc_buffer_index_t)(put - buffer->get) > buffer->mask) return 0;
+    
+    buffer->ptr[put & buffer->mask] = data;
+    
+    // Публикуем данные только после записи.
+    spsc_buffer_barrier();
+    
+    buffer->put = put + 1;
+    
+    return 1;
+}
+
+size_t spsc_buffer_get(spsc_buffer_t* buffer, uint8_t* data)
+{
+    spsc_buffer_index_t get = buffer->get;
+    
+    if(get == buffer->put) return 0;
+    
+    spsc_buffer_barrier();
+    
+    *data = buffer->ptr[get & buffer->mask];
+    
+    // Освобождаем место только после чтения.
+    spsc_buffer_barrier();
+    
+    buffer->get = get + 1;
+    
+    return 1;
+}
+
+size_t spsc_buffer_peek(spsc_buffer_t* buffer, uint8_t* data)
+{
+    spsc_buffer_index_t get = buffer->get;
+    
+    if(get == buffer->put) return 0;
+    
+    spsc_buffer_barrier();
+    
+    *data = buffer->ptr[get & buffer->mask];
+    
+    return 1;
+}
+
+size_t spsc_buffer_write(spsc_buffer_t* buffer, const uint8_t* data, size_t size)
+{
+    spsc_buffer_index_t put = buffer->put;
+    size_t free_size = spsc_buffer_size(buffer) - (spsc_buffer_index_t)(put - buffer->get);
+    size_t pos, part1;
+    
+    // Если места недостаточно или размер данных равен 0 - возврат 0.
+    if(free_size < size || size == 0) return 0;
+    
+    pos = put & buffer->mask;
+    // Часть данных до конца памяти буфера.
+    part1 = MIN(spsc_buffer_size(buffer) - pos, size);
+    
+    memcpy(buffer->ptr + pos, data, part1);
+    // Остаток - в начало памяти буфера.
+    if(part1 < size){
+        memcpy(buffer->ptr, data + part1, size - part1);
+    }
+    
+    spsc_buffer_barrier();
+    
+    buffer->put = put + (spsc_buffer_index_t)size;
+    
+    return size;
+}
+
+size_t spsc_buffer_read(spsc_buffer_t* buffer, uint8_t* data, size_t size)
+{
+    spsc_buffer_index_t get = buffer->get;
+    size_t avail_size = (spsc_buffer_index_t)(buffer->put - get);
+    size_t pos, part1;
+    
+    // Если в буфере нет данных, или размер данных равен 0 - возврат 0.
+    if(avail_size == 0 || size == 0) return 0;
+    
+    spsc_buffer_barrier();
+    
+    size = MIN(avail_size, size);
+    
+    pos = get & buffer->mask;
+    // Часть данных до конца памяти буфера.
+    part1 = MIN(spsc_buffer_size(buffer) - pos, size);
+    
+    memcpy(data, buffer->ptr + pos, part1);
+    // Остаток - из начала памяти буфера.
+    if(part1 < size){
+        memcpy(data + part1, buffer->ptr, size - part1);
+    }
+    
+    spsc_buffer_barrier();
+    
+    buffer->get = get + (spsc_buffer_index_t)size;
+    
+    return size;
+}
+
+size_t spsc_buffer_write_region(spsc_buffer_t* buffer, uint8_t** ptr)
+{
+    spsc_buffer_index_t put = buffer->put;
+    size_t free_size = spsc_buffer_size(buffer) - (spsc_buffer_index_t)(put - buffer->get);
+    size_t pos = put & buffer->mask;
+    
+    *ptr = buffer->ptr + pos;
+    
+    return MIN(free_size, spsc_buffer_size(buffer) - pos);
+}
+
+size_t spsc_buffer_commit(spsc_buffer_t* buffer, size_t size)
+{
+    spsc_buffer_index_t put = buffer->put;
+    size_t free_size = spsc_buffer_size(buffer) - (spsc_buffer_index_t)(put - buffer->get);
+    
+    size = MIN(size, free_size);
+    
+    spsc_buffer_barrier();
+    
+    buffer->put = put + (spsc_buffer_index_t)size;
+    
+    return size;
+}
+
+size_t spsc_buffer_peek_region(spsc_buffer_t* buffer, const uint8_t** ptr)
+{
+    spsc_buffer_index_t get = buffer->get;
+    size_t avail_size = (spsc_buffer_index_t)(buffer->put - get);
+    size_t pos = get & buffer->mask;
+    
+    spsc_buffer_barrier();
+    
+    *ptr = buffer->ptr + pos;
+    
+    return MIN(avail_size, spsc_buffer_size(buffer) - pos);
+}
+
+size_t spsc_buffer_consume(spsc_buffer_t* buffer, size_t size)
+{
+    spsc_buffer_index_t get = buffer->get;
+    size_t avail_size = (spsc_buffer_index_t)(buffer->put - get);
+    
+    size = MIN(size, avail_size);
+    
+    spsc_buffer_barrier();
+    
+    buffer->get = get + (spsc_buffer_index_t)size;
+    
+    return size;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file spsc_buffer.h
+ * Функции для работы с кольцевым буфером
+ * с одним писателем и одним читателем без блокировок.
+ *
+ * Писатель изменяет только индекс записи,
+ * читатель - только индекс чтения,
+ * поэтому обращение к буферу из прерывания и из основного цикла
+ * не требует запрета прерываний.
+ * Индексы свободно бегущие (не приводятся к размеру буфера),
+ * размер буфера должен быть степенью двойки.
+ */
+
+#ifndef SPSC_BUFFER_H
+#define	SPSC_BUFFER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "errors/errors.h"
+
+
+/**
+ * Тип индекса буфера.
+ * Индекс однобайтный, чтобы его чтение и запись были атомарны.
+ */
+typedef uint8_t spsc_buffer_index_t;
+
+//! Максимальный размер буфера.
+#define SPSC_BUFFER_SIZE_MAX 128
+
+/**
+ * Структура кольцевого буфера без блокировок.
+ */
+typedef struct _SpscBuffer {
+    uint8_t* ptr;
+    spsc_buffer_index_t mask;
+    volatile spsc_buffer_index_t put;
+    volatile spsc_buffer_index_t get;
+}spsc_buffer_t;
+
+
+/**
+ * Инициализирует кольцевой буфер.
+ * @param buffer Кольцевой буфер.
+ * @param ptr Указатель на память для буфера.
+ * @param size Размер буфера, степень двойки, не более SPSC_BUFFER_SIZE_MAX.
+ * @return Код ошибки.
+ */
+extern err_t spsc_buffer_init(spsc_buffer_t* buffer, uint8_t* ptr, size_t size);
+
+/**
+ * Сбрасывает кольцевой буфер.
+ * Не должна вызываться одновременно с записью или чтением.
+ * @param buffer Кольцевой буфер.
+ */
+extern void spsc_buffer_reset(spsc_buffer_t* buffer);
+
+/**
+ * Получает флаг валидности кольцевого буфера.
+ * @param buffer Кольцевой буфер.
+ * @return Флаг валидности кольцевого буфера.
+ */
+extern bool spsc_buffer_valid(spsc_buffer_t* buffer);
+
+/**
+ * Получает размер кольцевого буфера.
+ * @param buffer Кольцевой буфер.
+ * @return Размер кольцевого буфера.
+ */
+extern size_t spsc_buffer_size(spsc_buffer_t* buffer);
+
+/**
+ * Получает свободное место в кольцевом буфере.
+ * @param buffer Кольцевой буфер.
+ * @return Свободное место в кольцевом буфере.
+ */
+extern size_t spsc_buffer_free_size(spsc_buffer_t* buffer);
+
+/**
+ * Получает размер данных в кольцевом буфере.
+ * @param buffer Кольцевой буфер.
+ * @return Размер данных в кольцевом буфере.
+ */
+extern size_t spsc_buffer_avail_size(spsc_buffer_t* buffer);
+
+/**
+ * Помещает байт данных в кольцевой буфер.
+ * Вызывается только писателем.
+ * @param buffer Кольцевой буфер.
+ * @param data Байт данных.
+ * @return Число помещённых данных в кольцевой буфер (ноль если места недостаточно).
+ */
+extern size_t spsc_buffer_put(spsc_buffer_t* buffer, uint8_t data);
+
+/**
+ * Получает байт данных из кольцевого буфера.
+ * Вызывается только читателем.
+ * @param buffer Кольцевой буфер.
+ * @param data Указатель на байт данных.
+ * @return  Число полученных данных из кольцевого буфера (ноль если нет данных).
+ */
+extern size_t spsc_buffer_get(spsc_buffer_t* buffer, uint8_t* data);
+
+/**
+ * Получает байт данных из кольцевого буфера без извлечения из буфера.
+ * Вызывается только читателем.
+ * @param buffer Кольцевой буфер.
+ * @param data Указатель на байт данных.
+ * @return  Число полученных данных из кольцевого буфера (ноль если нет данных).
+ */
+extern size_t spsc_buffer_peek(spsc_buffer_t* buffer, uint8_t* data);
+
+/**
+ * Помещает данные в кольцевой буфер.
+ * Вызывается только писателем.
+ * @param buffer Кольцевой буфер.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Число помещённых данных в кольцевой буфер (ноль если места недостаточно).
+ */
+extern size_t spsc_buffer_write(spsc_buffer_t* buffer, const uint8_t* data, size_t size);
+
+/**
+ * Получает данные из кольцевого буфера.
+ * Вызывается только читателем.
+ * @param buffer Кольцевой буфер.
+ * @param data Указатель на данные.
+ * @param size Размер данных.
+ * @return  Число полученных данных из кольцевого буфера (ноль если нет данных).
+ */
+extern size_t spsc_buffer_read(spsc_buffer_t* buffer, uint8_t* data, size_t size);
+
+/**
+ * Получает наибольшую непрерывную область кольцевого буфера,
+ * доступную для записи без копирования.
+ * Вызывается только писателем.
+ * @param buffer Кольцевой буфер.
+ * @param ptr Указатель для адреса области.
+ * @return Размер области (ноль если места нет).
+ */
+extern size_t spsc_buffer_write_region(spsc_buffer_t* buffer, uint8_t** ptr);
+
+/**
+ * Фиксирует данные, записанные в область
+ * полученную spsc_buffer_write_region.
+ * Вызывается только писателем.
+ * @param buffer Кольцевой буфер.
+ * @param size Размер записанных данных.
+ * @return Число зафиксированных данных (не более свободного места).
+ */
+extern size_t spsc_buffer_commit(spsc_buffer_t* buffer, size_t size);
+
+/**
+ * Получает наибольшую непрерывную область кольцевого буфера
+ * с данными, доступную для чтения без копирования.
+ * Вызывается только читателем.
+ * @param buffer Кольцевой буфер.
+ * @param ptr Указатель для адреса области.
+ * @return Размер области (ноль если нет данных).
+ */
+extern size_t spsc_buffer_peek_region(spsc_buffer_t* buffer, const uint8_t** ptr);
+
+/**
+ * Извлекает данные из кольцевого буфера без копирования.
+ * Вызывается только читателем.
+ * @param buffer Кольцевой буфер.
+ * @param size Размер данных.
+ * @return Число извлечённых данных (не более размера данных в буфере).
+ */
+extern size_t spsc_buffer_consume(spsc_buffer_t* buffer, size_t size);
+
+#endif	/* SPSC_BUFFER_H */
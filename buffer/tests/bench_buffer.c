@@ -0,0 +1,218 @@
+/**
+ * Бенчмарк примитивов buffer/ на ПК.
+ * Сборка и запуск: make -C host bench.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "buffer/buffer.h"
+#include "buffer/circular_buffer.h"
+#include "buffer/spsc_buffer.h"
+#include "bench.h"
+
+
+//! Число байт, проходящих через буфер в каждом измерении.
+#define BENCH_BYTES (16UL * 1024 * 1024)
+
+//! Максимальный размер буфера.
+#define BENCH_SIZE_MAX 1024
+
+static uint8_t bench_mem[BENCH_SIZE_MAX];
+static uint8_t bench_data[BENCH_SIZE_MAX];
+
+//! Размеры буферов.
+static const size_t bench_sizes[] = {16, 64, 128, 256, 1024};
+
+
+/**
+ * Побайтовые put/get кольцевого буфера.
+ * Буфер заполняется целиком и опустошается.
+ */
+static void bench_circular_byte(size_t size)
+{
+    circular_buffer_t buf;
+    uint64_t t_put = 0, t_get = 0, t;
+    uint64_t n = 0;
+    uint8_t data = 0;
+    uint32_t sum = 0;
+    size_t i;
+    
+    circular_buffer_init(&buf, bench_mem, size);
+    
+    while(n < BENCH_BYTES){
+        t = bench_now_ns();
+        for(i = 0; i < size; i ++) circular_buffer_put(&buf, (uint8_t)i);
+        t_put += bench_now_ns() - t;
+        
+        t = bench_now_ns();
+        for(i = 0; i < size; i ++){
+            circular_buffer_get(&buf, &data);
+            sum += data;
+        }
+        t_get += bench_now_ns() - t;
+        
+        n += size;
+    }
+    
+    bench_sink = sum;
+    
+    bench_report("circular_buffer", "put_byte", size, n, n, t_put);
+    bench_report("circular_buffer", "get_byte", size, n, n, t_get);
+}
+
+/**
+ * Блочные write/read кольцевого буфера.
+ * @param size Размер буфера.
+ * @param chunk Размер блока.
+ * @param name Имя случая.
+ */
+static void bench_circular_bulk(size_t size, size_t chunk, const char* name)
+{
+    circular_buffer_t buf;
+    uint64_t t;
+    uint64_t n = 0, ops = 0;
+    
+    circular_buffer_init(&buf, bench_mem, size);
+    
+    t = bench_now_ns();
+    while(n < BENCH_BYTES){
+        circular_buffer_write(&buf, bench_data, chunk);
+        circular_buffer_read(&buf, bench_data, chunk);
+        n += chunk;
+        ops += 2;
+    }
+    t = bench_now_ns() - t;
+    
+    bench_sink = bench_data[0];
+    
+    bench_report("circular_buffer", name, size, ops, n * 2, t);
+}
+
+/**
+ * Побайтовые put/get буфера без блокировок.
+ * @param size Размер буфера.
+ */
+static void bench_spsc_byte(size_t size)
+{
+    spsc_buffer_t buf;
+    uint64_t t_put = 0, t_get = 0, t;
+    uint64_t n = 0;
+    uint8_t data = 0;
+    uint32_t sum = 0;
+    size_t i;
+    
+    if(spsc_buffer_init(&buf, bench_mem, size) != E_NO_ERROR) return;
+    
+    while(n < BENCH_BYTES){
+        t = bench_now_ns();
+        for(i = 0; i < size; i ++) spsc_buffer_put(&buf, (uint8_t)i);
+        t_put += bench_now_ns() - t;
+        
+        t = bench_now_ns();
+        for(i = 0; i < size; i ++){
+            spsc_buffer_get(&buf, &data);
+            sum += data;
+        }
+        t_get += bench_now_ns() - t;
+        
+        n += size;
+    }
+    
+    bench_sink = sum;
+    
+    bench_report("spsc_buffer", "put_byte", size, n, n, t_put);
+    bench_report("spsc_buffer", "get_byte", size, n, n, t_get);
+}
+
+/**
+ * Блочные write/read буфера без блокировок.
+ * @param size Размер буфера.
+ * @param chunk Размер блока.
+ * @param name Имя случая.
+ */
+static void bench_spsc_bulk(size_t size, size_t chunk, const char* name)
+{
+    spsc_buffer_t buf;
+    uint64_t t;
+    uint64_t n = 0, ops = 0;
+    
+    if(spsc_buffer_init(&buf, bench_mem, size) != E_NO_ERROR) return;
+    
+    t = bench_now_ns();
+    while(n < BENCH_BYTES){
+        spsc_buffer_write(&buf, bench_data, chunk);
+        spsc_buffer_read(&buf, bench_data, chunk);
+        n += chunk;
+        ops += 2;
+    }
+    t = bench_now_ns() - t;
+    
+    bench_sink = bench_data[0];
+    
+    bench_report("spsc_buffer", name, size, ops, n * 2, t);
+}
+
+/**
+ * Побайтовые операции buffer_t.
+ * @param size Размер буфера.
+ */
+static void bench_buffer(size_t size)
+{
+    buffer_t buf;
+    uint64_t t_set = 0, t_get = 0, t;
+    uint64_t n = 0;
+    uint32_t sum = 0;
+    
+    buffer_init(&buf, bench_mem, size);
+    
+    while(n < BENCH_BYTES){
+        buffer_reset(&buf);
+        t = bench_now_ns();
+        while(buffer_has_next(&buf)) buffer_set_next(&buf, (uint8_t)buf.pos);
+        t_set += bench_now_ns() - t;
+        
+        buffer_reset(&buf);
+        t = bench_now_ns();
+        while(buffer_has_next(&buf)) sum += buffer_get_next(&buf);
+        t_get += bench_now_ns() - t;
+        
+        n += size;
+    }
+    
+    bench_sink = sum;
+    
+    bench_report("buffer", "set_next", size, n, n, t_set);
+    bench_report("buffer", "get_next", size, n, n, t_get);
+}
+
+int main(void)
+{
+    size_t i, size;
+    
+    memset(bench_data, 0x55, sizeof(bench_data));
+    
+    bench_header();
+    
+    for(i = 0; i < sizeof(bench_sizes) / sizeof(bench_sizes[0]); i ++){
+        size = bench_sizes[i];
+        
+        bench_buffer(size);
+        
+        bench_circular_byte(size);
+        // Блок - делитель размера: блоки не пересекают конец буфера.
+        bench_circular_bulk(size, size / 4, "bulk_aligned");
+        // Блок не делитель размера: большинство блоков пересекает конец.
+        bench_circular_bulk(size, size / 4 + 1, "bulk_wrap");
+        bench_circular_bulk(size, size, "bulk_full");
+        
+        if(size <= SPSC_BUFFER_SIZE_MAX){
+            bench_spsc_byte(size);
+            bench_spsc_bulk(size, size / 4, "bulk_aligned");
+            bench_spsc_bulk(size, size / 4 + 1, "bulk_wrap");
+            bench_spsc_bulk(size, size, "bulk_full");
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * Бенчмарк очереди записей на ПК.
+ * Измеряет время и число тактов на одну запись.
+ * Сборка и запуск: make -C host bench.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "buffer/record_queue.h"
+#include "bench.h"
+
+
+//! Число записей, проходящих через очередь в каждом измерении.
+#define BENCH_RECORDS (4UL * 1024 * 1024)
+
+//! Максимальный размер записи.
+#define BENCH_RECORD_MAX 32
+
+//! Размеры записей: 2 байта (АЦП), 14 байт (кадр гироскопа), 32 байта.
+static const size_t bench_record_sizes[] = {2, 14, BENCH_RECORD_MAX};
+
+//! Число записей в очереди.
+//! Нечётное, чтобы записи пересекали конец памяти буфера.
+#define BENCH_CAPACITY 15
+
+static uint8_t bench_mem[BENCH_RECORD_MAX * BENCH_CAPACITY];
+static uint8_t bench_record[BENCH_RECORD_MAX * BENCH_CAPACITY];
+
+
+/**
+ * Измеряет помещение и извлечение записей по одной.
+ * @param record_size Размер записи.
+ */
+static void bench_push_pop(size_t record_size)
+{
+    record_queue_t queue;
+    uint64_t t_push = 0, t_pop = 0, c_push = 0, c_pop = 0, t, c;
+    uint64_t n = 0;
+    size_t i;
+    
+    record_queue_init(&queue, bench_mem, record_size, BENCH_CAPACITY);
+    
+    while(n < BENCH_RECORDS){
+        t = bench_now_ns();
+        c = bench_now_cycles();
+        for(i = 0; i < BENCH_CAPACITY; i ++) record_queue_push(&queue, bench_record);
+        c_push += bench_now_cycles() - c;
+        t_push += bench_now_ns() - t;
+        
+        t = bench_now_ns();
+        c = bench_now_cycles();
+        for(i = 0; i < BENCH_CAPACITY; i ++) record_queue_pop(&queue, bench_record);
+        c_pop += bench_now_cycles() - c;
+        t_pop += bench_now_ns() - t;
+        
+        n += BENCH_CAPACITY;
+    }
+    
+    bench_sink = bench_record[0];
+    
+    bench_report_cycles("record_queue", "push", record_size, n, n * record_size, t_push, c_push);
+    bench_report_cycles("record_queue", "pop", record_size, n, n * record_size, t_pop, c_pop);
+}
+
+/**
+ * Измеряет пакетное извлечение записей.
+ * @param record_size Размер записи.
+ */
+static void bench_pop_n(size_t record_size)
+{
+    record_queue_t queue;
+    uint64_t t_pop = 0, c_pop = 0, t, c;
+    uint64_t n = 0;
+    size_t i;
+    
+    record_queue_init(&queue, bench_mem, record_size, BENCH_CAPACITY);
+    
+    // Смещаем начало очереди, чтобы пакет пересекал конец памяти.
+    record_queue_push(&queue, bench_record);
+    record_queue_pop(&queue, bench_record);
+    
+    while(n < BENCH_RECORDS){
+        for(i = 0; i < BENCH_CAPACITY; i ++) record_queue_push(&queue, bench_record);
+        
+        t = bench_now_ns();
+        c = bench_now_cycles();
+        record_queue_pop_n(&queue, bench_record, BENCH_CAPACITY);
+        c_pop += bench_now_cycles() - c;
+        t_pop += bench_now_ns() - t;
+        
+        n += BENCH_CAPACITY;
+    }
+    
+    bench_sink = bench_record[0];
+    
+    bench_report_cycles("record_queue", "pop_n", record_size, n, n * record_size, t_pop, c_pop);
+}
+
+int main(void)
+{
+    size_t i;
+    
+    memset(bench_record, 0x55, sizeof(bench_record));
+    
+    bench_header();
+    
+    for(i = 0; i < sizeof(bench_record_sizes) / sizeof(bench_record_sizes[0]); i ++){
+        bench_push_pop(bench_record_sizes[i]);
+        bench_pop_n(bench_record_sizes[i]);
+    }
+    
+    return 0;
+}
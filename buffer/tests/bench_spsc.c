@@ -0,0 +1,166 @@
+/**
+ * Сравнение пропускной способности буфера без блокировок
+ * и кольцевого буфера с блокировкой на ПК.
+ * Писатель и читатель работают в разных потоках;
+ * мьютекс кольцевого буфера соответствует запрету прерываний на МК.
+ * Сборка и запуск: make -C host bench.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+#include "buffer/circular_buffer.h"
+#include "buffer/spsc_buffer.h"
+#include "utils/utils.h"
+#include "bench.h"
+
+
+//! Число байт, передаваемых через буфер.
+#define BENCH_BYTES (8UL * 1024 * 1024)
+
+//! Размеры блоков.
+static const size_t bench_chunks[] = {1, 8, 32};
+
+static uint8_t bench_mem[SPSC_BUFFER_SIZE_MAX];
+
+static spsc_buffer_t bench_spsc;
+static circular_buffer_t bench_circular;
+static pthread_mutex_t bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+//! Размер блока текущего измерения.
+static size_t bench_chunk;
+
+
+static void* bench_spsc_producer(void* arg)
+{
+    uint8_t data[32] = {0};
+    unsigned long n = 0;
+    size_t size;
+    
+    while(n < BENCH_BYTES){
+        if(bench_chunk == 1) size = spsc_buffer_put(&bench_spsc, (uint8_t)n);
+        else size = spsc_buffer_write(&bench_spsc, data, bench_chunk);
+        if(size == 0) sched_yield();
+        n += size;
+    }
+    
+    return arg;
+}
+
+static void* bench_spsc_consumer(void* arg)
+{
+    uint8_t data[32] = {0};
+    unsigned long n = 0;
+    uint32_t sum = 0;
+    size_t size;
+    
+    while(n < BENCH_BYTES){
+        if(bench_chunk == 1){
+            size = spsc_buffer_get(&bench_spsc, data);
+            sum += data[0];
+        }else{
+            size = spsc_buffer_read(&bench_spsc, data, bench_chunk);
+        }
+        if(size == 0) sched_yield();
+        n += size;
+    }
+    
+    bench_sink = sum;
+    
+    return arg;
+}
+
+static void* bench_circular_producer(void* arg)
+{
+    uint8_t data[32] = {0};
+    unsigned long n = 0;
+    size_t size;
+    
+    while(n < BENCH_BYTES){
+        pthread_mutex_lock(&bench_mutex);
+        if(bench_chunk == 1) size = circular_buffer_put(&bench_circular, (uint8_t)n);
+        else size = circular_buffer_write(&bench_circular, data,
+                            MIN(circular_buffer_free_size(&bench_circular), bench_chunk));
+        pthread_mutex_unlock(&bench_mutex);
+        if(size == 0) sched_yield();
+        n += size;
+    }
+    
+    return arg;
+}
+
+static void* bench_circular_consumer(void* arg)
+{
+    uint8_t data[32] = {0};
+    unsigned long n = 0;
+    uint32_t sum = 0;
+    size_t size;
+    
+    while(n < BENCH_BYTES){
+        pthread_mutex_lock(&bench_mutex);
+        if(bench_chunk == 1){
+            size = circular_buffer_get(&bench_circular, data);
+            sum += data[0];
+        }else{
+            size = circular_buffer_read(&bench_circular, data, bench_chunk);
+        }
+        pthread_mutex_unlock(&bench_mutex);
+        if(size == 0) sched_yield();
+        n += size;
+    }
+    
+    bench_sink = sum;
+    
+    return arg;
+}
+
+/**
+ * Выполняет измерение для пары потоков.
+ * @param producer Поток писателя.
+ * @param consumer Поток читателя.
+ * @return Затраченное время, нс.
+ */
+static uint64_t bench_run(void* (*producer)(void*), void* (*consumer)(void*))
+{
+    pthread_t p, c;
+    uint64_t t;
+    
+    t = bench_now_ns();
+    
+    pthread_create(&c, NULL, consumer, NULL);
+    pthread_create(&p, NULL, producer, NULL);
+    
+    pthread_join(p, NULL);
+    pthread_join(c, NULL);
+    
+    return bench_now_ns() - t;
+}
+
+int main(void)
+{
+    size_t i, size;
+    uint64_t t;
+    char name[32];
+    
+    bench_header();
+    
+    for(size = 16; size <= SPSC_BUFFER_SIZE_MAX; size <<= 1){
+        for(i = 0; i < sizeof(bench_chunks) / sizeof(bench_chunks[0]); i ++){
+            bench_chunk = bench_chunks[i];
+            if(bench_chunk >= size) continue;
+            
+            snprintf(name, sizeof(name), "threads_chunk_%zu", bench_chunk);
+            
+            spsc_buffer_init(&bench_spsc, bench_mem, size);
+            t = bench_run(bench_spsc_producer, bench_spsc_consumer);
+            bench_report("spsc_buffer", name, size, BENCH_BYTES / bench_chunk, BENCH_BYTES, t);
+            
+            circular_buffer_init(&bench_circular, bench_mem, size);
+            t = bench_run(bench_circular_producer, bench_circular_consumer);
+            bench_report("circular_buffer_mutex", name, size, BENCH_BYTES / bench_chunk, BENCH_BYTES, t);
+        }
+    }
+    
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * Тесты очереди записей на ПК.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "buffer/record_queue.h"
+#include "test.h"
+
+
+//! Запись размером с кадр гироскопа.
+typedef struct _Test_Record {
+    uint8_t data[14];
+}test_record_t;
+
+//! Число записей в очереди.
+#define TEST_RECORDS 5
+
+/**
+ * Заполняет запись значением по номеру.
+ * @param record Запись.
+ * @param n Номер записи.
+ */
+static void test_record_fill(test_record_t* record, unsigned n)
+{
+    size_t i;
+    
+    for(i = 0; i < sizeof(record->data); i ++){
+        record->data[i] = (uint8_t)(n * 31 + i);
+    }
+}
+
+/**
+ * Проверяет соответствие записи номеру.
+ * @param record Запись.
+ * @param n Номер записи.
+ * @return Флаг соответствия.
+ */
+static bool test_record_check(const test_record_t* record, unsigned n)
+{
+    test_record_t expected;
+    
+    test_record_fill(&expected, n);
+    
+    return memcmp(record, &expected, sizeof(test_record_t)) == 0;
+}
+
+//! Некорректные параметры инициализации.
+static void test_init(void)
+{
+    record_queue_t queue;
+    RECORD_QUEUE_MEMORY(mem, test_record_t, TEST_RECORDS);
+    
+    TEST_CHECK_EQ(record_queue_init(&queue, NULL, sizeof(test_record_t), TEST_RECORDS), E_NULL_POINTER);
+    TEST_CHECK_EQ(record_queue_init(&queue, mem, 0, TEST_RECORDS), E_INVALID_VALUE);
+    TEST_CHECK_EQ(record_queue_init(&queue, mem, sizeof(test_record_t), 0), E_INVALID_VALUE);
+    
+    TEST_CHECK_EQ(RECORD_QUEUE_INIT(&queue, mem, test_record_t), E_NO_ERROR);
+    TEST_CHECK_EQ(record_queue_record_size(&queue), sizeof(test_record_t));
+    TEST_CHECK_EQ(record_queue_capacity(&queue), TEST_RECORDS);
+}
+
+//! Пустая и полная очередь.
+static void test_full_empty(void)
+{
+    record_queue_t queue;
+    RECORD_QUEUE_MEMORY(mem, test_record_t, TEST_RECORDS);
+    test_record_t record;
+    unsigned n;
+    
+    RECORD_QUEUE_INIT(&queue, mem, test_record_t);
+    
+    // Пустая очередь.
+    TEST_CHECK_EQ(record_queue_count(&queue), 0);
+    TEST_CHECK_EQ(record_queue_free_count(&queue), TEST_RECORDS);
+    TEST_CHECK_EQ(record_queue_pop(&queue, &record), 0);
+    TEST_CHECK_EQ(record_queue_peek(&queue, &record), 0);
+    TEST_CHECK_EQ(record_queue_pop_n(&queue, &record, 1), 0);
+    
+    for(n = 0; n < TEST_RECORDS; n ++){
+        test_record_fill(&record, n);
+        TEST_CHECK_EQ(record_queue_push(&queue, &record), 1);
+    }
+    
+    // Полная очередь: запись не помещается и не портит очередь.
+    TEST_CHECK_EQ(record_queue_count(&queue), TEST_RECORDS);
+    TEST_CHECK_EQ(record_queue_free_count(&queue), 0);
+    test_record_fill(&record, 100);
+    TEST_CHECK_EQ(record_queue_push(&queue, &record), 0);
+    TEST_CHECK_EQ(record_queue_count(&queue), TEST_RECORDS);
+    
+    for(n = 0; n < TEST_RECORDS; n ++){
+        TEST_CHECK_EQ(record_queue_pop(&queue, &record), 1);
+        TEST_CHECK(test_record_check(&record, n));
+    }
+    
+    TEST_CHECK_EQ(record_queue_pop(&queue, &record), 0);
+    TEST_CHECK_EQ(record_queue_count(&queue), 0);
+    
+    // Сброс.
+    record_queue_push(&queue, &record);
+    record_queue_reset(&queue);
+    TEST_CHECK_EQ(record_queue_count(&queue), 0);
+    TEST_CHECK_EQ(record_queue_free_count(&queue), TEST_RECORDS);
+}
+
+//! Записи, разделённые концом памяти буфера.
+static void test_wrap_around(void)
+{
+    record_queue_t queue;
+    RECORD_QUEUE_MEMORY(mem, test_record_t, TEST_RECORDS);
+    test_record_t record;
+    unsigned put = 0, get = 0;
+    unsigned i;
+    
+    RECORD_QUEUE_INIT(&queue, mem, test_record_t);
+    
+    // Сдвигаем начало очереди на каждом проходе,
+    // чтобы записи пересекали конец памяти во всех позициях.
+    for(i = 0; i < TEST_RECORDS * 4; i ++){
+        while(record_queue_free_count(&queue) > 1){
+            test_record_fill(&record, put ++);
+            TEST_CHECK_EQ(record_queue_push(&queue, &record), 1);
+        }
+        
+        TEST_CHECK_EQ(record_queue_peek(&queue, &record), 1);
+        TEST_CHECK(test_record_check(&record, get));
+        
+        while(record_queue_count(&queue) > 1){
+            TEST_CHECK_EQ(record_queue_pop(&queue, &record), 1);
+            TEST_CHECK(test_record_check(&record, get ++));
+        }
+    }
+}
+
+//! Пакетное извлечение, в том числе больше числа записей в очереди.
+static void test_pop_n(void)
+{
+    record_queue_t queue;
+    RECORD_QUEUE_MEMORY(mem, test_record_t, TEST_RECORDS);
+    test_record_t record = {{0}};
+    test_record_t records[TEST_RECORDS + 2];
+    unsigned n;
+    
+    RECORD_QUEUE_INIT(&queue, mem, test_record_t);
+    
+    // Смещаем начало очереди для пересечения конца памяти.
+    for(n = 0; n < 3; n ++){
+        record_queue_push(&queue, &record);
+        record_queue_pop(&queue, &record);
+    }
+    
+    for(n = 0; n < TEST_RECORDS; n ++){
+        test_record_fill(&record, n);
+        record_queue_push(&queue, &record);
+    }
+    
+    TEST_CHECK_EQ(record_queue_pop_n(&queue, records, 2), 2);
+    TEST_CHECK(test_record_check(&records[0], 0));
+    TEST_CHECK(test_record_check(&records[1], 1));
+    
+    // Запрошено больше записей, чем есть в очереди.
+    memset(records, 0, sizeof(records));
+    TEST_CHECK_EQ(record_queue_pop_n(&queue, records, TEST_RECORDS + 2), TEST_RECORDS - 2);
+    for(n = 0; n < TEST_RECORDS - 2; n ++){
+        TEST_CHECK(test_record_check(&records[n], n + 2));
+    }
+    TEST_CHECK(records[TEST_RECORDS - 2].data[0] == 0);
+    TEST_CHECK_EQ(record_queue_count(&queue), 0);
+    TEST_CHECK_EQ(record_queue_pop_n(&queue, records, 0), 0);
+}
+
+int main(void)
+{
+    test_init();
+    test_full_empty();
+    test_wrap_around();
+    test_pop_n();
+    
+    return test_result("test_record_queue");
+}
@@ -0,0 +1,155 @@
+/**
+ * Нагрузочный тест буфера без блокировок на ПК.
+ * Писатель и читатель работают в разных потоках,
+ * как основной цикл и прерывание UART на МК.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <sched.h>
+#include "buffer/spsc_buffer.h"
+#include "utils/utils.h"
+#include "test.h"
+
+
+//! Число байт, передаваемых через буфер.
+#define STRESS_BYTES (1UL * 1024 * 1024)
+
+//! Размер блока записи и чтения.
+#define STRESS_CHUNK 5
+
+static uint8_t stress_mem[SPSC_BUFFER_SIZE_MAX];
+static spsc_buffer_t stress_buf;
+
+//! Число ошибок последовательности у читателя.
+static unsigned long stress_errors;
+
+
+/**
+ * Получает байт передаваемой последовательности.
+ * Последовательность не повторяется с периодом буфера,
+ * что позволяет обнаружить потерю и повтор данных.
+ * @param n Номер байта.
+ * @return Значение байта.
+ */
+static uint8_t stress_byte(unsigned long n)
+{
+    return (uint8_t)(n ^ (n >> 8) ^ (n >> 16));
+}
+
+/**
+ * Поток писателя.
+ * Чередует запись по байту, блоком и через регион.
+ */
+static void* stress_producer(void* arg)
+{
+    unsigned long n = 0, last;
+    uint8_t chunk[STRESS_CHUNK];
+    uint8_t* ptr;
+    size_t i, size;
+    
+    while(n < STRESS_BYTES){
+        last = n;
+        switch(n % 3){
+            case 0:
+                n += spsc_buffer_put(&stress_buf, stress_byte(n));
+                break;
+            case 1:
+                // Запись блока выполняется только целиком.
+                size = MIN(STRESS_CHUNK, spsc_buffer_size(&stress_buf));
+                if(size > STRESS_BYTES - n) size = STRESS_BYTES - n;
+                for(i = 0; i < size; i ++) chunk[i] = stress_byte(n + i);
+                n += spsc_buffer_write(&stress_buf, chunk, size);
+                break;
+            default:
+                size = spsc_buffer_write_region(&stress_buf, &ptr);
+                if(size > STRESS_BYTES - n) size = STRESS_BYTES - n;
+                for(i = 0; i < size; i ++) ptr[i] = stress_byte(n + i);
+                n += spsc_buffer_commit(&stress_buf, size);
+                break;
+        }
+        // Отдаём процессор другому потоку, если буфер полон или пуст.
+        if(n == last) sched_yield();
+    }
+    
+    return arg;
+}
+
+/**
+ * Поток читателя.
+ * Чередует чтение по байту, блоком и через регион.
+ */
+static void* stress_consumer(void* arg)
+{
+    unsigned long n = 0, last;
+    uint8_t chunk[STRESS_CHUNK];
+    const uint8_t* ptr;
+    uint8_t data;
+    size_t i, size;
+    
+    while(n < STRESS_BYTES){
+        last = n;
+        switch(n % 3){
+            case 0:
+                if(spsc_buffer_get(&stress_buf, &data) != 0){
+                    if(data != stress_byte(n)) stress_errors ++;
+                    n ++;
+                }
+                break;
+            case 1:
+                size = spsc_buffer_read(&stress_buf, chunk, STRESS_CHUNK);
+                for(i = 0; i < size; i ++){
+                    if(chunk[i] != stress_byte(n + i)) stress_errors ++;
+                }
+                n += size;
+                break;
+            default:
+                size = spsc_buffer_peek_region(&stress_buf, &ptr);
+                for(i = 0; i < size; i ++){
+                    if(ptr[i] != stress_byte(n + i)) stress_errors ++;
+                }
+                n += spsc_buffer_consume(&stress_buf, size);
+                break;
+        }
+        // Отдаём процессор другому потоку, если буфер полон или пуст.
+        if(n == last) sched_yield();
+    }
+    
+    return arg;
+}
+
+/**
+ * Прогоняет последовательность через буфер заданного размера.
+ * @param size Размер буфера.
+ */
+static void stress_run(size_t size)
+{
+    pthread_t producer, consumer;
+    
+    TEST_CHECK_EQ(spsc_buffer_init(&stress_buf, stress_mem, size), E_NO_ERROR);
+    
+    stress_errors = 0;
+    
+    pthread_create(&consumer, NULL, stress_consumer, NULL);
+    pthread_create(&producer, NULL, stress_producer, NULL);
+    
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    
+    TEST_CHECK_EQ(stress_errors, 0);
+    TEST_CHECK_EQ(spsc_buffer_avail_size(&stress_buf), 0);
+    TEST_CHECK_EQ(spsc_buffer_free_size(&stress_buf), size);
+}
+
+int main(void)
+{
+    size_t size;
+    
+    for(size = 2; size <= SPSC_BUFFER_SIZE_MAX; size <<= 1){
+        stress_run(size);
+    }
+    
+    return test_result("test_spsc_stress");
+}
@@ -113,8 +113,6 @@ static err_t ds1307_do();
 
 bool ds1307_i2c_callback(void)
 {
-    if(i2c_transfer_id() != DS1307_I2C_TRANSFER_ID) return false;
-    
     switch(i2c_status()){
         case I2C_STATUS_SLAVE_DATA_READED:
         case I2C_STATUS_SLAVE_DATA_WRITED:
@@ -198,7 +196,7 @@ err_t ds1307_init()
     future_init(&rtc.future);
     future_set_result(&rtc.future, int_to_pvoid(E_NO_ERROR));
     
-    return E_NO_ERROR;
+    return i2c_register_callback(DS1307_I2C_TRANSFER_ID, ds1307_i2c_callback);
 }
 
 bool ds1307_in_process()
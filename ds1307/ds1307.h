@@ -18,8 +18,12 @@
 //Адрес ds1307.
 #define DS1307_I2C_ADDRESS 0x68
 
-//Идентификатор передачи i2c для ds1307
-#define DS1307_I2C_TRANSFER_ID DS1307_I2C_ADDRESS
+//Идентификатор передачи i2c для ds1307,
+//меньше I2C_CALLBACKS_COUNT - ds1307_init() регистрирует
+//по нему ds1307_i2c_callback() через i2c_register_callback().
+#ifndef DS1307_I2C_TRANSFER_ID
+#define DS1307_I2C_TRANSFER_ID 1
+#endif
 
 //Тип статуса.
 typedef uint8_t ds1307_status_t;
@@ -52,13 +56,15 @@ typedef struct Ds1307_DT {
 
 /**
  * Каллбэк i2c.
- * @param event Событие i2c.
+ * Регистрируется ds1307_init() для DS1307_I2C_TRANSFER_ID
+ * и вызывается только для передач ds1307.
  * @return true, если событие обработано, иначе false.
  */
 extern bool ds1307_i2c_callback(void);
 
 /**
  * Инициализация RTC.
+ * Регистрирует ds1307_i2c_callback() в таблице каллбэков i2c.
  * @return Код ошибки.
  */
 extern err_t ds1307_init(void);
@@ -210,8 +210,6 @@ static void gyro6050_do(void);
 
 bool gyro6050_i2c_callback(void)
 {
-    if(i2c_transfer_id() != gyro.i2c_transfer_id) return false;
-    
     gyro6050_do();
     
     return true;
@@ -388,7 +386,7 @@ err_t gyro6050_init(i2c_address_t address)
     memset(&gyro.raw_data, 0x0, sizeof(gyro6050_raw_data_t));
     memset(&gyro.data, 0x0, sizeof(gyro6050_data_t));
     
-    return E_NO_ERROR;
+    return i2c_register_callback(gyro.i2c_transfer_id, gyro6050_i2c_callback);
 }
 
 bool gyro6050_done(void)
@@ -417,9 +415,18 @@ i2c_transfer_id_t gyro6050_i2c_transfer_id(void)
     return gyro.i2c_transfer_id;
 }
 
-void gyro6050_i2c_set_transfer_id(i2c_transfer_id_t transfer_id)
+err_t gyro6050_i2c_set_transfer_id(i2c_transfer_id_t transfer_id)
 {
+    err_t err = i2c_register_callback(transfer_id, gyro6050_i2c_callback);
+    if(err != E_NO_ERROR) return err;
+    
+    if(gyro.i2c_transfer_id != transfer_id){
+        i2c_register_callback(gyro.i2c_transfer_id, NULL);
+    }
+    
     gyro.i2c_transfer_id = transfer_id;
+    
+    return E_NO_ERROR;
 }
 
 err_t gyro6050_read_rate_divisor(void)
@@ -16,8 +16,11 @@
 //! Пин AD0 подтянут к питанию.
 #define GYRO6050_I2C_ADDRESS1 0x69
 
-//! Идентификатор передачи i2c по умолчанию.
-#define GYRO6050_DEFAULT_I2C_TRANSFER_ID GYRO6050_I2C_ADDRESS0
+//! Идентификатор передачи i2c по умолчанию,
+//! меньше I2C_CALLBACKS_COUNT.
+#ifndef GYRO6050_DEFAULT_I2C_TRANSFER_ID
+#define GYRO6050_DEFAULT_I2C_TRANSFER_ID 2
+#endif
 
 //! Частота вывода данных.
 //! Частота вывода данных акселерометра.
@@ -120,13 +123,17 @@ typedef uint8_t gyro6050_int_conf_t;
 
 /**
  * Каллбэк i2c гироскопа.
+ * Регистрируется в таблице каллбэков i2c
+ * для идентификатора передачи гироскопа
+ * и вызывается только для его передач.
  * @return Флаг обработки события.
  */
 extern bool gyro6050_i2c_callback(void);
 
 /**
  * Инициализирует данные гироскопа.
- * Идентификатор пердачи по умолчанию.
+ * Устанавливает идентификатор передачи по умолчанию
+ * и регистрирует для него gyro6050_i2c_callback().
  * @param address Адрес устройства на шине i2c.
  * @return Код ошибки.
  */
@@ -163,9 +170,12 @@ extern i2c_transfer_id_t gyro6050_i2c_transfer_id(void);
 
 /**
  * Устанавливает идентификатор передачи i2c.
- * @param transfer_id Идентификатор передачи i2c.
+ * Перерегистрирует gyro6050_i2c_callback()
+ * для нового идентификатора.
+ * @param transfer_id Идентификатор передачи i2c, меньше I2C_CALLBACKS_COUNT.
+ * @return Код ошибки.
  */
-extern void gyro6050_i2c_set_transfer_id(i2c_transfer_id_t transfer_id);
+extern err_t gyro6050_i2c_set_transfer_id(i2c_transfer_id_t transfer_id);
 
 /**
  * Считывает делитель частоты вывода из гироскопа.
@@ -0,0 +1,104 @@
+/**
+ * @file bench.h
+ * Общие функции бенчмарков для ПК.
+ *
+ * Результаты выводятся в CSV, по строке на измерение:
+ * bench,case,size,ops,bytes,ns_per_op,bytes_per_sec,cycles_per_op
+ * Число тактов на операцию измеряется счётчиком тактов процессора
+ * (только x86) и выводится не всеми бенчмарками.
+ */
+
+#ifndef HOST_BENCH_H
+#define	HOST_BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+
+//! Приёмник результатов, не позволяющий компилятору выбросить вычисления.
+static volatile uint32_t bench_sink;
+
+/**
+ * Получает монотонное время.
+ * @return Время, нс.
+ */
+static inline uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Получает значение счётчика тактов процессора.
+ * @return Число тактов, 0 если счётчик недоступен.
+ */
+static inline uint64_t bench_now_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * Выводит заголовок CSV.
+ */
+static inline void bench_header(void)
+{
+    printf("bench,case,size,ops,bytes,ns_per_op,bytes_per_sec,cycles_per_op\n");
+}
+
+/**
+ * Выводит результат измерения.
+ * @param bench Имя бенчмарка.
+ * @param name Имя случая.
+ * @param size Размер буфера.
+ * @param ops Число операций.
+ * @param bytes Число обработанных байт.
+ * @param ns Затраченное время, нс.
+ */
+static inline void bench_report(const char* bench, const char* name, size_t size,
+                                uint64_t ops, uint64_t bytes, uint64_t ns)
+{
+    double sec = (double)ns / 1e9;
+    
+    if(ns == 0) ns = 1;
+    
+    printf("%s,%s,%zu,%llu,%llu,%.3f,%.0f,\n", bench, name, size,
+           (unsigned long long)ops, (unsigned long long)bytes,
+           (double)ns / (double)ops, (sec > 0.0) ? (double)bytes / sec : 0.0);
+}
+
+/**
+ * Выводит результат измерения с числом тактов.
+ * @param bench Имя бенчмарка.
+ * @param name Имя случая.
+ * @param size Размер буфера.
+ * @param ops Число операций.
+ * @param bytes Число обработанных байт.
+ * @param ns Затраченное время, нс.
+ * @param cycles Затраченное число тактов.
+ */
+static inline void bench_report_cycles(const char* bench, const char* name, size_t size,
+                                       uint64_t ops, uint64_t bytes, uint64_t ns, uint64_t cycles)
+{
+    double sec = (double)ns / 1e9;
+    
+    if(ns == 0) ns = 1;
+    
+    printf("%s,%s,%zu,%llu,%llu,%.3f,%.0f,%.1f\n", bench, name, size,
+           (unsigned long long)ops, (unsigned long long)bytes,
+           (double)ns / (double)ops, (sec > 0.0) ? (double)bytes / sec : 0.0,
+           (double)cycles / (double)ops);
+}
+
+#endif	/* HOST_BENCH_H */
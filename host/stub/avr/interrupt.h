@@ -0,0 +1,23 @@
+/**
+ * @file interrupt.h
+ * Заглушка avr/interrupt.h для сборки на ПК.
+ * Обработчики прерываний - обычные функции,
+ * вызываемые тестами для имитации прерываний.
+ */
+
+#ifndef STUB_AVR_INTERRUPT_H
+#define	STUB_AVR_INTERRUPT_H
+
+// Как и в avr-libc, включает регистры (SREG).
+#include <avr/io.h>
+
+//! Объявляет обработчик прерывания.
+#define ISR(vector) void vector(void); void vector(void)
+
+//! Запрещает прерывания.
+#define cli() do{}while(0)
+
+//! Разрешает прерывания.
+#define sei() do{}while(0)
+
+#endif	/* STUB_AVR_INTERRUPT_H */
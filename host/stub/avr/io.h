@@ -0,0 +1,196 @@
+/**
+ * @file io.h
+ * Заглушка avr/io.h для сборки на ПК.
+ * Регистры ATmega16 - переменные в памяти (regs.c),
+ * которые тесты читают и изменяют для имитации периферии.
+ */
+
+#ifndef STUB_AVR_IO_H
+#define	STUB_AVR_IO_H
+
+#include <stdint.h>
+
+
+//! Регистры.
+extern volatile uint8_t r_UDR;
+#define UDR r_UDR
+extern volatile uint8_t r_UCSRA;
+#define UCSRA r_UCSRA
+extern volatile uint8_t r_UCSRB;
+#define UCSRB r_UCSRB
+extern volatile uint8_t r_UCSRC;
+#define UCSRC r_UCSRC
+extern volatile uint8_t r_UBRRH;
+#define UBRRH r_UBRRH
+extern volatile uint8_t r_UBRRL;
+#define UBRRL r_UBRRL
+extern volatile uint8_t r_SREG;
+#define SREG r_SREG
+extern volatile uint8_t r_TWCR;
+#define TWCR r_TWCR
+extern volatile uint8_t r_TWSR;
+#define TWSR r_TWSR
+extern volatile uint8_t r_TWDR;
+#define TWDR r_TWDR
+extern volatile uint8_t r_TWAR;
+#define TWAR r_TWAR
+extern volatile uint8_t r_TWBR;
+#define TWBR r_TWBR
+extern volatile uint8_t r_SPCR;
+#define SPCR r_SPCR
+extern volatile uint8_t r_SPSR;
+#define SPSR r_SPSR
+extern volatile uint8_t r_SPDR;
+#define SPDR r_SPDR
+extern volatile uint8_t r_TCCR1A;
+#define TCCR1A r_TCCR1A
+extern volatile uint8_t r_TCCR1B;
+#define TCCR1B r_TCCR1B
+extern volatile uint8_t r_TIMSK;
+#define TIMSK r_TIMSK
+extern volatile uint8_t r_TIFR;
+#define TIFR r_TIFR
+extern volatile uint8_t r_SFIOR;
+#define SFIOR r_SFIOR
+extern volatile uint8_t r_PORTA;
+#define PORTA r_PORTA
+extern volatile uint8_t r_PINA;
+#define PINA r_PINA
+extern volatile uint8_t r_DDRA;
+#define DDRA r_DDRA
+extern volatile uint8_t r_PORTB;
+#define PORTB r_PORTB
+extern volatile uint8_t r_PINB;
+#define PINB r_PINB
+extern volatile uint8_t r_DDRB;
+#define DDRB r_DDRB
+extern volatile uint8_t r_PORTC;
+#define PORTC r_PORTC
+extern volatile uint8_t r_PINC;
+#define PINC r_PINC
+extern volatile uint8_t r_DDRC;
+#define DDRC r_DDRC
+extern volatile uint8_t r_PORTD;
+#define PORTD r_PORTD
+extern volatile uint8_t r_PIND;
+#define PIND r_PIND
+extern volatile uint8_t r_DDRD;
+#define DDRD r_DDRD
+extern volatile uint16_t r_TCNT1;
+#define TCNT1 r_TCNT1
+extern volatile uint16_t r_ICR1;
+#define ICR1 r_ICR1
+extern volatile uint16_t r_OCR1A;
+#define OCR1A r_OCR1A
+extern volatile uint16_t r_OCR1B;
+#define OCR1B r_OCR1B
+
+//! Биты регистров.
+// UCSRA.
+#define RXC 7
+#define TXC 6
+#define UDRE 5
+#define FE 4
+#define DOR 3
+#define PE 2
+#define U2X 1
+#define MPCM 0
+// UCSRB.
+#define RXCIE 7
+#define TXCIE 6
+#define UDRIE 5
+#define RXEN 4
+#define TXEN 3
+#define UCSZ2 2
+#define RXB8 1
+#define TXB8 0
+// UCSRC.
+#define URSEL 7
+#define UMSEL 6
+#define UPM1 5
+#define UPM0 4
+#define USBS 3
+#define UCSZ1 2
+#define UCSZ0 1
+#define UCPOL 0
+// TWCR.
+#define TWINT 7
+#define TWEA 6
+#define TWSTA 5
+#define TWSTO 4
+#define TWWC 3
+#define TWEN 2
+#define TWIE 0
+// TWSR.
+#define TWPS1 1
+#define TWPS0 0
+// TWAR.
+#define TWGCE 0
+#define TWA0 1
+// SPCR.
+#define SPIE 7
+#define SPE 6
+#define DORD 5
+#define MSTR 4
+#define CPOL 3
+#define CPHA 2
+#define SPR1 1
+#define SPR0 0
+// SPSR.
+#define SPIF 7
+#define WCOL 6
+#define SPI2X 0
+// TCCR1B.
+#define ICNC1 7
+#define ICES1 6
+#define CS12 2
+#define CS11 1
+#define CS10 0
+// TIMSK.
+#define TICIE1 5
+#define OCIE1A 4
+#define OCIE1B 3
+#define TOIE1 2
+// TIFR.
+#define ICF1 5
+#define OCF1A 4
+#define OCF1B 3
+#define TOV1 2
+// SFIOR.
+#define PUD 2
+
+//! Биты портов.
+#define PA0 0
+#define PA1 1
+#define PA2 2
+#define PA3 3
+#define PA4 4
+#define PA5 5
+#define PA6 6
+#define PA7 7
+#define PB0 0
+#define PB1 1
+#define PB2 2
+#define PB3 3
+#define PB4 4
+#define PB5 5
+#define PB6 6
+#define PB7 7
+#define PC0 0
+#define PC1 1
+#define PC2 2
+#define PC3 3
+#define PC4 4
+#define PC5 5
+#define PC6 6
+#define PC7 7
+#define PD0 0
+#define PD1 1
+#define PD2 2
+#define PD3 3
+#define PD4 4
+#define PD5 5
+#define PD6 6
+#define PD7 7
+
+#endif	/* STUB_AVR_IO_H */
@@ -0,0 +1,22 @@
+/**
+ * @file pgmspace.h
+ * Заглушка avr/pgmspace.h для сборки на ПК.
+ * Флеш-память - обычная память.
+ */
+
+#ifndef STUB_AVR_PGMSPACE_H
+#define	STUB_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+// Адресное пространство флеш-памяти avr-gcc.
+#define __flash
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t*)(p))
+#define pgm_read_word(p) (*(const uint16_t*)(p))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+#endif	/* STUB_AVR_PGMSPACE_H */
@@ -0,0 +1,43 @@
+/**
+ * Память регистров заглушки avr/io.h.
+ */
+
+#include <avr/io.h>
+
+
+volatile uint8_t r_UDR;
+volatile uint8_t r_UCSRA;
+volatile uint8_t r_UCSRB;
+volatile uint8_t r_UCSRC;
+volatile uint8_t r_UBRRH;
+volatile uint8_t r_UBRRL;
+volatile uint8_t r_SREG;
+volatile uint8_t r_TWCR;
+volatile uint8_t r_TWSR;
+volatile uint8_t r_TWDR;
+volatile uint8_t r_TWAR;
+volatile uint8_t r_TWBR;
+volatile uint8_t r_SPCR;
+volatile uint8_t r_SPSR;
+volatile uint8_t r_SPDR;
+volatile uint8_t r_TCCR1A;
+volatile uint8_t r_TCCR1B;
+volatile uint8_t r_TIMSK;
+volatile uint8_t r_TIFR;
+volatile uint8_t r_SFIOR;
+volatile uint8_t r_PORTA;
+volatile uint8_t r_PINA;
+volatile uint8_t r_DDRA;
+volatile uint8_t r_PORTB;
+volatile uint8_t r_PINB;
+volatile uint8_t r_DDRB;
+volatile uint8_t r_PORTC;
+volatile uint8_t r_PINC;
+volatile uint8_t r_DDRC;
+volatile uint8_t r_PORTD;
+volatile uint8_t r_PIND;
+volatile uint8_t r_DDRD;
+volatile uint16_t r_TCNT1;
+volatile uint16_t r_ICR1;
+volatile uint16_t r_OCR1A;
+volatile uint16_t r_OCR1B;
@@ -0,0 +1,25 @@
+/**
+ * @file crc16.h
+ * Заглушка util/crc16.h для сборки на ПК.
+ */
+
+#ifndef STUB_UTIL_CRC16_H
+#define	STUB_UTIL_CRC16_H
+
+#include <stdint.h>
+
+/**
+ * Вычисляет CRC-CCITT, как одноимённая функция avr-libc.
+ * @param crc Текущее значение CRC.
+ * @param data Байт данных.
+ * @return Новое значение CRC.
+ */
+static inline uint16_t _crc_ccitt_update(uint16_t crc, uint8_t data)
+{
+    data ^= crc & 0xff;
+    data ^= data << 4;
+    
+    return ((((uint16_t)data << 8) | (crc >> 8)) ^ (uint8_t)(data >> 4) ^ ((uint16_t)data << 3));
+}
+
+#endif	/* STUB_UTIL_CRC16_H */
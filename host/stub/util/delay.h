@@ -0,0 +1,13 @@
+/**
+ * @file delay.h
+ * Заглушка util/delay.h для сборки на ПК.
+ * Задержки не выполняются.
+ */
+
+#ifndef STUB_UTIL_DELAY_H
+#define	STUB_UTIL_DELAY_H
+
+#define _delay_us(us) do{}while(0)
+#define _delay_ms(ms) do{}while(0)
+
+#endif	/* STUB_UTIL_DELAY_H */
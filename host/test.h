@@ -0,0 +1,53 @@
+/**
+ * @file test.h
+ * Общие функции тестов для ПК.
+ */
+
+#ifndef HOST_TEST_H
+#define	HOST_TEST_H
+
+#include <stdio.h>
+
+
+//! Число проваленных проверок.
+static int test_failures;
+
+//! Проверяет условие, при нарушении выводит место проверки.
+#define TEST_CHECK(cond)\
+                do{\
+                    if(!(cond)){\
+                        test_failures ++;\
+                        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond);\
+                    }\
+                }while(0)
+
+//! Проверяет равенство целых значений.
+#define TEST_CHECK_EQ(a, b)\
+                do{\
+                    long long __test_a = (long long)(a);\
+                    long long __test_b = (long long)(b);\
+                    if(__test_a != __test_b){\
+                        test_failures ++;\
+                        fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n",\
+                                __FILE__, __LINE__, #a, #b, __test_a, __test_b);\
+                    }\
+                }while(0)
+
+/**
+ * Выводит итог тестов.
+ * @param name Имя теста.
+ * @return Код завершения процесса.
+ */
+static inline int test_result(const char* name)
+{
+    if(test_failures != 0){
+        printf("%s: FAILED (%d)\n", name, test_failures);
+        return 1;
+    }
+    
+    printf("%s: OK\n", name);
+    
+    return 0;
+}
+
+#endif	/* HOST_TEST_H */
@@ -0,0 +1,80 @@
+/**
+ * @file uart_host.h
+ * Имитация периферии UART для тестов на ПК.
+ * Передача и приём выполняются вызовом обработчиков
+ * прерываний UART по умолчанию с заглушками регистров.
+ */
+
+#ifndef HOST_UART_HOST_H
+#define	HOST_UART_HOST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+#include "uart/uart.h"
+#include "bits/bits.h"
+
+
+//! Обработчики прерываний UART.
+extern void USART_RXC_vect(void);
+extern void USART_UDRE_vect(void);
+extern void USART_TXC_vect(void);
+
+/**
+ * Устанавливает буферы и включает приёмник и передатчик UART.
+ * @param rx Буфер чтения.
+ * @param rx_size Размер буфера чтения.
+ * @param tx Буфер записи.
+ * @param tx_size Размер буфера записи.
+ */
+static inline void uart_host_init(uint8_t* rx, size_t rx_size, uint8_t* tx, size_t tx_size)
+{
+    UCSRA = 0;
+    UCSRB = 0;
+    
+    uart_set_read_buffer(rx, rx_size);
+    uart_set_write_buffer(tx, tx_size);
+    
+    uart_receiver_set_enabled(true);
+    uart_transmitter_set_enabled(true);
+}
+
+/**
+ * Передаёт данные из буфера записи UART,
+ * вызывая обработчик прерывания опустошения UDR.
+ * @param data Буфер для переданных данных, NULL чтобы отбросить данные.
+ * @param size Размер буфера.
+ * @return Число переданных байт.
+ */
+static inline size_t uart_host_transmit(uint8_t* data, size_t size)
+{
+    size_t n = 0;
+    
+    while(BIT_VALUE(UCSRB, UDRIE)){
+        USART_UDRE_vect();
+        // Буфер пуст - прерывание запрещено обработчиком.
+        if(!BIT_VALUE(UCSRB, UDRIE)) break;
+        if(data != NULL && n < size) data[n] = UDR;
+        n ++;
+    }
+    
+    return n;
+}
+
+/**
+ * Принимает данные в буфер чтения UART,
+ * вызывая обработчик прерывания приёма.
+ * @param data Данные.
+ * @param size Размер данных.
+ */
+static inline void uart_host_receive(const uint8_t* data, size_t size)
+{
+    size_t i;
+    
+    for(i = 0; i < size; i ++){
+        UDR = data[i];
+        USART_RXC_vect();
+    }
+}
+
+#endif	/* HOST_UART_HOST_H */
@@ -1,10 +1,13 @@
 #include "i2c.h"
 #include "buffer/buffer.h"
+#include "buffer/buffer_list.h"
 #include "bits/bits.h"
 #include "utils/utils.h"
 #include <avr/interrupt.h>
 #include <util/twi.h>
 #include <string.h>
+#include <util/delay.h>
+#include "ports/ports.h"
 
 #ifndef F_CPU
 #warning i2c: F_CPU is not defined. Defaulting to 1MHz.
@@ -21,20 +24,16 @@
 #define I2C_RESPONSE_ALLOW 1
 #define I2C_RESPONSE_DENY  0
 
-//! Сохраняет и запрещает прерывания чтения UART.
-#define __i2c_interrupts_save_disable()\
-                register uint8_t __saved_twcr_twie = BIT_RAW_VALUE(TWCR, TWIE);\
-                BIT_OFF(TWCR, TWIE)
-//! Восстанавливает значение прерывания чтения UART.
-#define __i2c_interrupts_restore()\
-                TWCR |= __saved_twcr_twie
-
 /**
- * Группа из буфера адреса и буфера данных.
+ * Группа из списка буферов адреса и списка буферов данных.
+ * Для простых передач списки ссылаются
+ * на встроенные буферы адреса и данных.
  */
 typedef struct _I2C_Data {
     buffer_t address_buffer;
     buffer_t data_buffer;
+    buffer_list_t address_list;
+    buffer_list_t data_list;
 }i2c_data_t;
 
 /**
@@ -49,6 +48,22 @@ ALWAYS_INLINE static void i2c_data_init(i2c_data_t* i2c_data, void* rom_address,
 {
     buffer_init(&i2c_data->address_buffer, rom_address, rom_address_size);
     buffer_init(&i2c_data->data_buffer, data, data_size);
+    buffer_list_init(&i2c_data->address_list, rom_address ? &i2c_data->address_buffer : NULL, 1);
+    buffer_list_init(&i2c_data->data_list, &i2c_data->data_buffer, 1);
+}
+
+/**
+ * Инициализирует данные для передачи/приёма списками буферов.
+ * @param i2c_data Данные для передачи/приёма.
+ * @param address Буферы адреса в устройстве.
+ * @param address_count Число буферов адреса.
+ * @param data Буферы данных для передачи/приёма.
+ * @param data_count Число буферов данных.
+ */
+ALWAYS_INLINE static void i2c_data_init_sg(i2c_data_t* i2c_data, buffer_t* address, size_t address_count, buffer_t* data, size_t data_count)
+{
+    buffer_list_init(&i2c_data->address_list, address, address_count);
+    buffer_list_init(&i2c_data->data_list, data, data_count);
 }
 
 /**
@@ -58,7 +73,7 @@ ALWAYS_INLINE static void i2c_data_init(i2c_data_t* i2c_data, void* rom_address,
  */
 ALWAYS_INLINE static i2c_size_t i2c_data_bytes_transmitted(i2c_data_t* data)
 {
-    return data->address_buffer.pos + data->data_buffer.pos;
+    return buffer_list_pos(&data->address_list) + buffer_list_pos(&data->data_list);
 }
 
 /**
@@ -68,7 +83,7 @@ ALWAYS_INLINE static i2c_size_t i2c_data_bytes_transmitted(i2c_data_t* data)
  */
 ALWAYS_INLINE static bool i2c_data_has_address(i2c_data_t* data)
 {
-    return data->address_buffer.ptr != NULL;
+    return buffer_list_valid(&data->address_list);
 }
 
 
@@ -91,6 +106,11 @@ typedef struct _I2C_State{
     //! Каллбэк.
     i2c_callback_t callback;
     
+#if I2C_CALLBACKS_COUNT > 0
+    //! Каллбэки по идентификатору передачи.
+    i2c_callback_t callbacks[I2C_CALLBACKS_COUNT];
+#endif
+    
     //! Каллбэк передачи/приёма ведомым.
     i2c_slave_callback_t slave_callback;
     
@@ -109,8 +129,49 @@ typedef struct _I2C_State{
     //! Флаг наличия передачи.
     bool has_transfer;
     
+    //! Число повторов текущей передачи после потери приоритета.
+    uint8_t arbitration_retries;
+    
+    //! Состояние генератора отсрочки повтора.
+    uint16_t arbitration_lfsr;
+    
+    //! Флаг ожидания повтора после потери приоритета.
+    bool arbitration_pending;
+    
+    //! Число интервалов отсрочки повтора.
+    uint8_t arbitration_slots;
+    
+    //! Число оставшихся интервалов отсрочки повтора.
+    uint8_t arbitration_wait;
+    
     //! Данные для передачи/приёма ведущим.
     i2c_master_data_t master;
+    
+    //! Голова очереди транзакций.
+    i2c_transfer_t* queue_head;
+    
+    //! Хвост очереди транзакций.
+    i2c_transfer_t* queue_tail;
+    
+    //! Флаг выполнения транзакции из головы очереди.
+    bool queue_running;
+    
+#ifdef I2C_TIMEOUT
+    //! Время начала передачи.
+    counter_t start_time;
+    
+    //! Таймаут передачи.
+    counter_t timeout;
+    
+    //! Число прерванных по таймауту передач.
+    uint16_t timeouts;
+    
+    //! Число восстановлений шины.
+    uint16_t recoveries;
+    
+    //! Флаг ожидания восстановления шины.
+    bool recovery_pending;
+#endif
 }i2c_state_t;
 
 /**
@@ -176,6 +237,65 @@ ALWAYS_INLINE static void i2c_set_status(i2c_status_t status)
     _i2c_state.status = status;
 }
 
+#ifdef I2C_TIMEOUT
+/**
+ * Запоминает время начала передачи.
+ */
+ALWAYS_INLINE static void i2c_timeout_start(void)
+{
+    _i2c_state.start_time = system_counter_ticks();
+}
+#else
+#define i2c_timeout_start()
+#endif
+
+/**
+ * Обозначает начало передачи ведущим.
+ */
+ALWAYS_INLINE static void i2c_transfer_begin(void)
+{
+    _i2c_state.has_transfer = true;
+    _i2c_state.arbitration_retries = 0;
+    _i2c_state.arbitration_pending = false;
+    i2c_timeout_start();
+}
+
+/**
+ * Назначает повтор передачи после случайной отсрочки.
+ * Число интервалов берётся из LFSR (x^16 + x^14 + x^13 + x^11 + 1)
+ * и растёт вдвое с каждым повтором.
+ * Интервалы отсчитывает i2c_arbitration_tick().
+ */
+static void i2c_arbitration_backoff(void)
+{
+    uint16_t lfsr = _i2c_state.arbitration_lfsr;
+    uint8_t retries = _i2c_state.arbitration_retries;
+    uint8_t slots;
+    
+    lfsr = (lfsr >> 1) ^ ((lfsr & 0x1) ? 0xb400 : 0x0);
+    _i2c_state.arbitration_lfsr = lfsr;
+    
+    slots = (uint8_t)lfsr & ((retries < 8) ? ((1 << retries) - 1) : 0xff);
+    
+    _i2c_state.arbitration_slots = slots;
+    _i2c_state.arbitration_wait = slots;
+    _i2c_state.arbitration_pending = true;
+}
+
+/**
+ * Получает флаг свободной шины - SCL и SDA в единице.
+ * @return Флаг свободной шины.
+ */
+static bool i2c_bus_idle(void)
+{
+    pin_t scl, sda;
+    
+    pin_init(&scl, I2C_SCL_PORT, I2C_SCL_PIN);
+    pin_init(&sda, I2C_SDA_PORT, I2C_SDA_PIN);
+    
+    return pin_get_value(&scl) && pin_get_value(&sda);
+}
+
 err_t i2c_init(uint16_t freq)
 {
     err_t err = i2c_set_freq(freq);
@@ -183,6 +303,8 @@ err_t i2c_init(uint16_t freq)
     
     memset(&_i2c_state, 0x0, sizeof(i2c_state_t));
     
+    _i2c_state.arbitration_lfsr = I2C_ARBITRATION_SEED_DEFAULT;
+    
     i2c_do_listen();
     
     return E_NO_ERROR;
@@ -225,8 +347,49 @@ bool i2c_interrupted(void)
     return _i2c_state.interrupted;
 }
 
+void i2c_set_arbitration_seed(uint16_t seed)
+{
+    // Запрещаем прерывания глобально, не изменяя TWCR.
+    __interrupts_save_disable();
+    _i2c_state.arbitration_lfsr = seed ? seed : I2C_ARBITRATION_SEED_DEFAULT;
+    __interrupts_restore();
+}
+
+void i2c_arbitration_tick(void)
+{
+    if(!_i2c_state.arbitration_pending) return;
+    
+    // Запрещаем прерывания глобально: запись TWCR
+    // при ожидающем обработки событии сбросила бы флаг TWINT.
+    __interrupts_save_disable();
+    
+    // Флаг мог быть сброшен прерыванием или таймаутом.
+    if(_i2c_state.arbitration_pending){
+        // Шина занята передачей другого ведущего
+        // или обращением к нам - отсчитываем заново.
+        if(!i2c_bus_idle() ||
+           _i2c_state.status == I2C_STATUS_SLAVE_READING ||
+           _i2c_state.status == I2C_STATUS_SLAVE_WRITING){
+            _i2c_state.arbitration_wait = _i2c_state.arbitration_slots;
+        }else if(_i2c_state.arbitration_wait != 0){
+            _i2c_state.arbitration_wait --;
+        }else{
+            _i2c_state.arbitration_pending = false;
+            // Старт будет сформирован аппаратурой
+            // при свободной шине.
+            i2c_do_start();
+        }
+    }
+    
+    __interrupts_restore();
+}
+
 bool i2c_busy(void)
 {
+#ifdef I2C_TIMEOUT
+    // До восстановления шины передачи не начинаются.
+    if(_i2c_state.recovery_pending) return true;
+#endif
     switch(_i2c_state.status){
         case I2C_STATUS_READING:
         case I2C_STATUS_WRITING:
@@ -239,7 +402,14 @@ bool i2c_busy(void)
 
 void i2c_wait(void)
 {
-    WAIT_WHILE_TRUE(i2c_busy());
+    while(i2c_busy()){
+#ifdef I2C_TIMEOUT
+        i2c_timeout_tick();
+        if(_i2c_state.recovery_pending) i2c_bus_recover();
+#else
+        i2c_arbitration_tick();
+#endif
+    }
 }
 
 i2c_callback_t i2c_callback(void)
@@ -252,6 +422,30 @@ void i2c_set_callback(i2c_callback_t callback)
     _i2c_state.callback = callback;
 }
 
+err_t i2c_register_callback(i2c_transfer_id_t id, i2c_callback_t callback)
+{
+#if I2C_CALLBACKS_COUNT > 0
+    if(id >= I2C_CALLBACKS_COUNT) return E_OUT_OF_RANGE;
+    
+    // Запрещаем прерывания глобально, не изменяя TWCR.
+    __interrupts_save_disable();
+    _i2c_state.callbacks[id] = callback;
+    __interrupts_restore();
+    
+    return E_NO_ERROR;
+#else
+    return E_OUT_OF_RANGE;
+#endif
+}
+
+i2c_callback_t i2c_registered_callback(i2c_transfer_id_t id)
+{
+#if I2C_CALLBACKS_COUNT > 0
+    if(id < I2C_CALLBACKS_COUNT) return _i2c_state.callbacks[id];
+#endif
+    return NULL;
+}
+
 i2c_slave_callback_t i2c_slave_callback(void)
 {
     return _i2c_state.slave_callback;
@@ -283,12 +477,12 @@ i2c_size_t i2c_master_bytes_transmitted(void)
 
 ALWAYS_INLINE static void i2c_m_addr_buffer_reset(void)
 {
-    buffer_reset(&_i2c_state.master.data.address_buffer);
+    buffer_list_reset(&_i2c_state.master.data.address_list);
 }
 
 ALWAYS_INLINE static void i2c_m_data_buffer_reset(void)
 {
-    buffer_reset(&_i2c_state.master.data.data_buffer);
+    buffer_list_reset(&_i2c_state.master.data.data_list);
 }
 
 ALWAYS_INLINE static void i2c_m_buffers_reset(void)
@@ -299,42 +493,42 @@ ALWAYS_INLINE static void i2c_m_buffers_reset(void)
 
 ALWAYS_INLINE static bool i2c_m_addr_buffer_has_next(void)
 {
-    return buffer_has_next(&_i2c_state.master.data.address_buffer);
+    return buffer_list_has_next(&_i2c_state.master.data.address_list);
 }
 
 ALWAYS_INLINE static bool i2c_m_data_buffer_has_next(void)
 {
-    return buffer_has_next(&_i2c_state.master.data.data_buffer);
+    return buffer_list_has_next(&_i2c_state.master.data.data_list);
 }
 
 ALWAYS_INLINE static uint8_t i2c_m_addr_buffer_get_next(void)
 {
-    return buffer_get_next(&_i2c_state.master.data.address_buffer);
+    return buffer_list_get_next(&_i2c_state.master.data.address_list);
 }
 
 ALWAYS_INLINE static uint8_t i2c_m_data_buffer_get_next(void)
 {
-    return buffer_get_next(&_i2c_state.master.data.data_buffer);
+    return buffer_list_get_next(&_i2c_state.master.data.data_list);
 }
 
 ALWAYS_INLINE static bool i2c_m_addr_buffer_at_last(void)
 {
-    return buffer_at_last(&_i2c_state.master.data.address_buffer);
+    return buffer_list_at_last(&_i2c_state.master.data.address_list);
 }
 
 ALWAYS_INLINE static bool i2c_m_data_buffer_at_last(void)
 {
-    return buffer_at_last(&_i2c_state.master.data.data_buffer);
+    return buffer_list_at_last(&_i2c_state.master.data.data_list);
 }
 
 ALWAYS_INLINE static void i2c_m_addr_buffer_set_next(uint8_t byte)
 {
-    buffer_set_next(&_i2c_state.master.data.address_buffer, byte);
+    buffer_list_set_next(&_i2c_state.master.data.address_list, byte);
 }
 
 ALWAYS_INLINE static void i2c_m_data_buffer_set_next(uint8_t byte)
 {
-    buffer_set_next(&_i2c_state.master.data.data_buffer, byte);
+    buffer_list_set_next(&_i2c_state.master.data.data_list, byte);
 }
 
 ALWAYS_INLINE static void i2c_next_byte(uint8_t ack)
@@ -376,19 +570,100 @@ ALWAYS_INLINE static void i2c_end(void)
 {
     // Передача окончина.
     _i2c_state.has_transfer = _i2c_state.interrupted;
+    // Транзакции очереди оповещаются собственными каллбэками.
+    if(_i2c_state.queue_running) return;
+#if I2C_CALLBACKS_COUNT > 0
+    // Владелец передачи - без перебора каллбэков.
+    if(_i2c_state.transfer_id < I2C_CALLBACKS_COUNT &&
+       _i2c_state.callbacks[_i2c_state.transfer_id]){
+        _i2c_state.callbacks[_i2c_state.transfer_id]();
+        return;
+    }
+#endif
     if(_i2c_state.callback) _i2c_state.callback();
 }
 
+/**
+ * Загружает транзакцию из головы очереди в данные ведущего.
+ * Вызывается при свободной шине или из прерывания.
+ */
+static void i2c_queue_load(void)
+{
+    i2c_transfer_t* transfer = _i2c_state.queue_head;
+    
+    i2c_data_init_sg(&_i2c_state.master.data,
+                     buffer_valid(&transfer->address) ? &transfer->address : NULL, 1,
+                     &transfer->data, 1);
+    // При повторном старте буферы не сбрасываются автоматом.
+    i2c_m_buffers_reset();
+    
+    _i2c_state.master.device = transfer->device;
+    _i2c_state.master.io_direction = (transfer->action == I2C_READ) ?
+                                     I2C_MASTER_IO_DIRECTION_READ :
+                                     I2C_MASTER_IO_DIRECTION_WRITE;
+    _i2c_state.transfer_id = transfer->id;
+    
+    i2c_transfer_begin();
+    _i2c_state.queue_running = true;
+}
+
+/**
+ * Завершает транзакцию из головы очереди.
+ * Извлекает её из очереди и вызывает её каллбэк.
+ */
+static void i2c_queue_end(void)
+{
+    i2c_transfer_t* transfer = _i2c_state.queue_head;
+    
+    _i2c_state.queue_head = transfer->next;
+    if(_i2c_state.queue_head == NULL) _i2c_state.queue_tail = NULL;
+    transfer->next = NULL;
+    
+    _i2c_state.queue_running = false;
+    _i2c_state.has_transfer = false;
+    
+    transfer->status = _i2c_state.status;
+    if(transfer->callback) transfer->callback(transfer);
+}
+
+/**
+ * Обозначает конец передачи, обычной или из очереди.
+ */
+static void i2c_transfer_end(void)
+{
+    if(_i2c_state.queue_running){
+        i2c_queue_end();
+    }else{
+        i2c_end();
+    }
+}
+
+/**
+ * Начинает следующую транзакцию очереди, если она есть.
+ * На занятой ведущим шине формирует повторный старт.
+ * @return Флаг начала транзакции.
+ */
+static bool i2c_queue_next(void)
+{
+    if(_i2c_state.queue_head == NULL) return false;
+    
+    i2c_queue_load();
+    i2c_do_start();
+    
+    return true;
+}
+
 /**
  * Обработчик окончания приёма/передачи ведущим.
  */
 static void i2c_m_end(void)
 {
     // Обозначим конец передачи.
-    i2c_end();
+    i2c_transfer_end();
     
-    // Если не была инициирована ещё одна передача.
-    if(!_i2c_state.has_transfer){
+    // Если не была инициирована ещё одна передача
+    // и очередь пуста.
+    if(!_i2c_state.has_transfer && !i2c_queue_next()){
         // Пошлём стоп.
         i2c_do_stop();
     }
@@ -399,6 +674,13 @@ static void i2c_m_end(void)
  */
 static void i2c_s_end(void)
 {
+    // Передача ведущего ожидает повтора после потери приоритета.
+    if(_i2c_state.arbitration_pending){
+        // Будем слушать до повтора.
+        i2c_do_listen();
+        return;
+    }
+    
     // Обозначим конец передачи/приёма.
     i2c_end();
     
@@ -441,7 +723,33 @@ err_t i2c_master_setup_rw(i2c_address_t device, void* page_address, size_t page_
     
     _i2c_state.master.device = device;
     
-    _i2c_state.has_transfer = true;
+    i2c_transfer_begin();
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Настраивает шину i2c в режим мастер для передачи списков буферов.
+ * @param device адрес устройства.
+ * @param address буферы адреса в устройстве.
+ * @param address_count число буферов адреса.
+ * @param data буферы данных.
+ * @param data_count число буферов данных.
+ * @return Код ошибки.
+ */
+static err_t i2c_master_setup_rw_sg(i2c_address_t device, buffer_t* address, size_t address_count, buffer_t* data, size_t data_count)
+{
+    if(i2c_is_busy()) return E_BUSY;
+    if(data == NULL) return E_NULL_POINTER;
+    if(data_count == 0) return E_INVALID_VALUE;
+    
+    i2c_data_init_sg(&_i2c_state.master.data, address, address_count, data, data_count);
+    
+    if(buffer_list_size(&_i2c_state.master.data.data_list) == 0) return E_INVALID_VALUE;
+    
+    _i2c_state.master.device = device;
+    
+    i2c_transfer_begin();
     
     return E_NO_ERROR;
 }
@@ -480,6 +788,84 @@ err_t i2c_master_write_at(i2c_address_t device, const void* page_address, size_t
     return err;
 }
 
+err_t i2c_master_read_sg(i2c_address_t device, buffer_t* address, size_t address_count, buffer_t* data, size_t data_count)
+{
+    err_t err = i2c_master_setup_rw_sg(device, address, address_count, data, data_count);
+    
+    if(err == E_NO_ERROR){
+        _i2c_state.master.io_direction = I2C_MASTER_IO_DIRECTION_READ;
+        i2c_do_start();
+    }
+    
+    return err;
+}
+
+err_t i2c_master_write_sg(i2c_address_t device, buffer_t* data, size_t data_count)
+{
+    err_t err = i2c_master_setup_rw_sg(device, NULL, 0, data, data_count);
+    
+    if(err == E_NO_ERROR){
+        _i2c_state.master.io_direction = I2C_MASTER_IO_DIRECTION_WRITE;
+        i2c_do_start();
+    }
+    
+    return err;
+}
+
+void i2c_transfer_init(i2c_transfer_t* transfer, i2c_address_t device, i2c_action_t action,
+                       const void* page_address, size_t page_address_size,
+                       void* data, i2c_size_t data_size,
+                       i2c_transfer_callback_t callback, void* user_data)
+{
+    transfer->next = NULL;
+    transfer->device = device;
+    transfer->action = action;
+    transfer->id = I2C_DEFAULT_TRANSFER_ID;
+    transfer->status = I2C_STATUS_IDLE;
+    buffer_init(&transfer->address, (uint8_t*)page_address, page_address ? page_address_size : 0);
+    buffer_init(&transfer->data, data, data_size);
+    transfer->callback = callback;
+    transfer->user_data = user_data;
+}
+
+err_t i2c_submit(i2c_transfer_t* transfer)
+{
+    if(transfer == NULL) return E_NULL_POINTER;
+    if(!buffer_valid(&transfer->data)) return E_NULL_POINTER;
+    if(transfer->data.size == 0) return E_INVALID_VALUE;
+    if(buffer_valid(&transfer->address) && transfer->address.size == 0) return E_INVALID_VALUE;
+    if(transfer->status == I2C_STATUS_QUEUED) return E_BUSY;
+    
+    transfer->next = NULL;
+    transfer->status = I2C_STATUS_QUEUED;
+    
+    // Запрещаем прерывания глобально: запись TWCR
+    // при ожидающем обработки событии сбросила бы флаг TWINT.
+    __interrupts_save_disable();
+    
+    if(_i2c_state.queue_tail != NULL){
+        _i2c_state.queue_tail->next = transfer;
+    }else{
+        _i2c_state.queue_head = transfer;
+    }
+    _i2c_state.queue_tail = transfer;
+    
+    // Шина свободна - начнём немедленно,
+    // иначе транзакцию начнёт прерывание.
+    if(!i2c_busy()){
+        i2c_queue_next();
+    }
+    
+    __interrupts_restore();
+    
+    return E_NO_ERROR;
+}
+
+bool i2c_queue_empty(void)
+{
+    return _i2c_state.queue_head == NULL;
+}
+
 void i2c_slave_listen(void)
 {
     _i2c_state.listening = true;
@@ -496,6 +882,200 @@ void i2c_slave_end_listening(void)
     }
 }
 
+#ifdef I2C_TIMEOUT
+/**
+ * Освобождает шину: до девяти тактов SCL,
+ * пока ведомый не отпустит SDA, затем стоп.
+ * TWI должен быть отключен.
+ * Линии управляются как открытый сток:
+ * ноль - выход с нулём, единица - вход (внешняя подтяжка).
+ * Подтяжки линий на время тактов отключаются
+ * и восстанавливаются по окончании.
+ * @return Флаг освобождения SDA.
+ */
+static bool i2c_bus_recover_pins(void)
+{
+    pin_t scl, sda;
+    uint8_t scl_pullup, sda_pullup;
+    uint8_t i;
+    bool released;
+    
+    pin_init(&scl, I2C_SCL_PORT, I2C_SCL_PIN);
+    pin_init(&sda, I2C_SDA_PORT, I2C_SDA_PIN);
+    
+    scl_pullup = pin_get_out_value(&scl);
+    sda_pullup = pin_get_out_value(&sda);
+    
+    pin_set_in(&scl);
+    pin_set_in(&sda);
+    pin_off(&scl);
+    pin_off(&sda);
+    
+    for(i = 0; i < 9 && pin_get_value(&sda) == 0; i ++){
+        pin_set_out(&scl);
+        _delay_us(I2C_RECOVERY_HALF_PERIOD_US);
+        pin_set_in(&scl);
+        _delay_us(I2C_RECOVERY_HALF_PERIOD_US);
+    }
+    
+    // Стоп: SDA из нуля в единицу при высоком SCL.
+    pin_set_out(&scl);
+    _delay_us(I2C_RECOVERY_HALF_PERIOD_US);
+    pin_set_out(&sda);
+    _delay_us(I2C_RECOVERY_HALF_PERIOD_US);
+    pin_set_in(&scl);
+    _delay_us(I2C_RECOVERY_HALF_PERIOD_US);
+    pin_set_in(&sda);
+    _delay_us(I2C_RECOVERY_HALF_PERIOD_US);
+    
+    released = pin_get_value(&sda) != 0;
+    
+    pin_set_value(&scl, scl_pullup);
+    pin_set_value(&sda, sda_pullup);
+    
+    return released;
+}
+
+void i2c_set_timeout(counter_t ticks)
+{
+    _i2c_state.timeout = ticks;
+}
+
+counter_t i2c_timeout(void)
+{
+    return _i2c_state.timeout;
+}
+
+err_t i2c_timeout_tick(void)
+{
+    err_t err = E_NO_ERROR;
+    
+    // Отсрочка повтора после потери приоритета
+    // отсчитывается тем же периодическим вызовом.
+    i2c_arbitration_tick();
+    
+    if(_i2c_state.timeout == 0) return E_NO_ERROR;
+    
+    // Запрещаем прерывания глобально: запись TWCR
+    // с сохранённым TWIE сбросила бы флаг TWINT.
+    // Каллбэки вызываются, как и из прерывания TWI,
+    // при запрещённых прерываниях.
+    __interrupts_save_disable();
+    
+    if(!_i2c_state.recovery_pending && i2c_busy() &&
+       system_counter_diff(&_i2c_state.start_time) >= _i2c_state.timeout){
+        // Отключим TWI, освободив линии.
+        TWCR = 0;
+        
+        _i2c_state.timeouts ++;
+        
+        // Передача завершится после восстановления шины
+        // в i2c_bus_recover() - такты SCL занимают
+        // сотню микросекунд и здесь не формируются.
+        i2c_set_status(I2C_STATUS_TIMEOUT);
+        _i2c_state.interrupted = false;
+        _i2c_state.arbitration_pending = false;
+        _i2c_state.recovery_pending = true;
+        
+        err = E_I2C_TIMEOUT;
+    }
+    
+    __interrupts_restore();
+    
+    return err;
+}
+
+/**
+ * Начинает восстановление шины.
+ * Занятость шины на время восстановления не даст
+ * начать передачу из прерываний.
+ * @return Код ошибки.
+ */
+static err_t i2c_recovery_begin(void)
+{
+    err_t err = E_NO_ERROR;
+    
+    __interrupts_save_disable();
+    
+    if(!_i2c_state.recovery_pending){
+        if(i2c_busy()){
+            err = E_BUSY;
+        }else{
+            _i2c_state.recovery_pending = true;
+            TWCR = 0;
+        }
+    }
+    
+    __interrupts_restore();
+    
+    return err;
+}
+
+/**
+ * Завершает восстановление шины, прерванную
+ * по таймауту передачу, и начинает следующую.
+ */
+static void i2c_recovery_end(void)
+{
+    __interrupts_save_disable();
+    
+    _i2c_state.recoveries ++;
+    _i2c_state.recovery_pending = false;
+    
+    if(_i2c_state.has_transfer && _i2c_state.status == I2C_STATUS_TIMEOUT){
+        i2c_transfer_end();
+    }
+    
+    // Если не была инициирована ещё одна передача
+    // и очередь пуста - вернёмся к прослушиванию.
+    if(!_i2c_state.has_transfer && !i2c_queue_next()){
+        i2c_do_listen();
+    }
+    
+    __interrupts_restore();
+}
+
+bool i2c_bus_recovery_pending(void)
+{
+    return _i2c_state.recovery_pending;
+}
+
+err_t i2c_bus_recover(void)
+{
+    bool released;
+    
+    err_t err = i2c_recovery_begin();
+    if(err != E_NO_ERROR) return err;
+    
+    // TWI отключен - такты формируются при разрешённых прерываниях.
+    released = i2c_bus_recover_pins();
+    
+    i2c_recovery_end();
+    
+    return released ? E_NO_ERROR : E_I2C_BUS_STUCK;
+}
+
+uint16_t i2c_timeouts(void)
+{
+    return _i2c_state.timeouts;
+}
+
+uint16_t i2c_recoveries(void)
+{
+    return _i2c_state.recoveries;
+}
+
+void i2c_reset_recovery_counters(void)
+{
+    __interrupts_save_disable();
+    
+    _i2c_state.timeouts = 0;
+    _i2c_state.recoveries = 0;
+    
+    __interrupts_restore();
+}
+#endif
+
 /*static uint8_t _twi_status = TW_NO_INFO;
 
 uint8_t i2c_twi_status(void)
@@ -523,7 +1103,9 @@ ISR(TWI_vect)
             //Установим состояние.
             i2c_set_status(I2C_STATUS_BUS_ERROR);
             //Закончим передачу.
-            i2c_end();
+            i2c_transfer_end();
+            //Продолжим очередь.
+            if(!_i2c_state.has_transfer) i2c_queue_next();
             break;
         //Master
         //Transmitter
@@ -632,16 +1214,28 @@ ISR(TWI_vect)
         //Мастер потерял шину, другой мастер обратился к слейву.
         case TW_MT_ARB_LOST:
         //case TW_MR_ARB_LOST:
-            //Установим ошибку потери приоритета.
-            i2c_set_status(I2C_STATUS_ARBITRATION_LOST);
-            //Установим флаг прерванной передачи.
-            _i2c_state.interrupted = true;
             //сбросим буферы.
             i2c_m_buffers_reset();
-            //Обозначим конец передачи.
-            i2c_end();
-            //Сформируем старт как только освободится шина.
-            i2c_do_start();
+            //Если повторы не исчерпаны.
+            if(_i2c_state.arbitration_retries < I2C_ARBITRATION_RETRIES){
+                _i2c_state.arbitration_retries ++;
+                //Назначим повтор после случайной отсрочки,
+                //отсчитываемой i2c_arbitration_tick()
+                //при свободной шине.
+                i2c_arbitration_backoff();
+                //До повтора будем слушать шину.
+                i2c_do_listen();
+            }else{
+                //Установим ошибку потери приоритета.
+                i2c_set_status(I2C_STATUS_ARBITRATION_LOST);
+                //Обозначим конец передачи.
+                i2c_transfer_end();
+                //Если не была инициирована ещё одна передача
+                //и очередь пуста - будем слушать шину.
+                if(!_i2c_state.has_transfer && !i2c_queue_next()){
+                    i2c_do_listen();
+                }
+            }
             break;
         //Receiver
         //Мастер получил ACK на перданный SLA+R.
@@ -10,11 +10,17 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "errors/errors.h"
+#include "buffer/buffer.h"
+#ifdef I2C_TIMEOUT
+#include "counter/counter.h"
+#endif
 
 
 //Ошибки.
 #define E_I2C                           (E_USER + 20)
 #define E_I2C_INVALID_FREQ              (E_I2C + 1)
+#define E_I2C_TIMEOUT                   (E_I2C + 2)
+#define E_I2C_BUS_STUCK                 (E_I2C + 3)
 
 //Адресация.
 #define I2C_ADDRESS_MAX         0x7f
@@ -37,10 +43,38 @@
 #define I2C_STATUS_ARBITRATION_LOST    10
 #define I2C_STATUS_NOT_RESPONDING      11
 #define I2C_STATUS_REJECTED            12
+#define I2C_STATUS_QUEUED              13
+#define I2C_STATUS_TIMEOUT             14
 
 //Значение байта по-умолчанию.
 #define I2C_DATA_DEFAULT_VALUE 0xff
 
+//! Число повторов передачи ведущим после потери приоритета.
+//! Статус I2C_STATUS_ARBITRATION_LOST сообщается
+//! только после исчерпания повторов.
+#ifndef I2C_ARBITRATION_RETRIES
+#define I2C_ARBITRATION_RETRIES 3
+#endif
+
+//! Пины шины (ATmega16: SCL - PC0, SDA - PC1).
+//! Используются для определения свободной шины
+//! при отсрочке повтора и для восстановления шины.
+#ifndef I2C_SCL_PORT
+#define I2C_SCL_PORT PORT_C
+#endif
+#ifndef I2C_SCL_PIN
+#define I2C_SCL_PIN 0
+#endif
+#ifndef I2C_SDA_PORT
+#define I2C_SDA_PORT PORT_C
+#endif
+#ifndef I2C_SDA_PIN
+#define I2C_SDA_PIN 1
+#endif
+
+//! Начальное значение генератора отсрочки по умолчанию.
+#define I2C_ARBITRATION_SEED_DEFAULT 0xace1
+
 /**
  * Тип размера данных.
  */
@@ -89,11 +123,55 @@ typedef bool (*i2c_slave_callback_t)(i2c_action_t action, uint8_t* data);
 //Идентификатор передачи по умолчанию.
 #define I2C_DEFAULT_TRANSFER_ID 0
 
+//! Размер таблицы каллбэков по идентификатору передачи.
+//! Передачи с идентификатором вне таблицы
+//! обрабатываются каллбэком ведущего.
+#ifndef I2C_CALLBACKS_COUNT
+#define I2C_CALLBACKS_COUNT 8
+#endif
+
 /**
  * Тип идентификатора передачи.
  */
 typedef uint8_t i2c_transfer_id_t;
 
+struct _I2C_Transfer;
+
+/**
+ * Тип каллбэка транзакции очереди.
+ * Вызывается из прерывания по окончании транзакции.
+ * Из каллбэка можно поставить в очередь новую транзакцию,
+ * в том числе повторно ту же самую.
+ * @param transfer Завершённая транзакция.
+ */
+typedef void (*i2c_transfer_callback_t)(struct _I2C_Transfer* transfer);
+
+/**
+ * Транзакция очереди i2c.
+ * Память транзакции и её буферов принадлежит вызывающему
+ * и должна существовать до окончания транзакции.
+ */
+typedef struct _I2C_Transfer {
+    //! Следующая транзакция в очереди.
+    struct _I2C_Transfer* next;
+    //! Адрес устройства.
+    i2c_address_t device;
+    //! Действие (I2C_READ или I2C_WRITE).
+    i2c_action_t action;
+    //! Идентификатор передачи.
+    i2c_transfer_id_t id;
+    //! Статус: I2C_STATUS_QUEUED до окончания, затем итоговый статус.
+    volatile i2c_status_t status;
+    //! Адрес в устройстве (ptr == NULL при отсутствии).
+    buffer_t address;
+    //! Данные.
+    buffer_t data;
+    //! Каллбэк окончания, или NULL.
+    i2c_transfer_callback_t callback;
+    //! Пользовательские данные.
+    void* user_data;
+}i2c_transfer_t;
+
 /**
  * Инициализирует состояние шины i2c.
  * @param freq Частота в kHz.
@@ -128,6 +206,35 @@ extern i2c_status_t i2c_status(void);
  */
 extern bool i2c_interrupted(void);
 
+/**
+ * Устанавливает начальное значение генератора
+ * случайной отсрочки повтора после потери приоритета.
+ * Одинаковое значение даёт одинаковую последовательность отсрочек.
+ * Разным ведущим на шине следует задавать разные значения.
+ * Повтор формируется только i2c_arbitration_tick(), поэтому
+ * её (или i2c_timeout_tick() при I2C_TIMEOUT) необходимо
+ * вызывать периодически - из прерывания таймера или основного цикла.
+ * Иначе после потери приоритета передача не завершится
+ * для тех, кто ждёт её не через i2c_wait() (каллбэки,
+ * future_wait() драйверов устройств).
+ * @param seed Начальное значение, 0 заменяется на I2C_ARBITRATION_SEED_DEFAULT.
+ */
+extern void i2c_set_arbitration_seed(uint16_t seed);
+
+/**
+ * Отсчитывает отсрочку повтора передачи после потери приоритета.
+ * Каждый вызов при свободной шине (SCL и SDA в единице)
+ * отсчитывает один интервал отсрочки, при занятой шине
+ * отсчёт начинается заново. Перед n-м повтором выжидается
+ * случайное число интервалов от 0 до 2^n - 1, после чего
+ * формируется старт.
+ * Необходимо вызывать периодически - из основного цикла
+ * или прерывания таймера (системного счётчика).
+ * Период вызова задаёт длительность интервала.
+ * Вызывается в i2c_wait() и i2c_timeout_tick().
+ */
+extern void i2c_arbitration_tick(void);
+
 /**
  * Получает занятость шины.
  * @return true если шина занята, иначе false.
@@ -154,6 +261,24 @@ extern i2c_callback_t i2c_callback(void);
  */
 extern void i2c_set_callback(i2c_callback_t callback);
 
+/**
+ * Регистрирует каллбэк ведущего для идентификатора передачи.
+ * По окончании передачи с этим идентификатором
+ * вызывается только зарегистрированный каллбэк,
+ * для остальных - каллбэк ведущего.
+ * @param id Идентификатор передачи, меньше I2C_CALLBACKS_COUNT.
+ * @param callback Каллбэк, или NULL для удаления регистрации.
+ * @return Код ошибки.
+ */
+extern err_t i2c_register_callback(i2c_transfer_id_t id, i2c_callback_t callback);
+
+/**
+ * Получает каллбэк, зарегистрированный для идентификатора передачи.
+ * @param id Идентификатор передачи.
+ * @return Каллбэк, или NULL.
+ */
+extern i2c_callback_t i2c_registered_callback(i2c_transfer_id_t id);
+
 /**
  * Получает каллбэк принимающего ведомого.
  * @return Каллбэк принимающего ведомого.
@@ -222,6 +347,85 @@ extern err_t i2c_master_write(i2c_address_t device, const void* data, i2c_size_t
  */
 extern err_t i2c_master_write_at(i2c_address_t device, const void* page_address, size_t page_address_size, const void* data, i2c_size_t data_size);
 
+/**
+ * Получает данные по шине i2c в режиме мастер
+ * в список буферов, предварительно передав
+ * адрес в устройстве из списка буферов.
+ * Буферы должны существовать до окончания передачи.
+ * @param device адрес устройства.
+ * @param address буферы адреса в устройстве, или NULL.
+ * @param address_count число буферов адреса.
+ * @param data буферы данных.
+ * @param data_count число буферов данных.
+ * @return Код ошибки.
+ */
+extern err_t i2c_master_read_sg(i2c_address_t device, buffer_t* address, size_t address_count, buffer_t* data, size_t data_count);
+
+/**
+ * Передаёт данные из списка буферов
+ * по шине i2c в режиме мастер одной транзакцией.
+ * Буферы должны существовать до окончания передачи.
+ * @param device адрес устройства.
+ * @param data буферы данных.
+ * @param data_count число буферов данных.
+ * @return Код ошибки.
+ */
+extern err_t i2c_master_write_sg(i2c_address_t device, buffer_t* data, size_t data_count);
+
+/**
+ * Инициализирует транзакцию очереди.
+ * @param transfer Транзакция.
+ * @param device Адрес устройства.
+ * @param action Действие (I2C_READ или I2C_WRITE).
+ * @param page_address Адрес в устройстве, или NULL.
+ * @param page_address_size Размер адреса в устройстве.
+ * @param data Данные.
+ * @param data_size Размер данных.
+ * @param callback Каллбэк окончания, или NULL.
+ * @param user_data Пользовательские данные.
+ */
+extern void i2c_transfer_init(i2c_transfer_t* transfer, i2c_address_t device, i2c_action_t action,
+                              const void* page_address, size_t page_address_size,
+                              void* data, i2c_size_t data_size,
+                              i2c_transfer_callback_t callback, void* user_data);
+
+/**
+ * Ставит транзакцию в очередь.
+ * Если шина свободна - транзакция начинается немедленно,
+ * иначе - по окончании предыдущей, через повторный старт
+ * без освобождения шины и участия основного цикла.
+ * Транзакции очереди не вызывают каллбэк ведущего.
+ * @param transfer Транзакция.
+ * @return Код ошибки.
+ */
+extern err_t i2c_submit(i2c_transfer_t* transfer);
+
+/**
+ * Получает флаг окончания транзакции.
+ * @param transfer Транзакция.
+ * @return Флаг окончания транзакции.
+ */
+ALWAYS_INLINE static bool i2c_transfer_done(const i2c_transfer_t* transfer)
+{
+    return transfer->status != I2C_STATUS_QUEUED;
+}
+
+/**
+ * Получает число переданных или принятых байт транзакции.
+ * @param transfer Транзакция.
+ * @return Число байт.
+ */
+ALWAYS_INLINE static i2c_size_t i2c_transfer_bytes_transmitted(const i2c_transfer_t* transfer)
+{
+    return transfer->address.pos + transfer->data.pos;
+}
+
+/**
+ * Получает флаг наличия транзакций в очереди.
+ * @return Флаг наличия транзакций в очереди.
+ */
+extern bool i2c_queue_empty(void);
+
 /**
  * Начинает слушать запросы к данным по шине i2c в режиме слейв.
  */
@@ -232,6 +436,84 @@ extern void i2c_slave_listen(void);
  */
 extern void i2c_slave_end_listening(void);
 
+#ifdef I2C_TIMEOUT
+
+/*
+ * Таймауты передач и восстановление шины.
+ * Время передачи отсчитывается системным счётчиком
+ * от её начала. По истечении таймаута i2c_timeout_tick()
+ * отключает TWI и устанавливает статус I2C_STATUS_TIMEOUT.
+ * Шина остаётся занятой до вызова i2c_bus_recover()
+ * из основного цикла: он освобождает шину девятью тактами SCL
+ * и стопом при разрешённых прерываниях, после чего
+ * завершает передачу. i2c_wait() вызывает его сам.
+ */
+
+//! Полупериод SCL при восстановлении шины, мкс.
+#ifndef I2C_RECOVERY_HALF_PERIOD_US
+#define I2C_RECOVERY_HALF_PERIOD_US 5
+#endif
+
+/**
+ * Устанавливает таймаут передачи.
+ * @param ticks Таймаут в тиках системного счётчика, 0 - без таймаута.
+ */
+extern void i2c_set_timeout(counter_t ticks);
+
+/**
+ * Получает таймаут передачи.
+ * @return Таймаут в тиках системного счётчика.
+ */
+extern counter_t i2c_timeout(void);
+
+/**
+ * Проверяет таймаут текущей передачи и прерывает её.
+ * Отсчитывает отсрочку повтора после потери приоритета
+ * вызовом i2c_arbitration_tick().
+ * Следует вызывать периодически - из основного цикла
+ * или прерывания системного счётчика.
+ * Вызывается в i2c_wait().
+ * @return E_I2C_TIMEOUT, если передача прервана, иначе E_NO_ERROR.
+ */
+extern err_t i2c_timeout_tick(void);
+
+/**
+ * Получает флаг ожидания восстановления шины
+ * после прерванной по таймауту передачи.
+ * @return Флаг ожидания восстановления шины.
+ */
+extern bool i2c_bus_recovery_pending(void);
+
+/**
+ * Освобождает шину тактами SCL и формирует стоп.
+ * Длится около десяти периодов SCL при разрешённых
+ * прерываниях, поэтому вызывается из основного цикла.
+ * После таймаута завершает прерванную передачу
+ * и начинает следующую транзакцию очереди.
+ * Иначе шина не должна быть занята передачей.
+ * @return Код ошибки, E_I2C_BUS_STUCK если SDA осталась прижатой.
+ */
+extern err_t i2c_bus_recover(void);
+
+/**
+ * Получает число прерванных по таймауту передач.
+ * @return Число прерванных передач.
+ */
+extern uint16_t i2c_timeouts(void);
+
+/**
+ * Получает число восстановлений шины.
+ * @return Число восстановлений шины.
+ */
+extern uint16_t i2c_recoveries(void);
+
+/**
+ * Сбрасывает счётчики таймаутов и восстановлений шины.
+ */
+extern void i2c_reset_recovery_counters(void);
+
+#endif
+
 //extern uint8_t i2c_twi_status(void);
 
 #endif	/* I2C_H */
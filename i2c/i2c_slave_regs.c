@@ -0,0 +1,261 @@
+#include "i2c_slave_regs.h"
+#include <avr/pgmspace.h>
+#include <avr/interrupt.h>
+#include "utils/utils.h"
+
+
+//! Размер массива флагов изменения.
+#define I2C_SLAVE_REGS_DIRTY_SIZE ((I2C_SLAVE_REGS_MAX + 7) / 8)
+
+
+/**
+ * Состояние файла регистров.
+ */
+typedef struct _I2C_Slave_Regs_State {
+    //! Регистры в ОЗУ.
+    uint8_t* regs;
+    //! Регистры во флеш-памяти.
+    const uint8_t* regs_P;
+    //! Маски записываемых бит во флеш-памяти.
+    const uint8_t* write_mask_P;
+    //! Число регистров.
+    uint8_t count;
+    //! Номер текущего регистра.
+    uint8_t pointer;
+    //! Флаг ожидания номера регистра.
+    bool wait_pointer;
+    //! Флаги изменения регистров.
+    uint8_t dirty[I2C_SLAVE_REGS_DIRTY_SIZE];
+    //! Снимок регистров в ОЗУ для текущего чтения ведущим.
+    uint8_t shadow[I2C_SLAVE_REGS_MAX];
+}i2c_slave_regs_state_t;
+
+static i2c_slave_regs_state_t i2c_slave_regs;
+
+
+/**
+ * Инициализирует общее состояние.
+ * @param count Число регистров.
+ */
+static void i2c_slave_regs_reset(uint8_t count)
+{
+    uint8_t i;
+    
+    i2c_slave_regs.count = count;
+    i2c_slave_regs.pointer = 0;
+    i2c_slave_regs.wait_pointer = false;
+    
+    for(i = 0; i < I2C_SLAVE_REGS_DIRTY_SIZE; i ++){
+        i2c_slave_regs.dirty[i] = 0;
+    }
+}
+
+err_t i2c_slave_regs_init(uint8_t* regs, const uint8_t* write_mask, uint8_t count)
+{
+    if(regs == NULL) return E_NULL_POINTER;
+    if(count == 0 || count > I2C_SLAVE_REGS_MAX) return E_OUT_OF_RANGE;
+    
+    __interrupts_save_disable();
+    
+    i2c_slave_regs.regs = regs;
+    i2c_slave_regs.regs_P = NULL;
+    i2c_slave_regs.write_mask_P = write_mask;
+    i2c_slave_regs_reset(count);
+    
+    __interrupts_restore();
+    
+    return E_NO_ERROR;
+}
+
+err_t i2c_slave_regs_init_P(const uint8_t* regs, uint8_t count)
+{
+    if(regs == NULL) return E_NULL_POINTER;
+    if(count == 0 || count > I2C_SLAVE_REGS_MAX) return E_OUT_OF_RANGE;
+    
+    __interrupts_save_disable();
+    
+    i2c_slave_regs.regs = NULL;
+    i2c_slave_regs.regs_P = regs;
+    i2c_slave_regs.write_mask_P = NULL;
+    i2c_slave_regs_reset(count);
+    
+    __interrupts_restore();
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Получает значение регистра.
+ * @param reg Номер регистра.
+ * @return Значение регистра.
+ */
+ALWAYS_INLINE static uint8_t i2c_slave_regs_get(uint8_t reg)
+{
+    if(i2c_slave_regs.regs != NULL) return i2c_slave_regs.regs[reg];
+    return pgm_read_byte(&i2c_slave_regs.regs_P[reg]);
+}
+
+/**
+ * Делает снимок регистров в ОЗУ начиная с текущего
+ * номера регистра в начале чтения ведущим (SLA+R).
+ * Всё чтение обслуживается из снимка, поэтому запись
+ * регистров основным циклом во время чтения ведущим
+ * не приводит к передаче наполовину обновлённых значений.
+ */
+ALWAYS_INLINE static void i2c_slave_regs_latch(void)
+{
+    uint8_t reg;
+    
+    if(i2c_slave_regs.regs == NULL) return;
+    
+    for(reg = i2c_slave_regs.pointer; reg < i2c_slave_regs.count; reg ++){
+        i2c_slave_regs.shadow[reg] = i2c_slave_regs.regs[reg];
+    }
+}
+
+/**
+ * Получает значение регистра из снимка для чтения ведущим.
+ * @param reg Номер регистра.
+ * @return Значение регистра.
+ */
+ALWAYS_INLINE static uint8_t i2c_slave_regs_get_latched(uint8_t reg)
+{
+    if(i2c_slave_regs.regs != NULL) return i2c_slave_regs.shadow[reg];
+    return pgm_read_byte(&i2c_slave_regs.regs_P[reg]);
+}
+
+/**
+ * Записывает принятый от ведущего байт в регистр.
+ * @param reg Номер регистра.
+ * @param value Значение.
+ */
+ALWAYS_INLINE static void i2c_slave_regs_put(uint8_t reg, uint8_t value)
+{
+    uint8_t mask;
+    
+    // Регистры во флеш-памяти только для чтения.
+    if(i2c_slave_regs.regs == NULL) return;
+    
+    mask = (i2c_slave_regs.write_mask_P != NULL) ?
+            pgm_read_byte(&i2c_slave_regs.write_mask_P[reg]) : 0xff;
+    
+    if(mask == 0) return;
+    
+    i2c_slave_regs.regs[reg] = (i2c_slave_regs.regs[reg] & ~mask) | (value & mask);
+    i2c_slave_regs.dirty[reg >> 3] |= (1 << (reg & 0x7));
+}
+
+bool i2c_slave_regs_callback(i2c_action_t action, uint8_t* data)
+{
+    uint8_t reg;
+    
+    // Начало обращения ведущего.
+    if(data == NULL){
+        // Запись начинается с номера регистра.
+        if(action == I2C_READ){
+            i2c_slave_regs.wait_pointer = true;
+        // Чтение - из снимка регистров.
+        }else{
+            i2c_slave_regs_latch();
+        }
+        return i2c_slave_regs.count != 0;
+    }
+    
+    reg = i2c_slave_regs.pointer;
+    
+    if(action == I2C_READ){
+        if(i2c_slave_regs.wait_pointer){
+            i2c_slave_regs.wait_pointer = false;
+            i2c_slave_regs.pointer = *data;
+        }else{
+            // Байты за последним регистром игнорируются.
+            if(reg >= i2c_slave_regs.count) return false;
+            i2c_slave_regs_put(reg, *data);
+            i2c_slave_regs.pointer = ++ reg;
+        }
+    }else{//I2C_WRITE
+        if(reg >= i2c_slave_regs.count) return false;
+        *data = i2c_slave_regs_get_latched(reg);
+        i2c_slave_regs.pointer = ++ reg;
+    }
+    
+    return i2c_slave_regs.pointer < i2c_slave_regs.count;
+}
+
+err_t i2c_slave_regs_write(uint8_t reg, const void* data, uint8_t size)
+{
+    const uint8_t* src = (const uint8_t*)data;
+    
+    if(data == NULL) return E_NULL_POINTER;
+    if(i2c_slave_regs.regs == NULL) return E_INVALID_VALUE;
+    if((uint16_t)reg + size > i2c_slave_regs.count) return E_OUT_OF_RANGE;
+    
+    __interrupts_save_disable();
+    
+    while(size --){
+        i2c_slave_regs.regs[reg ++] = *src ++;
+    }
+    
+    __interrupts_restore();
+    
+    return E_NO_ERROR;
+}
+
+err_t i2c_slave_regs_read(uint8_t reg, void* data, uint8_t size)
+{
+    uint8_t* dst = (uint8_t*)data;
+    
+    if(data == NULL) return E_NULL_POINTER;
+    if((uint16_t)reg + size > i2c_slave_regs.count) return E_OUT_OF_RANGE;
+    
+    __interrupts_save_disable();
+    
+    while(size --){
+        *dst ++ = i2c_slave_regs_get(reg ++);
+    }
+    
+    __interrupts_restore();
+    
+    return E_NO_ERROR;
+}
+
+bool i2c_slave_regs_any_dirty(void)
+{
+    uint8_t i;
+    
+    for(i = 0; i < I2C_SLAVE_REGS_DIRTY_SIZE; i ++){
+        if(i2c_slave_regs.dirty[i] != 0) return true;
+    }
+    
+    return false;
+}
+
+bool i2c_slave_regs_take_dirty(uint8_t reg)
+{
+    uint8_t mask = 1 << (reg & 0x7);
+    bool dirty;
+    
+    if(reg >= i2c_slave_regs.count) return false;
+    
+    __interrupts_save_disable();
+    
+    dirty = (i2c_slave_regs.dirty[reg >> 3] & mask) != 0;
+    i2c_slave_regs.dirty[reg >> 3] &= ~mask;
+    
+    __interrupts_restore();
+    
+    return dirty;
+}
+
+void i2c_slave_regs_clear_dirty(void)
+{
+    uint8_t i;
+    
+    __interrupts_save_disable();
+    
+    for(i = 0; i < I2C_SLAVE_REGS_DIRTY_SIZE; i ++){
+        i2c_slave_regs.dirty[i] = 0;
+    }
+    
+    __interrupts_restore();
+}
@@ -0,0 +1,116 @@
+/**
+ * @file i2c_slave_regs.h
+ * Эмуляция файла регистров ведомого i2c.
+ *
+ * Реализует каллбэк ведомого (i2c_slave_callback_t),
+ * обслуживающий обращения ведущего к массиву регистров
+ * без побайтовых каллбэков приложения:
+ * первый записанный ведущим байт - номер регистра,
+ * последующие записываются в регистры, чтение
+ * возвращает регистры начиная с текущего номера.
+ * Номер регистра автоматически увеличивается после
+ * каждого переданного или принятого байта.
+ *
+ * Регистры хранятся в ОЗУ (с маской записываемых бит)
+ * или во флеш-памяти (только чтение).
+ * Записанные ведущим регистры отмечаются флагами изменения,
+ * которые опрашиваются в основном цикле.
+ *
+ * В начале чтения ведущим (SLA+R) регистры в ОЗУ, начиная
+ * с текущего номера, копируются в снимок, из которого
+ * обслуживается всё чтение до стопа или повторного старта.
+ * Поэтому многобайтовое значение, записанное одним вызовом
+ * i2c_slave_regs_write(), ведущий читает целиком старым
+ * или целиком новым. Снимок занимает I2C_SLAVE_REGS_MAX байт ОЗУ.
+ *
+ * Использование:
+ *   i2c_slave_regs_init(regs, regs_wmask, sizeof(regs));
+ *   i2c_set_slave_callback(i2c_slave_regs_callback);
+ *   i2c_set_address(address, I2C_BROADCAST_DISABLED);
+ *   i2c_slave_listen();
+ */
+
+#ifndef I2C_SLAVE_REGS_H
+#define	I2C_SLAVE_REGS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "errors/errors.h"
+#include "i2c.h"
+
+
+//! Максимальное число регистров.
+#ifndef I2C_SLAVE_REGS_MAX
+#define I2C_SLAVE_REGS_MAX 32
+#endif
+
+
+/**
+ * Инициализирует файл регистров в ОЗУ.
+ * @param regs Регистры.
+ * @param write_mask Маски записываемых ведущим бит
+ * для каждого регистра во флеш-памяти (PROGMEM),
+ * или NULL, если все биты всех регистров записываемы.
+ * @param count Число регистров, не более I2C_SLAVE_REGS_MAX.
+ * @return Код ошибки.
+ */
+extern err_t i2c_slave_regs_init(uint8_t* regs, const uint8_t* write_mask, uint8_t count);
+
+/**
+ * Инициализирует файл регистров во флеш-памяти.
+ * Регистры доступны ведущему только для чтения.
+ * @param regs Регистры во флеш-памяти (PROGMEM).
+ * @param count Число регистров, не более I2C_SLAVE_REGS_MAX.
+ * @return Код ошибки.
+ */
+extern err_t i2c_slave_regs_init_P(const uint8_t* regs, uint8_t count);
+
+/**
+ * Каллбэк ведомого i2c, обслуживающий файл регистров.
+ * @param action Действие.
+ * @param data Буфер с принятым байтом, либо для передаваемого байта.
+ * @return Возможность принимать или передавать ещё данные.
+ */
+extern bool i2c_slave_regs_callback(i2c_action_t action, uint8_t* data);
+
+/**
+ * Атомарно записывает значения регистров в ОЗУ.
+ * Уже начатое чтение ведущим передаёт снимок регистров,
+ * новые значения видны со следующего чтения.
+ * Флаги изменения не устанавливаются.
+ * @param reg Номер первого регистра.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Код ошибки.
+ */
+extern err_t i2c_slave_regs_write(uint8_t reg, const void* data, uint8_t size);
+
+/**
+ * Атомарно читает значения регистров.
+ * @param reg Номер первого регистра.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Код ошибки.
+ */
+extern err_t i2c_slave_regs_read(uint8_t reg, void* data, uint8_t size);
+
+/**
+ * Получает флаг наличия изменённых ведущим регистров.
+ * @return Флаг наличия изменённых регистров.
+ */
+extern bool i2c_slave_regs_any_dirty(void);
+
+/**
+ * Получает и сбрасывает флаг изменения регистра ведущим.
+ * @param reg Номер регистра.
+ * @return Флаг изменения регистра.
+ */
+extern bool i2c_slave_regs_take_dirty(uint8_t reg);
+
+/**
+ * Сбрасывает флаги изменения всех регистров.
+ */
+extern void i2c_slave_regs_clear_dirty(void);
+
+#endif	/* I2C_SLAVE_REGS_H */
@@ -0,0 +1,218 @@
+/**
+ * Тесты повтора передачи после потери приоритета на ПК:
+ * отсрочка, повторы и отказ после I2C_ARBITRATION_RETRIES.
+ * Отсрочка отсчитывается только i2c_timeout_tick(),
+ * как при вызове из прерывания системного счётчика.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+#include <util/twi.h>
+#include "i2c/i2c.h"
+#include "counter/counter.h"
+#include "bits/bits.h"
+#include "test.h"
+
+
+//! Обработчик прерывания TWI.
+extern void TWI_vect(void);
+
+//! Адрес устройства.
+#define TEST_DEV 0x20
+
+//! Линии SCL и SDA свободной шины.
+#define TEST_BUS_IDLE (BIT(I2C_SCL_PIN) | BIT(I2C_SDA_PIN))
+
+//! Наибольшее число интервалов ожидания старта.
+#define TEST_TICKS_MAX 100
+
+//! Число вызовов каллбэка ведущего.
+static size_t test_callback_count;
+
+//! Статус шины при вызове каллбэка.
+static i2c_status_t test_callback_status;
+
+
+/**
+ * Каллбэк ведущего.
+ * @return Флаг обработки события.
+ */
+static bool test_callback(void)
+{
+    test_callback_count ++;
+    test_callback_status = i2c_status();
+    
+    return true;
+}
+
+/**
+ * Сбрасывает шину.
+ * @param seed Начальное значение генератора отсрочки.
+ */
+static void test_reset(uint16_t seed)
+{
+    TWCR = 0;
+    TWSR = 0;
+    TWDR = 0;
+    PINC = TEST_BUS_IDLE;
+    
+    TEST_CHECK_EQ(i2c_init(100), E_NO_ERROR);
+    i2c_set_callback(test_callback);
+    i2c_set_arbitration_seed(seed);
+    
+    test_callback_count = 0;
+}
+
+/**
+ * Вызывает прерывание TWI с заданным статусом.
+ * @param status Статус TWSR.
+ */
+static void test_step(uint8_t status)
+{
+    TWSR = status;
+    TWI_vect();
+}
+
+/**
+ * Вызывает тик системного счётчика до формирования старта.
+ * @return Число тиков до старта, TEST_TICKS_MAX + 1 если старт не сформирован.
+ */
+static unsigned test_tick_until_start(void)
+{
+    unsigned n;
+    
+    for(n = 0; n <= TEST_TICKS_MAX; n ++){
+        system_counter_tick();
+        i2c_timeout_tick();
+        if(BIT_VALUE(TWCR, TWSTA)) return n;
+    }
+    
+    return n;
+}
+
+/**
+ * Проводит передачу, теряющую приоритет при каждой попытке.
+ * @param seed Начальное значение генератора отсрочки.
+ * @param waits Число интервалов отсрочки перед каждым повтором.
+ */
+static void test_lose_all(uint16_t seed, unsigned* waits)
+{
+    static const uint8_t data[] = {0x5a};
+    unsigned i;
+    
+    test_reset(seed);
+    
+    TEST_CHECK_EQ(i2c_master_write(TEST_DEV, data, sizeof(data)), E_NO_ERROR);
+    TEST_CHECK(BIT_VALUE(TWCR, TWSTA));
+    
+    for(i = 0; i < I2C_ARBITRATION_RETRIES; i ++){
+        test_step(TW_START);
+        test_step(TW_MT_ARB_LOST);
+        
+        // До повтора шина слушается, передача не завершена.
+        TEST_CHECK(!BIT_VALUE(TWCR, TWSTA));
+        TEST_CHECK(i2c_busy());
+        TEST_CHECK_EQ(test_callback_count, 0);
+        
+        // Перед n-м повтором - от 0 до 2^n - 1 интервалов.
+        waits[i] = test_tick_until_start();
+        TEST_CHECK(waits[i] < (1U << (i + 1)));
+    }
+    
+    // Повторы исчерпаны - ошибка сообщается каллбэку.
+    test_step(TW_START);
+    test_step(TW_MT_ARB_LOST);
+    
+    TEST_CHECK_EQ(test_callback_count, 1);
+    TEST_CHECK_EQ(test_callback_status, I2C_STATUS_ARBITRATION_LOST);
+    TEST_CHECK_EQ(i2c_status(), I2C_STATUS_ARBITRATION_LOST);
+    TEST_CHECK(!i2c_busy());
+    
+    // Больше повторов нет.
+    TEST_CHECK_EQ(test_tick_until_start(), TEST_TICKS_MAX + 1);
+}
+
+//! Повторы и отказ, отсчитываемые тиком таймаута.
+static void test_give_up(void)
+{
+    unsigned waits_a[I2C_ARBITRATION_RETRIES];
+    unsigned waits_b[I2C_ARBITRATION_RETRIES];
+    unsigned i;
+    
+    // Таймаут не задан - тик всё равно отсчитывает отсрочку.
+    test_lose_all(0x1234, waits_a);
+    
+    // Одинаковое начальное значение - одинаковые отсрочки.
+    test_lose_all(0x1234, waits_b);
+    for(i = 0; i < I2C_ARBITRATION_RETRIES; i ++){
+        TEST_CHECK_EQ(waits_a[i], waits_b[i]);
+    }
+}
+
+//! Успешный повтор после потери приоритета.
+static void test_retry(void)
+{
+    static const uint8_t data[] = {0xa5};
+    
+    test_reset(0xbeef);
+    
+    TEST_CHECK_EQ(i2c_master_write(TEST_DEV, data, sizeof(data)), E_NO_ERROR);
+    test_step(TW_START);
+    test_step(TW_MT_ARB_LOST);
+    
+    // Занятая шина задерживает повтор.
+    PINC = BIT(I2C_SCL_PIN);
+    TEST_CHECK_EQ(test_tick_until_start(), TEST_TICKS_MAX + 1);
+    
+    PINC = TEST_BUS_IDLE;
+    TEST_CHECK(test_tick_until_start() <= 1);
+    
+    test_step(TW_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV << 1) | TW_WRITE);
+    test_step(TW_MT_SLA_ACK);
+    test_step(TW_MT_DATA_ACK);
+    
+    TEST_CHECK_EQ(test_callback_count, 1);
+    TEST_CHECK_EQ(test_callback_status, I2C_STATUS_DATA_WRITED);
+    TEST_CHECK(!i2c_busy());
+}
+
+//! Таймаут во время отсрочки занятой шиной.
+static void test_timeout_in_backoff(void)
+{
+    static const uint8_t data[] = {0x3c};
+    
+    test_reset(0x4321);
+    i2c_set_timeout(10);
+    
+    TEST_CHECK_EQ(i2c_master_write(TEST_DEV, data, sizeof(data)), E_NO_ERROR);
+    test_step(TW_START);
+    test_step(TW_MT_ARB_LOST);
+    
+    PINC = 0;
+    TEST_CHECK_EQ(test_tick_until_start(), TEST_TICKS_MAX + 1);
+    TEST_CHECK(i2c_bus_recovery_pending());
+    TEST_CHECK_EQ(i2c_status(), I2C_STATUS_TIMEOUT);
+    
+    PINC = TEST_BUS_IDLE;
+    TEST_CHECK_EQ(i2c_bus_recover(), E_NO_ERROR);
+    TEST_CHECK_EQ(test_callback_count, 1);
+    TEST_CHECK_EQ(test_callback_status, I2C_STATUS_TIMEOUT);
+    TEST_CHECK(!i2c_busy());
+    
+    // Отменённый повтор не формируется.
+    TEST_CHECK_EQ(test_tick_until_start(), TEST_TICKS_MAX + 1);
+}
+
+int main(void)
+{
+    system_counter_init(1000);
+    
+    test_give_up();
+    test_retry();
+    test_timeout_in_backoff();
+    
+    return test_result("test_i2c_arbitration");
+}
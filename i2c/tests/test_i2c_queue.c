@@ -0,0 +1,436 @@
+/**
+ * Тесты очереди транзакций i2c на ПК.
+ * Конечный автомат прерывания TWI прогоняется
+ * по последовательности кодов статуса TWSR.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+#include <util/twi.h>
+#include "i2c/i2c.h"
+#include "bits/bits.h"
+#include "test.h"
+
+
+//! Обработчик прерывания TWI.
+extern void TWI_vect(void);
+
+//! Число транзакций теста.
+#define TEST_TRANSFERS 4
+
+//! Адреса устройств.
+#define TEST_DEV_A 0x20
+#define TEST_DEV_B 0x68
+
+//! Транзакции в порядке вызова каллбэков.
+static i2c_transfer_t* test_done[TEST_TRANSFERS];
+static size_t test_done_count;
+
+//! Транзакция, ставящаяся в очередь из каллбэка.
+static i2c_transfer_t* test_chained;
+
+//! Линии SCL и SDA свободной шины.
+#define TEST_BUS_IDLE (BIT(I2C_SCL_PIN) | BIT(I2C_SDA_PIN))
+
+
+/**
+ * Каллбэк транзакции, запоминает порядок окончания.
+ * @param transfer Транзакция.
+ */
+static void test_callback(i2c_transfer_t* transfer)
+{
+    if(test_done_count < TEST_TRANSFERS) test_done[test_done_count] = transfer;
+    test_done_count ++;
+    
+    if(test_chained != NULL){
+        TEST_CHECK_EQ(i2c_submit(test_chained), E_NO_ERROR);
+        test_chained = NULL;
+    }
+}
+
+/**
+ * Сбрасывает шину и запомненные транзакции.
+ */
+static void test_reset(void)
+{
+    TWCR = 0;
+    TWSR = 0;
+    TWDR = 0;
+    PINC = TEST_BUS_IDLE;
+    
+    TEST_CHECK_EQ(i2c_init(100), E_NO_ERROR);
+    
+    test_done_count = 0;
+    test_chained = NULL;
+}
+
+/**
+ * Вызывает прерывание TWI с заданным статусом.
+ * @param status Статус TWSR.
+ */
+static void test_step(uint8_t status)
+{
+    TWSR = status;
+    TWI_vect();
+}
+
+/**
+ * Вызывает прерывание TWI с заданным статусом и принятым байтом.
+ * @param status Статус TWSR.
+ * @param data Принятый байт.
+ */
+static void test_step_rx(uint8_t status, uint8_t data)
+{
+    TWDR = data;
+    test_step(status);
+}
+
+/**
+ * Проверяет, что TWI сформирует старт.
+ */
+static void test_expect_start(void)
+{
+    TEST_CHECK(BIT_VALUE(TWCR, TWSTA));
+    TEST_CHECK(!BIT_VALUE(TWCR, TWSTO));
+    TEST_CHECK(BIT_VALUE(TWCR, TWINT));
+}
+
+/**
+ * Вызывает отсчёт отсрочки повтора до формирования старта.
+ * @param max Максимальное число вызовов.
+ * @return Число вызовов до старта, max + 1 если старт не сформирован.
+ */
+static unsigned test_tick_until_start(unsigned max)
+{
+    unsigned n;
+    
+    for(n = 0; n <= max; n ++){
+        i2c_arbitration_tick();
+        if(BIT_VALUE(TWCR, TWSTA)) return n;
+    }
+    
+    return n;
+}
+
+/**
+ * Проверяет, что TWI сформирует стоп.
+ */
+static void test_expect_stop(void)
+{
+    TEST_CHECK(BIT_VALUE(TWCR, TWSTO));
+    TEST_CHECK(!BIT_VALUE(TWCR, TWSTA));
+}
+
+//! Проверка аргументов.
+static void test_submit_errors(void)
+{
+    uint8_t data[2];
+    i2c_transfer_t t;
+    
+    test_reset();
+    
+    TEST_CHECK_EQ(i2c_submit(NULL), E_NULL_POINTER);
+    
+    i2c_transfer_init(&t, TEST_DEV_A, I2C_WRITE, NULL, 0, NULL, 0, test_callback, NULL);
+    TEST_CHECK_EQ(i2c_submit(&t), E_NULL_POINTER);
+    
+    i2c_transfer_init(&t, TEST_DEV_A, I2C_WRITE, NULL, 0, data, 0, test_callback, NULL);
+    TEST_CHECK_EQ(i2c_submit(&t), E_INVALID_VALUE);
+    
+    i2c_transfer_init(&t, TEST_DEV_A, I2C_WRITE, data, 0, data, sizeof(data), test_callback, NULL);
+    TEST_CHECK_EQ(i2c_submit(&t), E_INVALID_VALUE);
+    
+    TEST_CHECK(i2c_queue_empty());
+    TEST_CHECK(!i2c_busy());
+}
+
+//! Запись и чтение подряд с повторным стартом.
+static void test_write_read(void)
+{
+    uint8_t reg_a = 0x10, reg_b = 0x3b;
+    uint8_t wr[2] = {0x01, 0x02};
+    uint8_t rd[2] = {0, 0};
+    i2c_transfer_t a, b;
+    
+    test_reset();
+    
+    i2c_transfer_init(&a, TEST_DEV_A, I2C_WRITE, &reg_a, 1, wr, sizeof(wr), test_callback, NULL);
+    i2c_transfer_init(&b, TEST_DEV_B, I2C_READ, &reg_b, 1, rd, sizeof(rd), test_callback, NULL);
+    
+    // Свободная шина - старт немедленно.
+    TEST_CHECK_EQ(i2c_submit(&a), E_NO_ERROR);
+    test_expect_start();
+    TEST_CHECK(i2c_busy());
+    
+    // Занятая шина - только в очередь, TWCR не изменяется.
+    TWCR = BIT(TWINT) | BIT(TWEN) | BIT(TWIE);
+    TEST_CHECK_EQ(i2c_submit(&b), E_NO_ERROR);
+    TEST_CHECK_EQ(TWCR, BIT(TWINT) | BIT(TWEN) | BIT(TWIE));
+    TEST_CHECK_EQ(i2c_submit(&b), E_BUSY);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_QUEUED);
+    TEST_CHECK_EQ(b.status, I2C_STATUS_QUEUED);
+    
+    // Транзакция A: SLA+W, регистр, два байта данных.
+    test_step(TW_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_A << 1) | TW_WRITE);
+    test_step(TW_MT_SLA_ACK);
+    TEST_CHECK_EQ(TWDR, reg_a);
+    test_step(TW_MT_DATA_ACK);
+    TEST_CHECK_EQ(TWDR, wr[0]);
+    test_step(TW_MT_DATA_ACK);
+    TEST_CHECK_EQ(TWDR, wr[1]);
+    TEST_CHECK_EQ(test_done_count, 0);
+    
+    // Конец A - повторный старт для B без стопа.
+    test_step(TW_MT_DATA_ACK);
+    TEST_CHECK_EQ(test_done_count, 1);
+    TEST_CHECK(test_done[0] == &a);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_DATA_WRITED);
+    TEST_CHECK_EQ(i2c_transfer_bytes_transmitted(&a), 3);
+    TEST_CHECK(i2c_transfer_done(&a));
+    TEST_CHECK(!i2c_transfer_done(&b));
+    test_expect_start();
+    
+    // Транзакция B: SLA+W, регистр, повторный старт, SLA+R, два байта.
+    test_step(TW_REP_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_B << 1) | TW_WRITE);
+    test_step(TW_MT_SLA_ACK);
+    TEST_CHECK_EQ(TWDR, reg_b);
+    test_step(TW_MT_DATA_ACK);
+    test_expect_start();
+    test_step(TW_REP_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_B << 1) | TW_READ);
+    test_step(TW_MR_SLA_ACK);
+    // Первый байт подтверждается.
+    TEST_CHECK(BIT_VALUE(TWCR, TWEA));
+    test_step_rx(TW_MR_DATA_ACK, 0xaa);
+    // Последний - нет.
+    TEST_CHECK(!BIT_VALUE(TWCR, TWEA));
+    test_step_rx(TW_MR_DATA_NACK, 0xbb);
+    
+    TEST_CHECK_EQ(test_done_count, 2);
+    TEST_CHECK(test_done[1] == &b);
+    TEST_CHECK_EQ(b.status, I2C_STATUS_DATA_READED);
+    TEST_CHECK_EQ(rd[0], 0xaa);
+    TEST_CHECK_EQ(rd[1], 0xbb);
+    
+    // Очередь пуста - стоп.
+    test_expect_stop();
+    TEST_CHECK(i2c_queue_empty());
+    TEST_CHECK(!i2c_busy());
+}
+
+//! Неотвечающее устройство не останавливает очередь.
+static void test_not_responding(void)
+{
+    uint8_t wr_a[1] = {0x55}, wr_b[1] = {0x66};
+    i2c_transfer_t a, b;
+    
+    test_reset();
+    
+    i2c_transfer_init(&a, TEST_DEV_A, I2C_WRITE, NULL, 0, wr_a, sizeof(wr_a), test_callback, NULL);
+    i2c_transfer_init(&b, TEST_DEV_B, I2C_WRITE, NULL, 0, wr_b, sizeof(wr_b), test_callback, NULL);
+    
+    TEST_CHECK_EQ(i2c_submit(&a), E_NO_ERROR);
+    TEST_CHECK_EQ(i2c_submit(&b), E_NO_ERROR);
+    
+    test_step(TW_START);
+    test_step(TW_MT_SLA_NACK);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_NOT_RESPONDING);
+    test_expect_start();
+    
+    test_step(TW_REP_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_B << 1) | TW_WRITE);
+    test_step(TW_MT_SLA_ACK);
+    TEST_CHECK_EQ(TWDR, wr_b[0]);
+    // Устройство отвергло последний байт - данные переданы.
+    test_step(TW_MT_DATA_NACK);
+    TEST_CHECK_EQ(b.status, I2C_STATUS_DATA_WRITED);
+    
+    TEST_CHECK_EQ(test_done_count, 2);
+    TEST_CHECK(test_done[0] == &a);
+    TEST_CHECK(test_done[1] == &b);
+    test_expect_stop();
+    TEST_CHECK(!i2c_busy());
+}
+
+//! Постановка в очередь из каллбэка.
+static void test_chain(void)
+{
+    uint8_t wr[1] = {0x77};
+    uint8_t rd[1] = {0};
+    i2c_transfer_t a, b;
+    
+    test_reset();
+    
+    i2c_transfer_init(&a, TEST_DEV_A, I2C_WRITE, NULL, 0, wr, sizeof(wr), test_callback, NULL);
+    i2c_transfer_init(&b, TEST_DEV_B, I2C_READ, NULL, 0, rd, sizeof(rd), test_callback, NULL);
+    
+    test_chained = &b;
+    TEST_CHECK_EQ(i2c_submit(&a), E_NO_ERROR);
+    
+    test_step(TW_START);
+    test_step(TW_MT_SLA_ACK);
+    test_step(TW_MT_DATA_ACK);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_DATA_WRITED);
+    
+    // B поставлена каллбэком A - повторный старт.
+    TEST_CHECK(!i2c_queue_empty());
+    test_expect_start();
+    
+    test_step(TW_REP_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_B << 1) | TW_READ);
+    test_step(TW_MR_SLA_ACK);
+    TEST_CHECK(!BIT_VALUE(TWCR, TWEA));
+    test_step_rx(TW_MR_DATA_NACK, 0x5a);
+    
+    TEST_CHECK_EQ(test_done_count, 2);
+    TEST_CHECK(test_done[1] == &b);
+    TEST_CHECK_EQ(b.status, I2C_STATUS_DATA_READED);
+    TEST_CHECK_EQ(rd[0], 0x5a);
+    test_expect_stop();
+    TEST_CHECK(i2c_queue_empty());
+}
+
+//! Ошибка шины завершает транзакцию и продолжает очередь.
+static void test_bus_error(void)
+{
+    uint8_t wr_a[1] = {0x11}, wr_b[1] = {0x22};
+    i2c_transfer_t a, b;
+    
+    test_reset();
+    
+    i2c_transfer_init(&a, TEST_DEV_A, I2C_WRITE, NULL, 0, wr_a, sizeof(wr_a), test_callback, NULL);
+    i2c_transfer_init(&b, TEST_DEV_B, I2C_WRITE, NULL, 0, wr_b, sizeof(wr_b), test_callback, NULL);
+    
+    TEST_CHECK_EQ(i2c_submit(&a), E_NO_ERROR);
+    TEST_CHECK_EQ(i2c_submit(&b), E_NO_ERROR);
+    
+    test_step(TW_START);
+    test_step(TW_BUS_ERROR);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_BUS_ERROR);
+    test_expect_start();
+    
+    test_step(TW_START);
+    test_step(TW_MT_SLA_ACK);
+    test_step(TW_MT_DATA_ACK);
+    TEST_CHECK_EQ(b.status, I2C_STATUS_DATA_WRITED);
+    
+    TEST_CHECK_EQ(test_done_count, 2);
+    test_expect_stop();
+    TEST_CHECK(!i2c_busy());
+}
+
+//! Повтор после потери приоритета с отсрочкой при свободной шине.
+static void test_arbitration_retry(void)
+{
+    uint8_t wr[1] = {0x33};
+    uint8_t data;
+    i2c_transfer_t a;
+    
+    test_reset();
+    i2c_set_arbitration_seed(0x1234);
+    
+    i2c_transfer_init(&a, TEST_DEV_A, I2C_WRITE, NULL, 0, wr, sizeof(wr), test_callback, NULL);
+    TEST_CHECK_EQ(i2c_submit(&a), E_NO_ERROR);
+    
+    test_step(TW_START);
+    test_step(TW_MT_ARB_LOST);
+    
+    // Прерывание не ждёт и не формирует старт - слушает шину.
+    TEST_CHECK(!BIT_VALUE(TWCR, TWSTA));
+    TEST_CHECK(BIT_VALUE(TWCR, TWINT));
+    TEST_CHECK(i2c_busy());
+    TEST_CHECK_EQ(test_done_count, 0);
+    
+    // Пока шина занята, отсрочка не истекает.
+    PINC = BIT(I2C_SDA_PIN);
+    TEST_CHECK_EQ(test_tick_until_start(100), 101);
+    
+    // Обращение к нам как к ведомому во время отсрочки.
+    PINC = TEST_BUS_IDLE;
+    TWDR = (TEST_DEV_B << 1) | TW_WRITE;
+    test_step(TW_SR_SLA_ACK);
+    TEST_CHECK(!BIT_VALUE(TWCR, TWSTA));
+    TEST_CHECK_EQ(test_tick_until_start(100), 101);
+    data = 0x44;
+    test_step_rx(TW_SR_DATA_NACK, data);
+    TEST_CHECK(!BIT_VALUE(TWCR, TWSTA));
+    TEST_CHECK(i2c_busy());
+    TEST_CHECK_EQ(test_done_count, 0);
+    
+    // Свободная шина - старт после не более 2^1 - 1 интервалов.
+    TEST_CHECK(test_tick_until_start(100) <= 1);
+    test_expect_start();
+    
+    // Повтор не назначается дважды.
+    TWCR = 0;
+    TEST_CHECK_EQ(test_tick_until_start(100), 101);
+    
+    test_step(TW_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_A << 1) | TW_WRITE);
+    test_step(TW_MT_SLA_ACK);
+    test_step(TW_MT_DATA_ACK);
+    
+    TEST_CHECK_EQ(test_done_count, 1);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_DATA_WRITED);
+    test_expect_stop();
+    TEST_CHECK(!i2c_busy());
+}
+
+//! Исчерпание повторов после потери приоритета.
+static void test_arbitration_lost(void)
+{
+    uint8_t wr_a[1] = {0x55}, wr_b[1] = {0x66};
+    i2c_transfer_t a, b;
+    unsigned i;
+    
+    test_reset();
+    
+    i2c_transfer_init(&a, TEST_DEV_A, I2C_WRITE, NULL, 0, wr_a, sizeof(wr_a), test_callback, NULL);
+    i2c_transfer_init(&b, TEST_DEV_B, I2C_WRITE, NULL, 0, wr_b, sizeof(wr_b), test_callback, NULL);
+    
+    TEST_CHECK_EQ(i2c_submit(&a), E_NO_ERROR);
+    TEST_CHECK_EQ(i2c_submit(&b), E_NO_ERROR);
+    
+    test_step(TW_START);
+    
+    for(i = 1; i <= I2C_ARBITRATION_RETRIES; i ++){
+        test_step(TW_MT_ARB_LOST);
+        TEST_CHECK(!BIT_VALUE(TWCR, TWSTA));
+        // Не более 2^n - 1 интервалов перед n-м повтором.
+        TEST_CHECK(test_tick_until_start(100) < (1U << i));
+        test_step(TW_START);
+    }
+    
+    TEST_CHECK_EQ(test_done_count, 0);
+    
+    // Повторы исчерпаны - ошибка и следующая транзакция.
+    test_step(TW_MT_ARB_LOST);
+    TEST_CHECK_EQ(test_done_count, 1);
+    TEST_CHECK_EQ(a.status, I2C_STATUS_ARBITRATION_LOST);
+    test_expect_start();
+    
+    test_step(TW_START);
+    TEST_CHECK_EQ(TWDR, (TEST_DEV_B << 1) | TW_WRITE);
+    test_step(TW_MT_SLA_ACK);
+    test_step(TW_MT_DATA_ACK);
+    TEST_CHECK_EQ(b.status, I2C_STATUS_DATA_WRITED);
+    TEST_CHECK_EQ(test_done_count, 2);
+    test_expect_stop();
+}
+
+int main(void)
+{
+    test_submit_errors();
+    test_write_read();
+    test_not_responding();
+    test_chain();
+    test_bus_error();
+    test_arbitration_retry();
+    test_arbitration_lost();
+    
+    return test_result("test_i2c_queue");
+}
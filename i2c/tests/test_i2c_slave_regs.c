@@ -0,0 +1,202 @@
+/**
+ * Тесты эмуляции файла регистров ведомого i2c на ПК.
+ * Обращения ведущего имитируются вызовами каллбэка ведомого
+ * в порядке, в котором его вызывает прерывание TWI.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "i2c/i2c_slave_regs.h"
+#include "test.h"
+
+
+//! Число регистров.
+#define TEST_REGS_COUNT 8
+
+static uint8_t test_regs[TEST_REGS_COUNT];
+
+//! Маски записываемых бит: регистр 1 только для чтения, у регистра 2 записываем младший полубайт.
+static const uint8_t test_wmask[TEST_REGS_COUNT] = {0xff, 0x00, 0x0f, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+//! Регистры во флеш-памяти.
+static const uint8_t test_regs_P[4] = {0xa1, 0xb2, 0xc3, 0xd4};
+
+
+/**
+ * Имитирует запись ведущим номера регистра и данных.
+ * @param reg Номер регистра.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Число подтверждённых (ACK) байт данных.
+ */
+static size_t test_master_write(uint8_t reg, const uint8_t* data, size_t size)
+{
+    size_t i;
+    uint8_t byte;
+    
+    // SLA+W.
+    if(!i2c_slave_regs_callback(I2C_READ, NULL)) return 0;
+    
+    byte = reg;
+    if(!i2c_slave_regs_callback(I2C_READ, &byte)) return 0;
+    
+    for(i = 0; i < size; i ++){
+        byte = data[i];
+        if(!i2c_slave_regs_callback(I2C_READ, &byte)) return i;
+    }
+    
+    return size;
+}
+
+/**
+ * Начинает чтение ведущим (SLA+R).
+ */
+static void test_master_read_begin(void)
+{
+    TEST_CHECK(i2c_slave_regs_callback(I2C_WRITE, NULL));
+}
+
+/**
+ * Имитирует чтение ведущим очередного байта.
+ * @param more Флаг ожидания ведомым следующего байта.
+ * @return Байт.
+ */
+static uint8_t test_master_read_byte(bool* more)
+{
+    uint8_t byte = I2C_DATA_DEFAULT_VALUE;
+    
+    *more = i2c_slave_regs_callback(I2C_WRITE, &byte);
+    
+    return byte;
+}
+
+//! Запись регистров ведущим, маски и флаги изменения.
+static void test_write(void)
+{
+    static const uint8_t data[] = {0x11, 0x22, 0x33, 0x44};
+    static const uint8_t tail[] = {0x55, 0x66, 0x77};
+    
+    memset(test_regs, 0, sizeof(test_regs));
+    
+    TEST_CHECK_EQ(i2c_slave_regs_init(NULL, NULL, TEST_REGS_COUNT), E_NULL_POINTER);
+    TEST_CHECK_EQ(i2c_slave_regs_init(test_regs, test_wmask, 0), E_OUT_OF_RANGE);
+    TEST_CHECK_EQ(i2c_slave_regs_init(test_regs, test_wmask, I2C_SLAVE_REGS_MAX + 1), E_OUT_OF_RANGE);
+    TEST_CHECK_EQ(i2c_slave_regs_init(test_regs, test_wmask, TEST_REGS_COUNT), E_NO_ERROR);
+    
+    TEST_CHECK(!i2c_slave_regs_any_dirty());
+    
+    TEST_CHECK_EQ(test_master_write(0, data, sizeof(data)), sizeof(data));
+    TEST_CHECK_EQ(test_regs[0], 0x11);
+    TEST_CHECK_EQ(test_regs[1], 0x00);
+    TEST_CHECK_EQ(test_regs[2], 0x03);
+    TEST_CHECK_EQ(test_regs[3], 0x44);
+    
+    TEST_CHECK(i2c_slave_regs_any_dirty());
+    TEST_CHECK(i2c_slave_regs_take_dirty(0));
+    TEST_CHECK(!i2c_slave_regs_take_dirty(0));
+    TEST_CHECK(!i2c_slave_regs_take_dirty(1));
+    TEST_CHECK(i2c_slave_regs_take_dirty(2));
+    TEST_CHECK(i2c_slave_regs_take_dirty(3));
+    TEST_CHECK(!i2c_slave_regs_any_dirty());
+    
+    // Байты за последним регистром не подтверждаются.
+    TEST_CHECK_EQ(test_master_write(TEST_REGS_COUNT - 2, tail, sizeof(tail)), 1);
+    TEST_CHECK_EQ(test_regs[TEST_REGS_COUNT - 2], 0x55);
+    TEST_CHECK_EQ(test_regs[TEST_REGS_COUNT - 1], 0x66);
+    
+    i2c_slave_regs_clear_dirty();
+    TEST_CHECK(!i2c_slave_regs_any_dirty());
+}
+
+//! Чтение ведущим из снимка регистров.
+static void test_read_latched(void)
+{
+    static const uint8_t v_old[4] = {0x01, 0x02, 0x03, 0x04};
+    static const uint8_t v_new[4] = {0xf1, 0xf2, 0xf3, 0xf4};
+    uint8_t got[4];
+    uint8_t check[4];
+    bool more = false;
+    size_t i;
+    
+    memset(test_regs, 0, sizeof(test_regs));
+    TEST_CHECK_EQ(i2c_slave_regs_init(test_regs, NULL, TEST_REGS_COUNT), E_NO_ERROR);
+    
+    TEST_CHECK_EQ(i2c_slave_regs_write(2, v_old, sizeof(v_old)), E_NO_ERROR);
+    TEST_CHECK_EQ(i2c_slave_regs_write(6, v_old, sizeof(v_old)), E_OUT_OF_RANGE);
+    TEST_CHECK_EQ(i2c_slave_regs_write(0, NULL, 1), E_NULL_POINTER);
+    TEST_CHECK(!i2c_slave_regs_any_dirty());
+    
+    // Номер регистра без данных, затем SLA+R.
+    TEST_CHECK_EQ(test_master_write(2, NULL, 0), 0);
+    test_master_read_begin();
+    
+    got[0] = test_master_read_byte(&more);
+    TEST_CHECK(more);
+    
+    // Основной цикл обновляет значение посреди чтения.
+    TEST_CHECK_EQ(i2c_slave_regs_write(2, v_new, sizeof(v_new)), E_NO_ERROR);
+    
+    for(i = 1; i < sizeof(got); i ++){
+        got[i] = test_master_read_byte(&more);
+    }
+    
+    // Прочитано целиком старое значение.
+    TEST_CHECK(memcmp(got, v_old, sizeof(v_old)) == 0);
+    
+    // Обновлённые регистры в ОЗУ.
+    TEST_CHECK_EQ(i2c_slave_regs_read(2, check, sizeof(check)), E_NO_ERROR);
+    TEST_CHECK(memcmp(check, v_new, sizeof(v_new)) == 0);
+    
+    // Следующее чтение - целиком новое значение.
+    TEST_CHECK_EQ(test_master_write(2, NULL, 0), 0);
+    test_master_read_begin();
+    for(i = 0; i < sizeof(got); i ++){
+        got[i] = test_master_read_byte(&more);
+    }
+    TEST_CHECK(memcmp(got, v_new, sizeof(v_new)) == 0);
+    
+    // После последнего регистра ведомый отвечает NACK.
+    TEST_CHECK(more);
+    test_master_read_byte(&more);
+    TEST_CHECK(more);
+    test_master_read_byte(&more);
+    TEST_CHECK(!more);
+    TEST_CHECK_EQ(test_master_read_byte(&more), I2C_DATA_DEFAULT_VALUE);
+    TEST_CHECK(!more);
+}
+
+//! Регистры во флеш-памяти.
+static void test_progmem(void)
+{
+    static const uint8_t data[] = {0x00};
+    uint8_t got[2];
+    bool more = false;
+    
+    TEST_CHECK_EQ(i2c_slave_regs_init_P(test_regs_P, sizeof(test_regs_P)), E_NO_ERROR);
+    
+    // Запись ведущим игнорируется.
+    TEST_CHECK_EQ(test_master_write(1, data, sizeof(data)), sizeof(data));
+    TEST_CHECK(!i2c_slave_regs_any_dirty());
+    TEST_CHECK_EQ(i2c_slave_regs_write(0, data, sizeof(data)), E_INVALID_VALUE);
+    
+    TEST_CHECK_EQ(test_master_write(1, NULL, 0), 0);
+    test_master_read_begin();
+    got[0] = test_master_read_byte(&more);
+    got[1] = test_master_read_byte(&more);
+    TEST_CHECK_EQ(got[0], 0xb2);
+    TEST_CHECK_EQ(got[1], 0xc3);
+    
+    TEST_CHECK_EQ(i2c_slave_regs_read(3, got, 1), E_NO_ERROR);
+    TEST_CHECK_EQ(got[0], 0xd4);
+}
+
+int main(void)
+{
+    test_write();
+    test_read_latched();
+    test_progmem();
+    
+    return test_result("test_i2c_slave_regs");
+}
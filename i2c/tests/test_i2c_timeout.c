@@ -0,0 +1,184 @@
+/**
+ * Тесты таймаутов передач и восстановления шины i2c на ПК.
+ * Системный счётчик продвигается вручную, ответы
+ * устройств не формируются - передачи зависают.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <avr/io.h>
+#include "i2c/i2c.h"
+#include "counter/counter.h"
+#include "bits/bits.h"
+#include "test.h"
+
+
+//! Частота системного счётчика.
+#define TEST_TICKS_PER_SEC 1000
+
+//! Таймаут передачи в тиках.
+#define TEST_TIMEOUT 5
+
+//! Адрес устройства.
+#define TEST_DEV 0x20
+
+//! Линии SCL и SDA.
+#define TEST_SCL BIT(I2C_SCL_PIN)
+#define TEST_SDA BIT(I2C_SDA_PIN)
+#define TEST_BUS_IDLE (TEST_SCL | TEST_SDA)
+
+//! Число завершённых транзакций.
+static size_t test_done_count;
+
+
+/**
+ * Каллбэк транзакции.
+ * @param transfer Транзакция.
+ */
+static void test_callback(i2c_transfer_t* transfer)
+{
+    (void)transfer;
+    
+    test_done_count ++;
+}
+
+/**
+ * Сбрасывает шину и счётчики.
+ */
+static void test_reset(void)
+{
+    TWCR = 0;
+    TWSR = 0;
+    PINC = TEST_BUS_IDLE;
+    // Внутренние подтяжки линий.
+    PORTC = TEST_BUS_IDLE;
+    DDRC = 0;
+    
+    TEST_CHECK_EQ(i2c_init(100), E_NO_ERROR);
+    i2c_set_timeout(TEST_TIMEOUT);
+    TEST_CHECK_EQ(i2c_timeout(), TEST_TIMEOUT);
+    
+    test_done_count = 0;
+}
+
+/**
+ * Продвигает системный счётчик.
+ * @param ticks Число тиков.
+ */
+static void test_advance(unsigned ticks)
+{
+    while(ticks --) system_counter_tick();
+}
+
+//! Таймаут, восстановление шины и следующая транзакция очереди.
+static void test_timeout_recover(void)
+{
+    uint8_t data = 0x55;
+    i2c_transfer_t t1, t2;
+    unsigned i;
+    
+    test_reset();
+    
+    i2c_transfer_init(&t1, TEST_DEV, I2C_WRITE, NULL, 0, &data, 1, test_callback, NULL);
+    i2c_transfer_init(&t2, TEST_DEV, I2C_WRITE, NULL, 0, &data, 1, test_callback, NULL);
+    
+    TEST_CHECK_EQ(i2c_submit(&t1), E_NO_ERROR);
+    TEST_CHECK(BIT_VALUE(TWCR, TWSTA));
+    
+    // До истечения таймаута передача продолжается.
+    for(i = 0; i < TEST_TIMEOUT - 1; i ++){
+        system_counter_tick();
+        TEST_CHECK_EQ(i2c_timeout_tick(), E_NO_ERROR);
+    }
+    TEST_CHECK(BIT_VALUE(TWCR, TWSTA));
+    
+    // Таймаут: TWI отключен, шина ждёт восстановления.
+    system_counter_tick();
+    TEST_CHECK_EQ(i2c_timeout_tick(), E_I2C_TIMEOUT);
+    TEST_CHECK_EQ(TWCR, 0);
+    TEST_CHECK_EQ(i2c_status(), I2C_STATUS_TIMEOUT);
+    TEST_CHECK(i2c_bus_recovery_pending());
+    TEST_CHECK(i2c_busy());
+    TEST_CHECK_EQ(i2c_timeouts(), 1);
+    TEST_CHECK_EQ(i2c_recoveries(), 0);
+    
+    // Линии не тронуты до восстановления.
+    TEST_CHECK_EQ(PORTC, TEST_BUS_IDLE);
+    
+    // Транзакция не завершена, следующая не начинается.
+    TEST_CHECK_EQ(test_done_count, 0);
+    TEST_CHECK_EQ(i2c_submit(&t2), E_NO_ERROR);
+    TEST_CHECK_EQ(TWCR, 0);
+    
+    // Повторный таймаут не засчитывается.
+    test_advance(TEST_TIMEOUT);
+    TEST_CHECK_EQ(i2c_timeout_tick(), E_NO_ERROR);
+    TEST_CHECK_EQ(i2c_timeouts(), 1);
+    
+    // Восстановление завершает транзакцию и начинает следующую.
+    TEST_CHECK_EQ(i2c_bus_recover(), E_NO_ERROR);
+    TEST_CHECK(!i2c_bus_recovery_pending());
+    TEST_CHECK_EQ(i2c_recoveries(), 1);
+    TEST_CHECK_EQ(test_done_count, 1);
+    TEST_CHECK_EQ(t1.status, I2C_STATUS_TIMEOUT);
+    TEST_CHECK_EQ(t2.status, I2C_STATUS_QUEUED);
+    TEST_CHECK(BIT_VALUE(TWCR, TWSTA));
+    TEST_CHECK(BIT_VALUE(TWCR, TWEN));
+    
+    // Подтяжки восстановлены, линии отпущены.
+    TEST_CHECK_EQ(PORTC & TEST_BUS_IDLE, TEST_BUS_IDLE);
+    TEST_CHECK_EQ(DDRC & TEST_BUS_IDLE, 0);
+    
+    // Занятая передачей шина не восстанавливается.
+    TEST_CHECK_EQ(i2c_bus_recover(), E_BUSY);
+    
+    // Ожидание сам восстанавливает шину после таймаута.
+    test_advance(TEST_TIMEOUT);
+    i2c_wait();
+    TEST_CHECK(!i2c_busy());
+    TEST_CHECK(!i2c_bus_recovery_pending());
+    TEST_CHECK_EQ(test_done_count, 2);
+    TEST_CHECK_EQ(t2.status, I2C_STATUS_TIMEOUT);
+    TEST_CHECK_EQ(i2c_timeouts(), 2);
+    TEST_CHECK_EQ(i2c_recoveries(), 2);
+    
+    i2c_reset_recovery_counters();
+    TEST_CHECK_EQ(i2c_timeouts(), 0);
+    TEST_CHECK_EQ(i2c_recoveries(), 0);
+}
+
+//! Восстановление шины вручную.
+static void test_recover(void)
+{
+    test_reset();
+    
+    // Без подтяжек - они и не появляются.
+    PORTC = 0;
+    TEST_CHECK_EQ(i2c_bus_recover(), E_NO_ERROR);
+    TEST_CHECK_EQ(PORTC & TEST_BUS_IDLE, 0);
+    TEST_CHECK_EQ(DDRC & TEST_BUS_IDLE, 0);
+    
+    // Ведомый держит SDA.
+    PORTC = TEST_SDA;
+    PINC = TEST_SCL;
+    TEST_CHECK_EQ(i2c_bus_recover(), E_I2C_BUS_STUCK);
+    TEST_CHECK_EQ(PORTC & TEST_BUS_IDLE, TEST_SDA);
+    TEST_CHECK_EQ(DDRC & TEST_BUS_IDLE, 0);
+    TEST_CHECK_EQ(i2c_recoveries(), 2);
+    TEST_CHECK(!i2c_busy());
+    
+    // Без таймаута передачи не прерываются.
+    i2c_set_timeout(0);
+    TEST_CHECK_EQ(i2c_timeout_tick(), E_NO_ERROR);
+}
+
+int main(void)
+{
+    system_counter_init(TEST_TICKS_PER_SEC);
+    
+    test_timeout_recover();
+    test_recover();
+    
+    return test_result("test_i2c_timeout");
+}
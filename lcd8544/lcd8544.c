@@ -125,13 +125,48 @@ static err_t lcd8544_send(lcd8544_t* lcd, bool is_data, const uint8_t* data, siz
 
 bool lcd8544_spi_callback(lcd8544_t* lcd)
 {
-    if(spi_transfer_id() != lcd->transfer_id) return false;
-    
     lcd8544_end(lcd, spi_state() != SPI_STATE_DATA_WRITED ? E_IO_ERROR : E_NO_ERROR);
     
     return true;
 }
 
+#if SPI_CALLBACKS_COUNT > 0
+//! LCD по идентификаторам передачи SPI.
+static lcd8544_t* lcd8544_lcds[SPI_CALLBACKS_COUNT];
+
+/**
+ * Каллбэк SPI, регистрируемый в таблице каллбэков.
+ * Передаёт событие LCD с идентификатором текущей передачи.
+ * @return true, если событие обработано, иначе false.
+ */
+static bool lcd8544_spi_table_callback(void)
+{
+    lcd8544_t* lcd = lcd8544_lcds[spi_transfer_id()];
+    
+    if(lcd == NULL) return false;
+    
+    return lcd8544_spi_callback(lcd);
+}
+#endif
+
+/**
+ * Регистрирует каллбэк LCD в таблице каллбэков SPI.
+ * @param lcd LCD.
+ * @return Код ошибки.
+ */
+static err_t lcd8544_register(lcd8544_t* lcd)
+{
+#if SPI_CALLBACKS_COUNT > 0
+    if(lcd->transfer_id >= SPI_CALLBACKS_COUNT) return E_OUT_OF_RANGE;
+    
+    lcd8544_lcds[lcd->transfer_id] = lcd;
+    
+    return spi_register_master_callback(lcd->transfer_id, lcd8544_spi_table_callback);
+#else
+    return E_OUT_OF_RANGE;
+#endif
+}
+
 err_t lcd8544_init(lcd8544_t* lcd, uint8_t ce_port, uint8_t ce_pin,
                    uint8_t dc_port, uint8_t dc_pin,
                    uint8_t rst_port, uint8_t rst_pin, spi_transfer_id_t transfer_id)
@@ -162,7 +197,7 @@ err_t lcd8544_init(lcd8544_t* lcd, uint8_t ce_port, uint8_t ce_pin,
     // Идентификатор передачи.
     lcd->transfer_id = transfer_id;
     
-    return E_NO_ERROR;
+    return lcd8544_register(lcd);
 }
 
 bool lcd8544_busy(lcd8544_t* lcd)
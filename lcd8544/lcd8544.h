@@ -32,8 +32,8 @@ typedef struct _Lcd8544{
     uint8_t data_cmd;
 }lcd8544_t;
 
-//! Идентификатор передачи по-умолчанию.
-#define LCD8544_DEFAULT_TRANSFER_ID 85
+//! Идентификатор передачи по-умолчанию, меньше SPI_CALLBACKS_COUNT.
+#define LCD8544_DEFAULT_TRANSFER_ID 1
 
 //! Размер дисплея.
 #define LCD8544_WIDTH   84
@@ -106,6 +106,10 @@ typedef uint8_t lcd8544_bias_system_t;
 
 /**
  * Каллбэк SPI.
+ * Вызывается каллбэком, который lcd8544_init() регистрирует
+ * в таблице каллбэков SPI для идентификатора передачи LCD,
+ * только для передач этого LCD.
+ * @param lcd LCD.
  * @return true, если событие обработано, иначе false.
  */
 extern bool lcd8544_spi_callback(lcd8544_t* lcd);
@@ -119,7 +123,7 @@ extern bool lcd8544_spi_callback(lcd8544_t* lcd);
  * @param dc_pin Пин выбора команды/данных.
  * @param rst_port Порт пина reset LCD.
  * @param rst_pin Пин reset LCD.
- * @param transfer_id Идентификатор передачи SPI.
+ * @param transfer_id Идентификатор передачи SPI, меньше SPI_CALLBACKS_COUNT.
  * @return Код ошибки.
  */
 extern err_t lcd8544_init(lcd8544_t* lcd, uint8_t ce_port, uint8_t ce_pin,
@@ -275,6 +275,17 @@ ALWAYS_INLINE static void pin_set_value(pin_t* pin, uint8_t value)
     BIT_SET_MASK(*pin->port.out, pin->_port_mask, value);
 }
 
+/**
+ * Получает значение, выводимое на пин порта
+ * (для пина в режиме ввода - флаг подтяжки).
+ * @param pin Пин порта.
+ * @return Значение бита пина в регистре вывода.
+ */
+ALWAYS_INLINE static uint8_t pin_get_out_value(pin_t* pin)
+{
+    return BIT_TEST_VALUE_MASK(*pin->port.out, pin->_port_mask);
+}
+
 /**
  * Получение значения на пине порта.
  * @param pin Пин порта.
@@ -0,0 +1,207 @@
+#include "slip.h"
+#include <util/crc16.h>
+#include "uart/uart.h"
+#include "defs/defs.h"
+
+
+/**
+ * Получает флаг необходимости экранирования байта.
+ * @param data Байт.
+ * @return Флаг необходимости экранирования.
+ */
+ALWAYS_INLINE static bool slip_is_special(uint8_t data)
+{
+    return data == SLIP_END || data == SLIP_ESC;
+}
+
+/**
+ * Передаёт байт с экранированием.
+ * @param uart UART.
+ * @param data Байт.
+ */
+static void slip_put_escaped(uart_t* uart, uint8_t data)
+{
+    uint8_t esc[2];
+    
+    if(slip_is_special(data)){
+        esc[0] = SLIP_ESC;
+        esc[1] = (data == SLIP_END) ? SLIP_ESC_END : SLIP_ESC_ESC;
+        uart_dev_write(uart, esc, 2);
+    }else{
+        uart_dev_put(uart, data);
+    }
+}
+
+void slip_dev_encoder_begin(slip_encoder_t* encoder, uart_t* uart)
+{
+    encoder->uart = uart;
+    encoder->crc = SLIP_CRC_INIT;
+    
+    // Завершает возможный мусор на линии у приёмника.
+    uart_dev_put(uart, SLIP_END);
+}
+
+size_t slip_encoder_write(slip_encoder_t* encoder, const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    size_t i, run;
+    
+    for(i = 0; i < size; i ++){
+        encoder->crc = _crc_ccitt_update(encoder->crc, bytes[i]);
+    }
+    
+    i = 0;
+    while(i < size){
+        // Байты без экранирования передаются целыми отрезками.
+        for(run = i; run < size && !slip_is_special(bytes[run]); run ++);
+        
+        if(run != i){
+            if(uart_dev_write(encoder->uart, bytes + i, run - i) != run - i) return i;
+            i = run;
+        }
+        
+        if(i < size){
+            slip_put_escaped(encoder->uart, bytes[i]);
+            i ++;
+        }
+    }
+    
+    return size;
+}
+
+void slip_encoder_end(slip_encoder_t* encoder)
+{
+    slip_put_escaped(encoder->uart, encoder->crc & 0xff);
+    slip_put_escaped(encoder->uart, encoder->crc >> 8);
+    
+    uart_dev_put(encoder->uart, SLIP_END);
+}
+
+size_t slip_dev_send(uart_t* uart, const void* data, size_t size)
+{
+    slip_encoder_t encoder;
+    
+    slip_dev_encoder_begin(&encoder, uart);
+    size = slip_encoder_write(&encoder, data, size);
+    slip_encoder_end(&encoder);
+    
+    return size;
+}
+
+err_t slip_dev_decoder_init(slip_decoder_t* decoder, uart_t* uart, uint8_t* ptr, size_t size)
+{
+    if(uart == NULL || ptr == NULL) return E_NULL_POINTER;
+    if(size <= SLIP_CRC_SIZE) return E_INVALID_VALUE;
+    
+    decoder->uart = uart;
+    decoder->ptr = ptr;
+    decoder->size = size;
+    decoder->errors = 0;
+    
+    slip_decoder_reset(decoder);
+    
+    return E_NO_ERROR;
+}
+
+void slip_decoder_reset(slip_decoder_t* decoder)
+{
+    decoder->count = 0;
+    decoder->crc = SLIP_CRC_INIT;
+    decoder->escape = false;
+    decoder->discard = false;
+}
+
+/**
+ * Завершает принимаемый кадр.
+ * @param decoder Декодер.
+ * @return Размер данных корректного кадра, либо 0.
+ */
+static size_t slip_decoder_end(slip_decoder_t* decoder)
+{
+    size_t size = 0;
+    
+    // Пустой кадр - разделитель, ошибкой не является.
+    if(decoder->count != 0 || decoder->discard){
+        // CRC данных вместе с переданным CRC даёт 0.
+        if(!decoder->discard && !decoder->escape &&
+           decoder->count > SLIP_CRC_SIZE && decoder->crc == 0){
+            size = decoder->count - SLIP_CRC_SIZE;
+        }else{
+            decoder->errors ++;
+        }
+    }
+    
+    slip_decoder_reset(decoder);
+    
+    return size;
+}
+
+size_t slip_decoder_put(slip_decoder_t* decoder, uint8_t data)
+{
+    if(data == SLIP_END) return slip_decoder_end(decoder);
+    
+    if(decoder->discard) return 0;
+    
+    if(decoder->escape){
+        decoder->escape = false;
+        
+        if(data == SLIP_ESC_END){
+            data = SLIP_END;
+        }else if(data == SLIP_ESC_ESC){
+            data = SLIP_ESC;
+        }else{
+            // Неверная последовательность - ждём следующий END.
+            decoder->discard = true;
+            return 0;
+        }
+    }else if(data == SLIP_ESC){
+        decoder->escape = true;
+        return 0;
+    }
+    
+    if(decoder->count >= decoder->size){
+        decoder->discard = true;
+        return 0;
+    }
+    
+    decoder->ptr[decoder->count ++] = data;
+    decoder->crc = _crc_ccitt_update(decoder->crc, data);
+    
+    return 0;
+}
+
+size_t slip_receive(slip_decoder_t* decoder)
+{
+    const uint8_t* ptr;
+    size_t avail, i;
+    size_t size = 0;
+    uint8_t data;
+    
+    while((avail = uart_dev_peek_region(decoder->uart, &ptr)) != 0){
+        for(i = 0; i < avail && size == 0; i ++){
+            size = slip_decoder_put(decoder, ptr[i]);
+        }
+        
+        uart_dev_consume(decoder->uart, i);
+        
+        if(size != 0) break;
+    }
+    
+    // В режиме перезаписи буфера чтения области
+    // без копирования недоступны - читаем побайтно.
+    while(size == 0 && uart_dev_get(decoder->uart, &data) != 0){
+        size = slip_decoder_put(decoder, data);
+    }
+    
+    return size;
+}
+
+size_t slip_decoder_errors(slip_decoder_t* decoder)
+{
+    return decoder->errors;
+}
+
+void slip_decoder_reset_errors(slip_decoder_t* decoder)
+{
+    decoder->errors = 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file slip.h
+ * Библиотека кадрирования данных SLIP с CRC16 поверх UART.
+ *
+ * Кадр: END, данные, CRC16-CCITT данных (младшим байтом вперёд), END.
+ * Байты END и ESC в данных и CRC экранируются.
+ * Кодер пишет кадр напрямую в буфер записи UART,
+ * декодер разбирает поток побайтно и восстанавливает
+ * синхронизацию по следующему END после ошибки.
+ * UART задаётся при начале кадра кодера и инициализации
+ * декодера, функции без _dev_ используют UART по умолчанию.
+ */
+
+#ifndef SLIP_H
+#define	SLIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "errors/errors.h"
+#include "defs/defs.h"
+#include "uart/uart.h"
+
+
+//! Специальные байты SLIP.
+//! Конец кадра.
+#define SLIP_END        0xc0
+//! Экранирование.
+#define SLIP_ESC        0xdb
+//! Экранированный END.
+#define SLIP_ESC_END    0xdc
+//! Экранированный ESC.
+#define SLIP_ESC_ESC    0xdd
+
+//! Размер CRC кадра.
+#define SLIP_CRC_SIZE   2
+
+//! Начальное значение CRC.
+#define SLIP_CRC_INIT   0xffff
+
+
+/**
+ * Структура кодера SLIP.
+ */
+typedef struct _Slip_Encoder {
+    //! UART.
+    uart_t* uart;
+    //! CRC переданных байт кадра.
+    uint16_t crc;
+}slip_encoder_t;
+
+/**
+ * Структура декодера SLIP.
+ */
+typedef struct _Slip_Decoder {
+    //! UART.
+    uart_t* uart;
+    //! Буфер кадра.
+    uint8_t* ptr;
+    //! Размер буфера.
+    size_t size;
+    //! Число принятых байт кадра.
+    size_t count;
+    //! CRC принятых байт кадра.
+    uint16_t crc;
+    //! Флаг приёма экранирующего байта.
+    bool escape;
+    //! Флаг отбрасывания кадра до следующего END.
+    bool discard;
+    //! Число ошибочных кадров.
+    size_t errors;
+}slip_decoder_t;
+
+
+/**
+ * Начинает кадр.
+ * @param encoder Кодер.
+ * @param uart UART.
+ */
+extern void slip_dev_encoder_begin(slip_encoder_t* encoder, uart_t* uart);
+
+//! slip_dev_encoder_begin() для UART по умолчанию.
+ALWAYS_INLINE static void slip_encoder_begin(slip_encoder_t* encoder)
+{
+    slip_dev_encoder_begin(encoder, UART_DEFAULT);
+}
+
+/**
+ * Кодирует и передаёт очередную часть данных кадра.
+ * @param encoder Кодер.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Размер переданных данных.
+ */
+extern size_t slip_encoder_write(slip_encoder_t* encoder, const void* data, size_t size);
+
+/**
+ * Завершает кадр, передавая CRC и END.
+ * @param encoder Кодер.
+ */
+extern void slip_encoder_end(slip_encoder_t* encoder);
+
+/**
+ * Кодирует и передаёт кадр целиком.
+ * @param uart UART.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Размер переданных данных.
+ */
+extern size_t slip_dev_send(uart_t* uart, const void* data, size_t size);
+
+//! slip_dev_send() для UART по умолчанию.
+ALWAYS_INLINE static size_t slip_send(const void* data, size_t size)
+{
+    return slip_dev_send(UART_DEFAULT, data, size);
+}
+
+/**
+ * Инициализирует декодер.
+ * @param decoder Декодер.
+ * @param uart UART, из которого читает slip_receive().
+ * @param ptr Буфер для данных кадра, включая CRC.
+ * @param size Размер буфера, больше SLIP_CRC_SIZE.
+ * @return Код ошибки.
+ */
+extern err_t slip_dev_decoder_init(slip_decoder_t* decoder, uart_t* uart, uint8_t* ptr, size_t size);
+
+//! slip_dev_decoder_init() для UART по умолчанию.
+ALWAYS_INLINE static err_t slip_decoder_init(slip_decoder_t* decoder, uint8_t* ptr, size_t size)
+{
+    return slip_dev_decoder_init(decoder, UART_DEFAULT, ptr, size);
+}
+
+/**
+ * Сбрасывает текущий принимаемый кадр.
+ * @param decoder Декодер.
+ */
+extern void slip_decoder_reset(slip_decoder_t* decoder);
+
+/**
+ * Декодирует очередной принятый байт.
+ * При завершении корректного кадра его данные (без CRC)
+ * находятся в начале буфера декодера
+ * до следующего вызова slip_decoder_put.
+ * @param decoder Декодер.
+ * @param data Принятый байт.
+ * @return Размер данных принятого кадра, либо 0.
+ */
+extern size_t slip_decoder_put(slip_decoder_t* decoder, uint8_t data);
+
+/**
+ * Декодирует данные из буфера чтения UART декодера до конца
+ * первого корректного кадра, либо до опустошения буфера.
+ * В режиме перезаписи буфера чтения данные читаются побайтно.
+ * @param decoder Декодер.
+ * @return Размер данных принятого кадра, либо 0.
+ */
+extern size_t slip_receive(slip_decoder_t* decoder);
+
+/**
+ * Получает число отброшенных ошибочных кадров.
+ * @param decoder Декодер.
+ * @return Число ошибочных кадров.
+ */
+extern size_t slip_decoder_errors(slip_decoder_t* decoder);
+
+/**
+ * Сбрасывает число ошибочных кадров.
+ * @param decoder Декодер.
+ */
+extern void slip_decoder_reset_errors(slip_decoder_t* decoder);
+
+#endif	/* SLIP_H */
@@ -0,0 +1,165 @@
+/**
+ * Бенчмарк кодера и декодера SLIP на ПК.
+ * Сборка и запуск: make -C host bench.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "slip/slip.h"
+#include "uart_host.h"
+#include "bench.h"
+
+
+//! Число байт данных, кодируемых в каждом измерении.
+#define BENCH_BYTES (4UL * 1024 * 1024)
+
+//! Максимальный размер данных кадра.
+#define BENCH_FRAME_MAX 200
+
+//! Размеры данных кадров.
+static const size_t bench_frame_sizes[] = {16, 64, BENCH_FRAME_MAX};
+
+static uint8_t bench_rx_buf[1024];
+static uint8_t bench_tx_buf[1024];
+
+static uint8_t bench_data[BENCH_FRAME_MAX];
+static uint8_t bench_frame[BENCH_FRAME_MAX * 2 + 8];
+static uint8_t bench_decoder_buf[BENCH_FRAME_MAX + SLIP_CRC_SIZE];
+
+
+/**
+ * Заполняет данные кадра.
+ * @param special Флаг данных только из экранируемых байт.
+ */
+static void bench_fill(bool special)
+{
+    size_t i;
+    uint8_t x = 0x5a;
+    
+    for(i = 0; i < sizeof(bench_data); i ++){
+        if(special){
+            bench_data[i] = (i & 1) ? SLIP_END : SLIP_ESC;
+        }else{
+            // Псевдослучайные данные, около 1% экранируемых байт.
+            x = (uint8_t)(x * 13 + 7);
+            bench_data[i] = x;
+        }
+    }
+}
+
+/**
+ * Измеряет кодирование кадров в буфер записи UART.
+ * Передача из буфера в измерение не входит.
+ * @param size Размер данных кадра.
+ * @param name Имя случая.
+ */
+static void bench_encode(size_t size, const char* name)
+{
+    uint64_t t_enc = 0, t;
+    uint64_t n = 0, frames = 0;
+    
+    while(n < BENCH_BYTES){
+        t = bench_now_ns();
+        slip_send(bench_data, size);
+        t_enc += bench_now_ns() - t;
+        
+        uart_host_transmit(NULL, 0);
+        
+        n += size;
+        frames ++;
+    }
+    
+    bench_report("slip", name, size, frames, n, t_enc);
+}
+
+/**
+ * Измеряет декодирование кадров.
+ * @param size Размер данных кадра.
+ * @param name Имя случая.
+ */
+static void bench_decode(size_t size, const char* name)
+{
+    slip_decoder_t decoder;
+    uint64_t t;
+    uint64_t n = 0, frames = 0;
+    size_t frame_size, i, res = 0;
+    
+    slip_decoder_init(&decoder, bench_decoder_buf, sizeof(bench_decoder_buf));
+    
+    slip_send(bench_data, size);
+    frame_size = uart_host_transmit(bench_frame, sizeof(bench_frame));
+    
+    t = bench_now_ns();
+    while(n < BENCH_BYTES){
+        for(i = 0; i < frame_size; i ++){
+            res += slip_decoder_put(&decoder, bench_frame[i]);
+        }
+        n += size;
+        frames ++;
+    }
+    t = bench_now_ns() - t;
+    
+    bench_sink = (uint32_t)res;
+    
+    bench_report("slip", name, size, frames, n, t);
+}
+
+/**
+ * Измеряет приём кадров из буфера чтения UART.
+ * Помещение байт в буфер в измерение не входит.
+ * @param size Размер данных кадра.
+ * @param name Имя случая.
+ */
+static void bench_receive(size_t size, const char* name)
+{
+    slip_decoder_t decoder;
+    uint64_t t_rx = 0, t;
+    uint64_t n = 0, frames = 0;
+    size_t frame_size, res = 0;
+    
+    slip_decoder_init(&decoder, bench_decoder_buf, sizeof(bench_decoder_buf));
+    
+    slip_send(bench_data, size);
+    frame_size = uart_host_transmit(bench_frame, sizeof(bench_frame));
+    
+    while(n < BENCH_BYTES){
+        uart_host_receive(bench_frame, frame_size);
+        
+        t = bench_now_ns();
+        res += slip_receive(&decoder);
+        t_rx += bench_now_ns() - t;
+        
+        n += size;
+        frames ++;
+    }
+    
+    bench_sink = (uint32_t)res;
+    
+    bench_report("slip", name, size, frames, n, t_rx);
+}
+
+int main(void)
+{
+    size_t i, size;
+    
+    uart_host_init(bench_rx_buf, sizeof(bench_rx_buf), bench_tx_buf, sizeof(bench_tx_buf));
+    
+    bench_header();
+    
+    for(i = 0; i < sizeof(bench_frame_sizes) / sizeof(bench_frame_sizes[0]); i ++){
+        size = bench_frame_sizes[i];
+        
+        bench_fill(false);
+        bench_encode(size, "encode");
+        bench_decode(size, "decode");
+        bench_receive(size, "receive");
+        
+        // Худший случай: каждый байт экранируется.
+        bench_fill(true);
+        bench_encode(size, "encode_escaped");
+        bench_decode(size, "decode_escaped");
+    }
+    
+    return 0;
+}
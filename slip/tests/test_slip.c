@@ -0,0 +1,293 @@
+/**
+ * Тесты кодера и декодера SLIP на ПК.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "slip/slip.h"
+#include "uart_host.h"
+#include "test.h"
+
+
+//! Размер буфера кадра декодера.
+#define TEST_FRAME_SIZE 32
+
+static uint8_t test_rx_buf[256];
+static uint8_t test_tx_buf[256];
+
+static uint8_t test_frame_buf[TEST_FRAME_SIZE];
+static slip_decoder_t test_decoder;
+
+//! Данные с экранируемыми байтами.
+static const uint8_t test_data[] = {0x01, SLIP_END, 0x02, SLIP_ESC, SLIP_ESC_END, SLIP_ESC_ESC, 0x03};
+
+
+/**
+ * Кодирует кадр и получает переданные через UART байты.
+ * @param data Данные кадра.
+ * @param size Размер данных.
+ * @param out Буфер для закодированного кадра.
+ * @param out_size Размер буфера.
+ * @return Размер закодированного кадра.
+ */
+static size_t test_encode(const void* data, size_t size, uint8_t* out, size_t out_size)
+{
+    TEST_CHECK_EQ(slip_send(data, size), size);
+    
+    return uart_host_transmit(out, out_size);
+}
+
+/**
+ * Передаёт байты декодеру.
+ * @param data Байты.
+ * @param size Число байт.
+ * @param frame_size Размер последнего принятого кадра.
+ * @return Число принятых кадров.
+ */
+static size_t test_decode(const uint8_t* data, size_t size, size_t* frame_size)
+{
+    size_t frames = 0;
+    size_t i, res;
+    
+    for(i = 0; i < size; i ++){
+        res = slip_decoder_put(&test_decoder, data[i]);
+        if(res != 0){
+            frames ++;
+            *frame_size = res;
+        }
+    }
+    
+    return frames;
+}
+
+/**
+ * Проверяет приём кадра test_data после предыдущих данных.
+ * @param errors Ожидаемое число ошибочных кадров.
+ */
+static void test_expect_resync(size_t errors)
+{
+    uint8_t frame[64];
+    size_t size, frame_size = 0;
+    
+    size = test_encode(test_data, sizeof(test_data), frame, sizeof(frame));
+    
+    TEST_CHECK_EQ(test_decode(frame, size, &frame_size), 1);
+    TEST_CHECK_EQ(frame_size, sizeof(test_data));
+    TEST_CHECK(memcmp(test_frame_buf, test_data, sizeof(test_data)) == 0);
+    TEST_CHECK_EQ(slip_decoder_errors(&test_decoder), errors);
+}
+
+/**
+ * Сбрасывает декодер и счётчик ошибок.
+ */
+static void test_reset(void)
+{
+    slip_decoder_init(&test_decoder, test_frame_buf, sizeof(test_frame_buf));
+}
+
+//! Кодирование и приём через буферы UART.
+static void test_round_trip(void)
+{
+    uint8_t frame[64];
+    const uint8_t* ptr;
+    size_t size, i, n;
+    
+    test_reset();
+    
+    size = test_encode(test_data, sizeof(test_data), frame, sizeof(frame));
+    
+    // END, данные с двумя экранированными байтами, CRC, END.
+    TEST_CHECK(size >= sizeof(test_data) + 2 + 2 + 2);
+    TEST_CHECK_EQ(frame[0], SLIP_END);
+    TEST_CHECK_EQ(frame[size - 1], SLIP_END);
+    for(i = 1; i < size - 1; i ++){
+        TEST_CHECK(frame[i] != SLIP_END);
+    }
+    
+    uart_host_receive(frame, size);
+    
+    n = slip_receive(&test_decoder);
+    TEST_CHECK_EQ(n, sizeof(test_data));
+    TEST_CHECK(memcmp(test_frame_buf, test_data, sizeof(test_data)) == 0);
+    TEST_CHECK_EQ(slip_decoder_errors(&test_decoder), 0);
+    TEST_CHECK_EQ(slip_receive(&test_decoder), 0);
+    
+    // Режим перезаписи: чтение без копирования недоступно,
+    // кадр принимается побайтно.
+    TEST_CHECK_EQ(uart_set_read_overwrite(true), E_NO_ERROR);
+    
+    uart_host_receive(frame, size);
+    
+    TEST_CHECK_EQ(uart_peek_region(&ptr), 0);
+    TEST_CHECK_EQ(uart_consume(1), 0);
+    TEST_CHECK_EQ(uart_data_avail(), size);
+    
+    n = slip_receive(&test_decoder);
+    TEST_CHECK_EQ(n, sizeof(test_data));
+    TEST_CHECK(memcmp(test_frame_buf, test_data, sizeof(test_data)) == 0);
+    TEST_CHECK_EQ(uart_data_avail(), 0);
+    
+    TEST_CHECK_EQ(uart_set_read_overwrite(false), E_NO_ERROR);
+}
+
+//! Кодер и декодер на явно заданном UART.
+static void test_dev_uart(void)
+{
+    slip_decoder_t decoder;
+    slip_encoder_t encoder;
+    uint8_t frame[64];
+    size_t size;
+    
+    TEST_CHECK_EQ(slip_dev_decoder_init(&decoder, NULL, test_frame_buf, sizeof(test_frame_buf)), E_NULL_POINTER);
+    TEST_CHECK_EQ(slip_dev_decoder_init(&decoder, UART0, test_frame_buf, sizeof(test_frame_buf)), E_NO_ERROR);
+    TEST_CHECK(decoder.uart == UART0);
+    
+    slip_dev_encoder_begin(&encoder, UART0);
+    TEST_CHECK(encoder.uart == UART0);
+    TEST_CHECK_EQ(slip_encoder_write(&encoder, test_data, 3), 3);
+    TEST_CHECK_EQ(slip_encoder_write(&encoder, test_data + 3, sizeof(test_data) - 3), sizeof(test_data) - 3);
+    slip_encoder_end(&encoder);
+    
+    size = uart_host_transmit(frame, sizeof(frame));
+    uart_host_receive(frame, size);
+    
+    TEST_CHECK_EQ(slip_receive(&decoder), sizeof(test_data));
+    TEST_CHECK(memcmp(test_frame_buf, test_data, sizeof(test_data)) == 0);
+    
+    // Кадр целиком - тот же поток, что и от UART по умолчанию.
+    TEST_CHECK_EQ(slip_dev_send(UART0, test_data, sizeof(test_data)), sizeof(test_data));
+    TEST_CHECK_EQ(uart_host_transmit(NULL, 0), size);
+    
+    test_reset();
+}
+
+//! Повреждённые данные кадра.
+static void test_bad_crc(void)
+{
+    uint8_t frame[64];
+    size_t size, frame_size = 0;
+    
+    test_reset();
+    
+    size = test_encode(test_data, sizeof(test_data), frame, sizeof(frame));
+    // Первый байт данных не экранируется.
+    frame[1] ^= 0x40;
+    
+    TEST_CHECK_EQ(test_decode(frame, size, &frame_size), 0);
+    TEST_CHECK_EQ(slip_decoder_errors(&test_decoder), 1);
+    
+    test_expect_resync(1);
+}
+
+//! Неверная последовательность экранирования.
+static void test_bad_escape(void)
+{
+    static const uint8_t bad[] = {SLIP_END, 0x01, SLIP_ESC, 0x55, 0x02, 0x03, SLIP_END};
+    size_t frame_size = 0;
+    
+    test_reset();
+    
+    TEST_CHECK_EQ(test_decode(bad, sizeof(bad), &frame_size), 0);
+    TEST_CHECK_EQ(slip_decoder_errors(&test_decoder), 1);
+    
+    test_expect_resync(1);
+}
+
+//! Кадр, оборванный началом следующего кадра.
+static void test_truncated(void)
+{
+    uint8_t frame[64];
+    size_t size, frame_size = 0;
+    
+    test_reset();
+    
+    size = test_encode(test_data, sizeof(test_data), frame, sizeof(frame));
+    
+    // Без CRC и END.
+    TEST_CHECK_EQ(test_decode(frame, size - 3, &frame_size), 0);
+    test_expect_resync(1);
+    
+    // Оборван на экранирующем байте.
+    TEST_CHECK_EQ(test_decode(frame, 3, &frame_size), 0);
+    TEST_CHECK_EQ(frame[2], SLIP_ESC);
+    test_expect_resync(2);
+    
+    // Кадр короче CRC.
+    TEST_CHECK_EQ(test_decode(frame, 2, &frame_size), 0);
+    test_expect_resync(3);
+}
+
+//! Мусор на линии до начала кадра.
+static void test_garbage(void)
+{
+    uint8_t garbage[100];
+    size_t i, frame_size = 0;
+    
+    test_reset();
+    
+    for(i = 0; i < sizeof(garbage); i ++){
+        garbage[i] = (uint8_t)(i * 37 + 11);
+        if(garbage[i] == SLIP_END) garbage[i] = 0;
+    }
+    
+    // Мусор длиннее буфера кадра.
+    TEST_CHECK_EQ(test_decode(garbage, sizeof(garbage), &frame_size), 0);
+    test_expect_resync(1);
+    
+    // Короткий мусор.
+    TEST_CHECK_EQ(test_decode(garbage, 5, &frame_size), 0);
+    test_expect_resync(2);
+    
+    // Пустые кадры ошибками не являются.
+    garbage[0] = SLIP_END;
+    garbage[1] = SLIP_END;
+    TEST_CHECK_EQ(test_decode(garbage, 2, &frame_size), 0);
+    test_expect_resync(2);
+    
+    slip_decoder_reset_errors(&test_decoder);
+    TEST_CHECK_EQ(slip_decoder_errors(&test_decoder), 0);
+}
+
+//! Кадр максимального размера.
+static void test_max_frame(void)
+{
+    uint8_t data[TEST_FRAME_SIZE - SLIP_CRC_SIZE + 1];
+    uint8_t frame[128];
+    size_t i, size, frame_size = 0;
+    
+    test_reset();
+    
+    for(i = 0; i < sizeof(data); i ++) data[i] = (uint8_t)(0xc0 + i);
+    
+    size = test_encode(data, sizeof(data) - 1, frame, sizeof(frame));
+    TEST_CHECK_EQ(test_decode(frame, size, &frame_size), 1);
+    TEST_CHECK_EQ(frame_size, sizeof(data) - 1);
+    TEST_CHECK(memcmp(test_frame_buf, data, sizeof(data) - 1) == 0);
+    
+    // Не помещается в буфер декодера.
+    size = test_encode(data, sizeof(data), frame, sizeof(frame));
+    TEST_CHECK_EQ(test_decode(frame, size, &frame_size), 0);
+    TEST_CHECK_EQ(slip_decoder_errors(&test_decoder), 1);
+    
+    test_expect_resync(1);
+}
+
+int main(void)
+{
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    TEST_CHECK_EQ(slip_decoder_init(&test_decoder, NULL, TEST_FRAME_SIZE), E_NULL_POINTER);
+    TEST_CHECK_EQ(slip_decoder_init(&test_decoder, test_frame_buf, SLIP_CRC_SIZE), E_INVALID_VALUE);
+    
+    test_round_trip();
+    test_dev_uart();
+    test_bad_crc();
+    test_bad_escape();
+    test_truncated();
+    test_garbage();
+    test_max_frame();
+    
+    return test_result("test_slip");
+}
@@ -5,6 +5,7 @@
 #include "ports/ports.h"
 #include "bits/bits.h"
 #include "buffer/buffer.h"
+#include "buffer/buffer_list.h"
 #include "defs/defs.h"
 
 //! Максимальные значения.
@@ -41,9 +42,16 @@ typedef uint8_t spi_transfer_mode_t;
                 SPCR |= __saved_spcr_spie
 
 
+/**
+ * Данные мастера.
+ * Для простых передач списки ссылаются
+ * на встроенные буферы передачи и приёма.
+ */
 typedef struct _SpiMasterData{
     buffer_t tx_buffer;
     buffer_t rx_buffer;
+    buffer_list_t tx_list;
+    buffer_list_t rx_list;
     spi_transfer_mode_t mode;
 } spi_master_data_t;
 
@@ -63,6 +71,10 @@ typedef struct _SpiState{
     spi_master_callback_t master_callback;
     spi_slave_callback_t slave_callback;
     
+#if SPI_CALLBACKS_COUNT > 0
+    spi_master_callback_t master_callbacks[SPI_CALLBACKS_COUNT];
+#endif
+    
     spi_master_data_t master;
 } spi_t;
 
@@ -73,13 +85,13 @@ static spi_t spi;
 
 ALWAYS_INLINE static bool spi_m_rx_has_next(void)
 {
-    return buffer_valid(&spi.master.rx_buffer) && buffer_has_next(&spi.master.rx_buffer);
+    return buffer_list_has_next(&spi.master.rx_list);
 }
 
 static bool spi_m_rx_next(void)
 {
-    if(buffer_valid(&spi.master.rx_buffer) && spi_m_rx_has_next()){
-        buffer_set_next(&spi.master.rx_buffer, SPDR);
+    if(spi_m_rx_has_next()){
+        buffer_list_set_next(&spi.master.rx_list, SPDR);
         return true;
     }
     return false;
@@ -87,21 +99,42 @@ static bool spi_m_rx_next(void)
 
 ALWAYS_INLINE static bool spi_m_tx_has_next(void)
 {
-    return buffer_valid(&spi.master.tx_buffer) && buffer_has_next(&spi.master.tx_buffer);
+    return buffer_list_has_next(&spi.master.tx_list);
 }
 
 static bool spi_m_tx_next(void)
 {
-    if(buffer_valid(&spi.master.tx_buffer) && spi_m_tx_has_next()){
-        SPDR = buffer_get_next(&spi.master.tx_buffer);
+    if(spi_m_tx_has_next()){
+        SPDR = buffer_list_get_next(&spi.master.tx_list);
         return true;
     }
     return false;
 }
 
+/**
+ * Инициализирует список из одного встроенного буфера.
+ * @param list Список буферов.
+ * @param buffer Встроенный буфер.
+ * @param ptr Указатель на данные, или NULL для пустого списка.
+ * @param size Размер данных.
+ */
+static void spi_m_list_init(buffer_list_t* list, buffer_t* buffer, void* ptr, size_t size)
+{
+    buffer_init(buffer, (uint8_t*)ptr, size);
+    buffer_list_init(list, ptr ? buffer : NULL, 1);
+}
+
 ALWAYS_INLINE static void spi_end(spi_state_t state)
 {
     spi.state = state;
+#if SPI_CALLBACKS_COUNT > 0
+    // Владелец передачи - без перебора каллбэков.
+    if(spi.transfer_id < SPI_CALLBACKS_COUNT &&
+       spi.master_callbacks[spi.transfer_id]){
+        spi.master_callbacks[spi.transfer_id]();
+        return;
+    }
+#endif
     if(spi.master_callback) spi.master_callback();
 }
 
@@ -342,6 +375,29 @@ void spi_set_master_callback(spi_master_callback_t callback)
     __spi_interrupts_restore();
 }
 
+err_t spi_register_master_callback(spi_transfer_id_t id, spi_master_callback_t callback)
+{
+#if SPI_CALLBACKS_COUNT > 0
+    if(id >= SPI_CALLBACKS_COUNT) return E_OUT_OF_RANGE;
+    
+    __spi_interrupts_save_disable();
+    spi.master_callbacks[id] = callback;
+    __spi_interrupts_restore();
+    
+    return E_NO_ERROR;
+#else
+    return E_OUT_OF_RANGE;
+#endif
+}
+
+spi_master_callback_t spi_registered_master_callback(spi_transfer_id_t id)
+{
+#if SPI_CALLBACKS_COUNT > 0
+    if(id < SPI_CALLBACKS_COUNT) return spi.master_callbacks[id];
+#endif
+    return NULL;
+}
+
 spi_slave_callback_t spi_slave_callback(void)
 {
     return spi.slave_callback;
@@ -363,8 +419,8 @@ err_t spi_transfer(const void* tx_data, void* rx_data, size_t size)
     spi.state = SPI_STATE_DATA_TRANSFERING;
     
     spi.master.mode = SPI_TRANSFER_MODE_READ_WRITE;
-    buffer_init(&spi.master.tx_buffer, (uint8_t*)tx_data, size);
-    buffer_init(&spi.master.rx_buffer, (uint8_t*)rx_data, size);
+    spi_m_list_init(&spi.master.tx_list, &spi.master.tx_buffer, (void*)tx_data, size);
+    spi_m_list_init(&spi.master.rx_list, &spi.master.rx_buffer, rx_data, size);
     
     if(!spi_m_tx_next()){
         SPDR = SPI_DATA_DEFAULT;
@@ -387,7 +443,7 @@ err_t spi_write(const void* data, size_t size)
     spi.state = SPI_STATE_DATA_WRITING;
     
     spi.master.mode = SPI_TRANSFER_MODE_WRITE;
-    buffer_init(&spi.master.tx_buffer, (uint8_t*)data, size);
+    spi_m_list_init(&spi.master.tx_list, &spi.master.tx_buffer, (void*)data, size);
     
     if(!spi_m_tx_next()){
         spi.state = SPI_STATE_IDLE;
@@ -411,7 +467,7 @@ err_t spi_read(void* data, size_t size)
     spi.state = SPI_STATE_DATA_READING;
     
     spi.master.mode = SPI_TRANSFER_MODE_READ;
-    buffer_init(&spi.master.rx_buffer, (uint8_t*)data, size);
+    spi_m_list_init(&spi.master.rx_list, &spi.master.rx_buffer, data, size);
     
     SPDR = SPI_DATA_DEFAULT;
     
@@ -432,8 +488,63 @@ err_t spi_write_then_read(const void* tx_data, size_t tx_size, void* rx_data, si
     spi.state = SPI_STATE_DATA_WRITING;
     
     spi.master.mode = SPI_TRANSFER_MODE_WRITE_THEN_READ;
-    buffer_init(&spi.master.tx_buffer, (uint8_t*)tx_data, tx_size);
-    buffer_init(&spi.master.rx_buffer, (uint8_t*)rx_data, rx_size);
+    spi_m_list_init(&spi.master.tx_list, &spi.master.tx_buffer, (void*)tx_data, tx_size);
+    spi_m_list_init(&spi.master.rx_list, &spi.master.rx_buffer, rx_data, rx_size);
+    
+    if(!spi_m_tx_next()){
+        spi.state = SPI_STATE_IDLE;
+        return E_INVALID_VALUE;
+    }
+    
+    if(BIT_TEST(SPSR, WCOL)){
+        spi.state = SPI_STATE_IDLE;
+        return E_BUSY;
+    }
+    
+    return E_NO_ERROR;
+}
+
+err_t spi_write_sg(buffer_t* data, size_t count)
+{
+    if(spi_busy()) return E_BUSY;
+    if(data == NULL) return E_NULL_POINTER;
+    if(count == 0) return E_INVALID_VALUE;
+    
+    spi.state = SPI_STATE_DATA_WRITING;
+    
+    spi.master.mode = SPI_TRANSFER_MODE_WRITE;
+    buffer_list_init(&spi.master.tx_list, data, count);
+    buffer_list_reset(&spi.master.tx_list);
+    
+    if(!spi_m_tx_next()){
+        spi.state = SPI_STATE_IDLE;
+        return E_INVALID_VALUE;
+    }
+    
+    if(BIT_TEST(SPSR, WCOL)){
+        spi.state = SPI_STATE_IDLE;
+        return E_BUSY;
+    }
+    
+    return E_NO_ERROR;
+}
+
+err_t spi_write_then_read_sg(buffer_t* tx_data, size_t tx_count, buffer_t* rx_data, size_t rx_count)
+{
+    if(spi_busy()) return E_BUSY;
+    if(tx_data == NULL || rx_data == NULL) return E_NULL_POINTER;
+    if(tx_count == 0 || rx_count == 0) return E_INVALID_VALUE;
+    
+    buffer_list_init(&spi.master.rx_list, rx_data, rx_count);
+    buffer_list_reset(&spi.master.rx_list);
+    
+    if(!spi_m_rx_has_next()) return E_INVALID_VALUE;
+    
+    spi.state = SPI_STATE_DATA_WRITING;
+    
+    spi.master.mode = SPI_TRANSFER_MODE_WRITE_THEN_READ;
+    buffer_list_init(&spi.master.tx_list, tx_data, tx_count);
+    buffer_list_reset(&spi.master.tx_list);
     
     if(!spi_m_tx_next()){
         spi.state = SPI_STATE_IDLE;
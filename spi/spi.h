@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include "errors/errors.h"
+#include "buffer/buffer.h"
 
 //! Ошибки SPI.
 //#define E_SPI (E_USER + 60)
@@ -91,6 +92,13 @@ typedef uint8_t spi_state_t;
 //Идентификатор передачи по умолчанию.
 #define SPI_DEFAULT_TRANSFER_ID 0
 
+//! Размер таблицы каллбэков по идентификатору передачи.
+//! Передачи с идентификатором вне таблицы
+//! обрабатываются каллбэком ведущего.
+#ifndef SPI_CALLBACKS_COUNT
+#define SPI_CALLBACKS_COUNT 8
+#endif
+
 //! Тип идентификатора передачи.
 typedef uint8_t spi_transfer_id_t;
 
@@ -211,6 +219,24 @@ extern spi_master_callback_t spi_master_callback(void);
  */
 extern void spi_set_master_callback(spi_master_callback_t callback);
 
+/**
+ * Регистрирует каллбэк ведущего для идентификатора передачи.
+ * По окончании передачи с этим идентификатором
+ * вызывается только зарегистрированный каллбэк,
+ * для остальных - каллбэк ведущего.
+ * @param id Идентификатор передачи, меньше SPI_CALLBACKS_COUNT.
+ * @param callback Каллбэк, или NULL для удаления регистрации.
+ * @return Код ошибки.
+ */
+extern err_t spi_register_master_callback(spi_transfer_id_t id, spi_master_callback_t callback);
+
+/**
+ * Получает каллбэк, зарегистрированный для идентификатора передачи.
+ * @param id Идентификатор передачи.
+ * @return Каллбэк, или NULL.
+ */
+extern spi_master_callback_t spi_registered_master_callback(spi_transfer_id_t id);
+
 /**
  * Получает каллбэк ведомого.
  * @return Каллбэк ведомого.
@@ -258,5 +284,27 @@ extern err_t spi_read(void* data, size_t size);
  */
 extern err_t spi_write_then_read(const void* tx_data, size_t tx_size, void* rx_data, size_t rx_size);
 
+/**
+ * Асинхронно передаёт данные из списка буферов по SPI
+ * одной транзакцией, без копирования в общий буфер.
+ * Буферы должны существовать до окончания передачи.
+ * @param data Буферы данных для передачи.
+ * @param count Число буферов.
+ * @return Код ошибки.
+ */
+extern err_t spi_write_sg(buffer_t* data, size_t count);
+
+/**
+ * Асинхронно передаёт данные из списка буферов,
+ * затем принимает данные в список буферов по SPI.
+ * Буферы должны существовать до окончания передачи.
+ * @param tx_data Буферы данных для передачи.
+ * @param tx_count Число буферов для передачи.
+ * @param rx_data Буферы для приёма данных.
+ * @param rx_count Число буферов для приёма.
+ * @return Код ошибки.
+ */
+extern err_t spi_write_then_read_sg(buffer_t* tx_data, size_t tx_count, buffer_t* rx_data, size_t rx_count);
+
 #endif	/* SPI_H */
 
@@ -0,0 +1,125 @@
+#include "telemetry.h"
+#include <string.h>
+#include "slip/slip.h"
+#include "counter/counter.h"
+
+
+/**
+ * Состояние телеметрии.
+ */
+typedef struct _Telemetry_State {
+    uart_t* uart;
+    const telemetry_channel_t* channels;
+    uint8_t count;
+}telemetry_state_t;
+
+static telemetry_state_t telemetry_state = {UART_DEFAULT, NULL, 0};
+
+
+/**
+ * Получает размер значения типа.
+ * @param type Тип значения.
+ * @return Размер значения.
+ */
+static uint8_t telemetry_type_size(uint8_t type)
+{
+    // Типы идут парами (знаковый, беззнаковый) по возрастанию размера.
+    return 1 << (type >> 1);
+}
+
+/**
+ * Ищет схему канала по идентификатору.
+ * @param id Идентификатор канала.
+ * @return Схема канала, либо NULL.
+ */
+static const telemetry_channel_t* telemetry_channel(uint8_t id)
+{
+    uint8_t i;
+    for(i = 0; i < telemetry_state.count; i ++){
+        if(telemetry_state.channels[i].id == id) return &telemetry_state.channels[i];
+    }
+    return NULL;
+}
+
+err_t telemetry_dev_init(uart_t* uart, const telemetry_channel_t* channels, uint8_t count)
+{
+    uint8_t i;
+    
+    if(uart == NULL || channels == NULL) return E_NULL_POINTER;
+    
+    for(i = 0; i < count; i ++){
+        if(channels[i].id > TELEMETRY_ID_MAX) return E_OUT_OF_RANGE;
+        if(channels[i].type > TELEMETRY_TYPE_MAX) return E_INVALID_VALUE;
+        if(channels[i].fract_bits > telemetry_type_size(channels[i].type) * 8) return E_INVALID_VALUE;
+    }
+    
+    telemetry_state.uart = uart;
+    telemetry_state.channels = channels;
+    telemetry_state.count = count;
+    
+    return E_NO_ERROR;
+}
+
+/**
+ * Передаёт схему канала.
+ * @param channel Схема канала.
+ */
+static void telemetry_send_schema(const telemetry_channel_t* channel)
+{
+    slip_encoder_t encoder;
+    uint8_t header[5];
+    size_t name_size = 0;
+    
+    header[0] = TELEMETRY_ID_SCHEMA;
+    header[1] = channel->id;
+    header[2] = channel->type;
+    header[3] = channel->fract_bits;
+    header[4] = channel->count;
+    
+    if(channel->name != NULL){
+        name_size = strlen(channel->name);
+        if(name_size > TELEMETRY_NAME_SIZE_MAX) name_size = TELEMETRY_NAME_SIZE_MAX;
+    }
+    
+    slip_dev_encoder_begin(&encoder, telemetry_state.uart);
+    slip_encoder_write(&encoder, header, sizeof(header));
+    slip_encoder_write(&encoder, channel->name, name_size);
+    slip_encoder_end(&encoder);
+}
+
+void telemetry_send_header(void)
+{
+    slip_encoder_t encoder;
+    uint8_t id = TELEMETRY_ID_CLOCK;
+    uint32_t ticks_per_sec = system_counter_ticks_per_sec();
+    uint8_t i;
+    
+    slip_dev_encoder_begin(&encoder, telemetry_state.uart);
+    slip_encoder_write(&encoder, &id, 1);
+    slip_encoder_write(&encoder, &ticks_per_sec, sizeof(uint32_t));
+    slip_encoder_end(&encoder);
+    
+    for(i = 0; i < telemetry_state.count; i ++){
+        telemetry_send_schema(&telemetry_state.channels[i]);
+    }
+}
+
+err_t telemetry_send(uint8_t id, const void* values)
+{
+    const telemetry_channel_t* channel = telemetry_channel(id);
+    slip_encoder_t encoder;
+    uint32_t ticks;
+    
+    if(channel == NULL) return E_INVALID_VALUE;
+    if(values == NULL) return E_NULL_POINTER;
+    
+    ticks = system_counter_ticks();
+    
+    slip_dev_encoder_begin(&encoder, telemetry_state.uart);
+    slip_encoder_write(&encoder, &id, 1);
+    slip_encoder_write(&encoder, &ticks, sizeof(uint32_t));
+    slip_encoder_write(&encoder, values, (size_t)channel->count * telemetry_type_size(channel->type));
+    slip_encoder_end(&encoder);
+    
+    return E_NO_ERROR;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file telemetry.h
+ * Библиотека двоичной телеметрии поверх SLIP.
+ *
+ * Каждая запись передаётся отдельным кадром SLIP (с CRC16).
+ * Запись данных: идентификатор канала (1 байт),
+ * метка времени system_counter_ticks() (4 байта),
+ * значения канала в формате, заданном схемой канала.
+ * Схема канала передаётся записью TELEMETRY_ID_SCHEMA:
+ * идентификатор, тип, число бит дробной части, число значений, имя.
+ * Запись TELEMETRY_ID_CLOCK содержит число тиков системного счётчика в секунду.
+ * Многобайтовые поля передаются младшим байтом вперёд.
+ *
+ * Декодер для ПК: telemetry_decode.py (поток -> CSV).
+ */
+
+#ifndef TELEMETRY_H
+#define	TELEMETRY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "errors/errors.h"
+#include "defs/defs.h"
+#include "uart/uart.h"
+#include "fixed/fixed16.h"
+#include "fixed/fixed32.h"
+
+
+//! Зарезервированные идентификаторы записей.
+//! Запись схемы канала.
+#define TELEMETRY_ID_SCHEMA     0xff
+//! Запись частоты системного счётчика.
+#define TELEMETRY_ID_CLOCK      0xfe
+//! Максимальный идентификатор канала.
+#define TELEMETRY_ID_MAX        0xfd
+
+//! Типы значений каналов.
+#define TELEMETRY_TYPE_INT8     0
+#define TELEMETRY_TYPE_UINT8    1
+#define TELEMETRY_TYPE_INT16    2
+#define TELEMETRY_TYPE_UINT16   3
+#define TELEMETRY_TYPE_INT32    4
+#define TELEMETRY_TYPE_UINT32   5
+//! Максимальное значение типа.
+#define TELEMETRY_TYPE_MAX      TELEMETRY_TYPE_UINT32
+
+//! Тип fixed16_t.
+#define TELEMETRY_TYPE_FIXED16      TELEMETRY_TYPE_INT16, FIXED16_FRACT_BITS
+//! Тип fixed10_6_t.
+#define TELEMETRY_TYPE_FIXED10_6    TELEMETRY_TYPE_INT16, FIXED10_6_FRACT_BITS
+//! Тип fixed32_t.
+#define TELEMETRY_TYPE_FIXED32      TELEMETRY_TYPE_INT32, FIXED32_FRACT_BITS
+//! Целые типы без дробной части.
+#define TELEMETRY_TYPE_INT(type)    type, 0
+
+//! Максимальная длина имени канала.
+#define TELEMETRY_NAME_SIZE_MAX 16
+
+
+/**
+ * Схема канала телеметрии.
+ * Значения канала - массив count значений типа type,
+ * значение равно целому, делённому на 2^fract_bits.
+ */
+typedef struct _Telemetry_Channel {
+    //! Идентификатор канала, не более TELEMETRY_ID_MAX.
+    uint8_t id;
+    //! Тип значений.
+    uint8_t type;
+    //! Число бит дробной части.
+    uint8_t fract_bits;
+    //! Число значений.
+    uint8_t count;
+    //! Имя канала.
+    const char* name;
+}telemetry_channel_t;
+
+
+/**
+ * Инициализирует телеметрию.
+ * Таблица каналов должна существовать всё время использования телеметрии.
+ * @param uart UART для передачи записей.
+ * @param channels Таблица схем каналов.
+ * @param count Число каналов.
+ * @return Код ошибки.
+ */
+extern err_t telemetry_dev_init(uart_t* uart, const telemetry_channel_t* channels, uint8_t count);
+
+//! telemetry_dev_init() для UART по умолчанию.
+ALWAYS_INLINE static err_t telemetry_init(const telemetry_channel_t* channels, uint8_t count)
+{
+    return telemetry_dev_init(UART_DEFAULT, channels, count);
+}
+
+/**
+ * Передаёт частоту системного счётчика и схемы всех каналов.
+ * Следует передавать при старте и периодически,
+ * чтобы декодер мог подключиться к потоку в любой момент.
+ */
+extern void telemetry_send_header(void);
+
+/**
+ * Передаёт запись данных канала с текущей меткой времени.
+ * @param id Идентификатор канала.
+ * @param values Значения канала (count значений типа канала).
+ * @return Код ошибки.
+ */
+extern err_t telemetry_send(uint8_t id, const void* values);
+
+#endif	/* TELEMETRY_H */
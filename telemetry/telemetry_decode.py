@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+
+#####################################################################################
+## Декодер потока телеметрии (telemetry.h) в CSV.
+##
+## Использование:
+##   telemetry_decode.py [-o out.csv] [capture.bin]
+##   stty -F /dev/ttyUSB0 115200 raw && telemetry_decode.py < /dev/ttyUSB0
+##
+## Формат строк CSV:
+##   ticks,seconds,channel,value0,value1,...
+## Поле seconds пусто до приёма записи частоты системного счётчика.
+## Записи каналов, схема которых ещё не принята, пропускаются.
+#####################################################################################
+
+import argparse
+import csv
+import struct
+import sys
+
+SLIP_END = 0xc0
+SLIP_ESC = 0xdb
+SLIP_ESC_END = 0xdc
+SLIP_ESC_ESC = 0xdd
+
+TELEMETRY_ID_SCHEMA = 0xff
+TELEMETRY_ID_CLOCK = 0xfe
+
+# Тип значения -> формат struct.
+TELEMETRY_TYPES = {0: 'b', 1: 'B', 2: 'h', 3: 'H', 4: 'i', 5: 'I'}
+
+
+def crc_ccitt_update(crc, data):
+    """Аналог _crc_ccitt_update из avr-libc."""
+    data ^= crc & 0xff
+    data = (data ^ (data << 4)) & 0xff
+    return (((data << 8) | (crc >> 8)) ^ (data >> 4) ^ (data << 3)) & 0xffff
+
+
+def slip_frames(stream):
+    """Разбирает поток SLIP, возвращает данные кадров с верной CRC."""
+    frame = bytearray()
+    escape = False
+    discard = False
+    errors = 0
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        for byte in chunk:
+            if byte == SLIP_END:
+                if frame or discard:
+                    crc = 0xffff
+                    for b in frame:
+                        crc = crc_ccitt_update(crc, b)
+                    if not discard and not escape and len(frame) > 2 and crc == 0:
+                        yield bytes(frame[:-2])
+                    else:
+                        errors += 1
+                frame = bytearray()
+                escape = False
+                discard = False
+            elif discard:
+                continue
+            elif escape:
+                escape = False
+                if byte == SLIP_ESC_END:
+                    frame.append(SLIP_END)
+                elif byte == SLIP_ESC_ESC:
+                    frame.append(SLIP_ESC)
+                else:
+                    discard = True
+            elif byte == SLIP_ESC:
+                escape = True
+            else:
+                frame.append(byte)
+    if errors:
+        sys.stderr.write('telemetry_decode: %d bad frames\n' % errors)
+
+
+class Decoder(object):
+    def __init__(self, writer):
+        self.writer = writer
+        self.channels = {}
+        self.ticks_per_sec = None
+
+    def record(self, data):
+        rec_id = data[0]
+        if rec_id == TELEMETRY_ID_SCHEMA and len(data) >= 5:
+            ch_id, ch_type, fract_bits, count = data[1:5]
+            if ch_type not in TELEMETRY_TYPES:
+                return
+            name = data[5:].decode('ascii', 'replace') or str(ch_id)
+            self.channels[ch_id] = (name, '<%d%s' % (count, TELEMETRY_TYPES[ch_type]), fract_bits)
+        elif rec_id == TELEMETRY_ID_CLOCK and len(data) == 5:
+            self.ticks_per_sec = struct.unpack_from('<I', data, 1)[0] or None
+        elif rec_id in self.channels and len(data) >= 5:
+            name, fmt, fract_bits = self.channels[rec_id]
+            if len(data) != 5 + struct.calcsize(fmt):
+                return
+            ticks = struct.unpack_from('<I', data, 1)[0]
+            values = struct.unpack_from(fmt, data, 5)
+            if fract_bits:
+                values = ['%.*f' % (len(str(1 << fract_bits)), v / float(1 << fract_bits)) for v in values]
+            seconds = '%.6f' % (ticks / float(self.ticks_per_sec)) if self.ticks_per_sec else ''
+            self.writer.writerow([ticks, seconds, name] + list(values))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert a telemetry stream to CSV.')
+    parser.add_argument('input', nargs='?', help='captured stream, stdin by default')
+    parser.add_argument('-o', '--output', help='CSV file, stdout by default')
+    args = parser.parse_args()
+
+    stream = open(args.input, 'rb') if args.input else sys.stdin.buffer
+    out = open(args.output, 'w', newline='') if args.output else sys.stdout
+
+    decoder = Decoder(csv.writer(out))
+    for frame in slip_frames(stream):
+        decoder.record(frame)
+    out.flush()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,189 @@
+/**
+ * Тест телеметрии на ПК: поток кодера декодируется
+ * декодером для ПК telemetry_decode.py, результат
+ * сравнивается с ожидаемым CSV.
+ * Сборка и запуск: make -C host test (требуется python3).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "telemetry/telemetry.h"
+#include "counter/counter.h"
+#include "uart_host.h"
+#include "test.h"
+
+
+//! Путь к декодеру.
+#ifndef TELEMETRY_DECODE
+#define TELEMETRY_DECODE "../telemetry/telemetry_decode.py"
+#endif
+
+//! Файл потока телеметрии.
+#ifndef TELEMETRY_STREAM
+#define TELEMETRY_STREAM "build/test_telemetry.bin"
+#endif
+
+//! Частота системного счётчика.
+#define TEST_TICKS_PER_SEC 1000
+
+//! Число записей каждого канала.
+#define TEST_RECORDS 20
+
+//! Идентификаторы каналов.
+#define TEST_ID_ACCEL 1
+#define TEST_ID_TEMP  2
+#define TEST_ID_ADC   3
+
+static const telemetry_channel_t test_channels[] = {
+    {TEST_ID_ACCEL, TELEMETRY_TYPE_INT(TELEMETRY_TYPE_INT16), 3, "accel"},
+    {TEST_ID_TEMP, TELEMETRY_TYPE_FIXED16, 1, "temp"},
+    {TEST_ID_ADC, TELEMETRY_TYPE_INT(TELEMETRY_TYPE_UINT32), 2, "adc"},
+};
+
+static uint8_t test_rx_buf[16];
+static uint8_t test_tx_buf[512];
+
+//! Ожидаемый CSV.
+static char test_expected[16384];
+static size_t test_expected_size;
+
+//! CSV декодера.
+static char test_decoded[16384];
+
+
+/**
+ * Передаёт содержимое буфера записи UART в файл потока.
+ * @param f Файл потока.
+ */
+static void test_flush(FILE* f)
+{
+    uint8_t data[sizeof(test_tx_buf)];
+    size_t size;
+    
+    size = uart_host_transmit(data, sizeof(data));
+    fwrite(data, 1, size, f);
+}
+
+/**
+ * Добавляет строку к ожидаемому CSV.
+ * @param fmt Формат.
+ */
+#define test_expect(...)\
+                test_expected_size += (size_t)snprintf(test_expected + test_expected_size,\
+                                       sizeof(test_expected) - test_expected_size, __VA_ARGS__)
+
+/**
+ * Добавляет к ожидаемому CSV начало записи канала.
+ * @param name Имя канала.
+ */
+static void test_expect_record(const char* name)
+{
+    uint32_t ticks = system_counter_ticks();
+    
+    test_expect("%lu,%.6f,%s", (unsigned long)ticks, ticks / (double)TEST_TICKS_PER_SEC, name);
+}
+
+/**
+ * Кодирует поток телеметрии в файл и формирует ожидаемый CSV.
+ * @param f Файл потока.
+ */
+static void test_encode(FILE* f)
+{
+    static const uint8_t garbage[] = {0x12, 0xdb, 0x00, 0x34, 0xc0, 0x56, 0x78, 0x9a};
+    int16_t accel[3];
+    fixed16_t temp;
+    uint32_t adc[2];
+    int i, j;
+    
+    // Данные до схемы канала декодером пропускаются.
+    accel[0] = accel[1] = accel[2] = 0;
+    TEST_CHECK_EQ(telemetry_send(TEST_ID_ACCEL, accel), E_NO_ERROR);
+    test_flush(f);
+    
+    telemetry_send_header();
+    test_flush(f);
+    
+    for(i = 0; i < TEST_RECORDS; i ++){
+        for(j = 0; j < 7; j ++) system_counter_tick();
+        
+        for(j = 0; j < 3; j ++) accel[j] = (int16_t)((i - 10) * 1000 + j * 333 - 0xc0);
+        TEST_CHECK_EQ(telemetry_send(TEST_ID_ACCEL, accel), E_NO_ERROR);
+        test_expect_record("accel");
+        test_expect(",%d,%d,%d\r\n", accel[0], accel[1], accel[2]);
+        
+        temp = (fixed16_t)((i - 10) * 37 + 0xdb);
+        TEST_CHECK_EQ(telemetry_send(TEST_ID_TEMP, &temp), E_NO_ERROR);
+        test_expect_record("temp");
+        test_expect(",%.3f\r\n", temp / 256.0);
+        
+        adc[0] = (uint32_t)i * 0x01020304UL + 0xc0dbc0dbUL;
+        adc[1] = 0xffffffffUL - (uint32_t)i;
+        TEST_CHECK_EQ(telemetry_send(TEST_ID_ADC, adc), E_NO_ERROR);
+        test_expect_record("adc");
+        test_expect(",%lu,%lu\r\n", (unsigned long)adc[0], (unsigned long)adc[1]);
+        
+        test_flush(f);
+        
+        // Повреждённые данные между кадрами.
+        if(i == TEST_RECORDS / 2) fwrite(garbage, 1, sizeof(garbage), f);
+    }
+    
+    // Неизвестный канал не передаётся.
+    TEST_CHECK_EQ(telemetry_send(TELEMETRY_ID_MAX, adc), E_INVALID_VALUE);
+    TEST_CHECK_EQ(telemetry_send(TEST_ID_ADC, NULL), E_NULL_POINTER);
+    TEST_CHECK_EQ(uart_host_transmit(NULL, 0), 0);
+}
+
+/**
+ * Декодирует поток декодером для ПК.
+ * @return Размер полученного CSV.
+ */
+static size_t test_decode(void)
+{
+    FILE* p;
+    size_t size;
+    
+    p = popen("python3 " TELEMETRY_DECODE " " TELEMETRY_STREAM " 2>/dev/null", "r");
+    if(p == NULL) return 0;
+    
+    size = fread(test_decoded, 1, sizeof(test_decoded) - 1, p);
+    test_decoded[size] = '\0';
+    
+    TEST_CHECK_EQ(pclose(p), 0);
+    
+    return size;
+}
+
+int main(void)
+{
+    FILE* f;
+    size_t size;
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    system_counter_init(TEST_TICKS_PER_SEC);
+    
+    TEST_CHECK_EQ(telemetry_init(NULL, 0), E_NULL_POINTER);
+    TEST_CHECK_EQ(telemetry_dev_init(NULL, test_channels, 1), E_NULL_POINTER);
+    TEST_CHECK_EQ(telemetry_dev_init(UART0, test_channels, sizeof(test_channels) / sizeof(test_channels[0])), E_NO_ERROR);
+    
+    f = fopen(TELEMETRY_STREAM, "wb");
+    TEST_CHECK(f != NULL);
+    if(f == NULL) return test_result("test_telemetry");
+    
+    test_encode(f);
+    fclose(f);
+    
+    size = test_decode();
+    
+    TEST_CHECK_EQ(size, test_expected_size);
+    TEST_CHECK(strcmp(test_decoded, test_expected) == 0);
+    
+    if(strcmp(test_decoded, test_expected) != 0){
+        fprintf(stderr, "expected:\n%s\ndecoded:\n%s\n", test_expected, test_decoded);
+    }
+    
+    return test_result("test_telemetry");
+}
@@ -0,0 +1,162 @@
+/**
+ * Бенчмарк форматированного вывода uart_print на ПК.
+ * Сравнивает вывод строки телеметрии функциями uart_print
+ * с форматированием snprintf и помещением результата
+ * в буфер записи UART целиком (uart_write)
+ * и посимвольно (uart_put, как при выводе printf через UART_STDIO).
+ *
+ * Время и такты измеряются на процессоре ПК и показывают
+ * только соотношение вариантов; размер кода во флеш-памяти
+ * измеряется при сборке для МК (avr-size).
+ * Сборка и запуск: make -C host bench.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "uart/uart_print.h"
+#include "uart_host.h"
+#include "bench.h"
+
+
+//! Число выводимых строк в каждом измерении.
+#define BENCH_LINES (256UL * 1024)
+
+//! Максимальный размер строки.
+#define BENCH_LINE_MAX 64
+
+static uint8_t bench_rx_buf[16];
+static uint8_t bench_tx_buf[256];
+
+
+/**
+ * Выводит строку функциями uart_print.
+ * @param n Номер строки.
+ */
+static void bench_line_print(uint32_t n)
+{
+    uart_print_str("t=");
+    uart_print_uint(n);
+    uart_print_str(" ax=");
+    uart_print_int(-(int32_t)(n & 0x3fff));
+    uart_print_str(" T=");
+    uart_print_fixed16((fixed16_t)(n & 0x1fff), 2);
+    uart_print_str(" id=0x");
+    uart_print_hex(n & 0xffff, 4);
+    uart_print_eol();
+}
+
+/**
+ * Форматирует строку функцией snprintf.
+ * @param buf Буфер строки.
+ * @param n Номер строки.
+ * @return Размер строки.
+ */
+static size_t bench_line_format(char* buf, uint32_t n)
+{
+    fixed16_t t = (fixed16_t)(n & 0x1fff);
+    // Дробная часть с округлением до двух знаков, как в uart_print_fixed.
+    uint32_t t_int = t >> FIXED16_FRACT_BITS;
+    uint32_t t_fract = ((uint32_t)(t & 0xff) * 100 + 0x80) >> FIXED16_FRACT_BITS;
+    
+    if(t_fract >= 100){
+        t_fract -= 100;
+        t_int ++;
+    }
+    
+    return (size_t)snprintf(buf, BENCH_LINE_MAX, "t=%lu ax=%ld T=%lu.%02lu id=0x%04lx\r\n",
+                            (unsigned long)n, -(long)(n & 0x3fff),
+                            (unsigned long)t_int, (unsigned long)t_fract,
+                            (unsigned long)(n & 0xffff));
+}
+
+/**
+ * Выводит строку через snprintf и uart_write.
+ * @param n Номер строки.
+ */
+static void bench_line_snprintf(uint32_t n)
+{
+    char buf[BENCH_LINE_MAX];
+    
+    uart_write(buf, bench_line_format(buf, n));
+}
+
+/**
+ * Выводит строку через snprintf и посимвольно uart_put.
+ * @param n Номер строки.
+ */
+static void bench_line_snprintf_put(uint32_t n)
+{
+    char buf[BENCH_LINE_MAX];
+    size_t i, size;
+    
+    size = bench_line_format(buf, n);
+    
+    for(i = 0; i < size; i ++) uart_put((uint8_t)buf[i]);
+}
+
+/**
+ * Проверяет совпадение вывода uart_print и snprintf.
+ * @return Флаг совпадения.
+ */
+static bool bench_check(void)
+{
+    uint8_t a[BENCH_LINE_MAX], b[BENCH_LINE_MAX];
+    size_t a_size, b_size;
+    uint32_t n;
+    
+    for(n = 0; n < 100000; n += 997){
+        bench_line_print(n);
+        a_size = uart_host_transmit(a, sizeof(a));
+        bench_line_snprintf(n);
+        b_size = uart_host_transmit(b, sizeof(b));
+        
+        if(a_size != b_size || memcmp(a, b, a_size) != 0){
+            fprintf(stderr, "bench_uart_print: output mismatch at %lu: %.*s / %.*s\n",
+                    (unsigned long)n, (int)a_size, a, (int)b_size, b);
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * Измеряет вывод строк.
+ * @param line Функция вывода строки.
+ * @param name Имя случая.
+ */
+static void bench_lines(void (*line)(uint32_t), const char* name)
+{
+    uint64_t t_line = 0, c_line = 0, t, c;
+    uint64_t bytes = 0;
+    uint32_t n;
+    
+    for(n = 0; n < BENCH_LINES; n ++){
+        t = bench_now_ns();
+        c = bench_now_cycles();
+        line(n);
+        c_line += bench_now_cycles() - c;
+        t_line += bench_now_ns() - t;
+        
+        bytes += uart_host_transmit(NULL, 0);
+    }
+    
+    bench_report_cycles("uart_print", name, sizeof(bench_tx_buf), BENCH_LINES, bytes, t_line, c_line);
+}
+
+int main(void)
+{
+    uart_host_init(bench_rx_buf, sizeof(bench_rx_buf), bench_tx_buf, sizeof(bench_tx_buf));
+    
+    if(!bench_check()) return 1;
+    
+    bench_header();
+    
+    bench_lines(bench_line_print, "uart_print_line");
+    bench_lines(bench_line_snprintf, "snprintf_write_line");
+    bench_lines(bench_line_snprintf_put, "snprintf_put_line");
+    
+    return 0;
+}
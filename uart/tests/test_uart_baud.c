@@ -0,0 +1,211 @@
+/**
+ * Тесты вычисления параметров скорости передачи UART на ПК.
+ * Значения UBRR и U2X сверяются с таблицами технического описания
+ * ATmega16 для частот 8 и 16 МГц, вычисления во время выполнения
+ * (uart_calc_baud) - с вычислениями при компиляции (UART_BAUD_VALUE).
+ * Собирается для каждой частоты F_CPU.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include "uart/uart.h"
+#include "test.h"
+
+
+/**
+ * Строка таблицы скоростей.
+ */
+typedef struct _Test_Baud {
+    //! Скорость передачи, гектабод.
+    uint16_t hbaud;
+    //! UBRR и отклонение (0.1%) из технического описания без U2X.
+    uint16_t ubrr;
+    int16_t error;
+    //! UBRR и отклонение (0.1%) из технического описания с U2X.
+    uint16_t ubrr_2x;
+    int16_t error_2x;
+    //! Значения, вычисленные при компиляции.
+    uart_baud_t value;
+    bool valid;
+}test_baud_t;
+
+//! Строка таблицы скоростей с вычисленными при компиляции значениями.
+#define TEST_BAUD(hbaud, ubrr, error, ubrr_2x, error_2x)\
+            {hbaud, ubrr, error, ubrr_2x, error_2x,\
+             {UART_BAUD_UBRR(hbaud), UART_BAUD_U2X(hbaud), UART_BAUD_ERROR(hbaud)},\
+             UART_BAUD_VALID(hbaud)}
+
+//! Наибольшее значение UBRR.
+#define TEST_UBRR_MAX 4095
+
+//! Отсутствующее в таблице значение.
+#define TEST_NONE 0xffff
+
+/*
+ * Таблицы "Examples of UBRR Settings" технического описания ATmega16.
+ */
+#if F_CPU == 16000000UL
+static const test_baud_t test_bauds[] = {
+    TEST_BAUD(24,    416,  -1,   832,   0),
+    TEST_BAUD(48,    207,   2,   416,  -1),
+    TEST_BAUD(96,    103,   2,   207,   2),
+    TEST_BAUD(144,    68,   6,   138,  -1),
+    TEST_BAUD(192,    51,   2,   103,   2),
+    TEST_BAUD(288,    34,  -8,    68,   6),
+    TEST_BAUD(384,    25,   2,    51,   2),
+    TEST_BAUD(576,    16,  21,    34,  -8),
+    TEST_BAUD(768,    12,   2,    25,   2),
+    TEST_BAUD(1152,    8, -35,    16,  21),
+    TEST_BAUD(2304,    3,  85,     8, -35),
+    TEST_BAUD(2500,    3,   0,     7,   0),
+    TEST_BAUD(5000,    1,   0,     3,   0),
+    TEST_BAUD(10000,   0,   0,     1,   0),
+};
+#elif F_CPU == 8000000UL
+static const test_baud_t test_bauds[] = {
+    TEST_BAUD(24,    207,   2,   416,  -1),
+    TEST_BAUD(48,    103,   2,   207,   2),
+    TEST_BAUD(96,     51,   2,   103,   2),
+    TEST_BAUD(144,    34,  -8,    68,   6),
+    TEST_BAUD(192,    25,   2,    51,   2),
+    TEST_BAUD(288,    16,  21,    34,  -8),
+    TEST_BAUD(384,    12,   2,    25,   2),
+    TEST_BAUD(576,     8, -35,    16,  21),
+    TEST_BAUD(768,     6, -70,    12,   2),
+    TEST_BAUD(1152,    3,  85,     8, -35),
+    TEST_BAUD(2304,    1,  85,     3,  85),
+    TEST_BAUD(2500,    1,   0,     3,   0),
+    TEST_BAUD(5000,    0,   0,     1,   0),
+    TEST_BAUD(10000, TEST_NONE, 0,  0,   0),
+};
+#endif
+
+//! Число строк таблицы.
+#define TEST_BAUDS_COUNT (sizeof(test_bauds) / sizeof(test_bauds[0]))
+
+
+/**
+ * Получает модуль числа.
+ * @param value Число.
+ * @return Модуль.
+ */
+static int test_abs(int value)
+{
+    return value < 0 ? -value : value;
+}
+
+//! Сверка с техническим описанием.
+static void test_datasheet(void)
+{
+    const test_baud_t* t;
+    uart_baud_t baud;
+    uint16_t ubrr;
+    int16_t error;
+    size_t i;
+    
+    for(i = 0; i < TEST_BAUDS_COUNT; i ++){
+        t = &test_bauds[i];
+        
+        TEST_CHECK_EQ(uart_calc_baud(t->hbaud, &baud), E_NO_ERROR);
+        
+        ubrr = baud.u2x ? t->ubrr_2x : t->ubrr;
+        error = baud.u2x ? t->error_2x : t->error;
+        
+        TEST_CHECK_EQ(baud.ubrr, ubrr);
+        // Отклонение в таблице округлено до 0.1%.
+        TEST_CHECK(test_abs(baud.error - error * 10) <= 10);
+        
+        // Выбран режим с меньшим отклонением, при равном - без U2X.
+        if(baud.u2x){
+            TEST_CHECK(t->ubrr == TEST_NONE || test_abs(t->error_2x) <= test_abs(t->error));
+        }else{
+            TEST_CHECK(test_abs(t->error) <= test_abs(t->error_2x));
+        }
+        
+        if(baud.ubrr != ubrr){
+            fprintf(stderr, "F_CPU %lu, %u00 baud: ubrr %u u2x %u error %d\n",
+                    (unsigned long)F_CPU, t->hbaud, baud.ubrr, baud.u2x, baud.error);
+        }
+    }
+}
+
+//! Совпадение вычислений во время выполнения и при компиляции.
+static void test_compile_time(void)
+{
+    static const uart_baud_t value_96 = UART_BAUD_VALUE(96);
+    static const uart_baud_t value_384 = UART_BAUD_VALUE(384);
+    const test_baud_t* t;
+    uart_baud_t baud;
+    size_t i;
+    
+    for(i = 0; i < TEST_BAUDS_COUNT; i ++){
+        t = &test_bauds[i];
+        
+        TEST_CHECK_EQ(uart_calc_baud(t->hbaud, &baud), E_NO_ERROR);
+        
+        TEST_CHECK_EQ(baud.ubrr, t->value.ubrr);
+        TEST_CHECK_EQ(baud.u2x, t->value.u2x);
+        TEST_CHECK_EQ(baud.error, t->value.error);
+        
+        // Допустимость по UART_BAUD_ERROR_MAX.
+        TEST_CHECK_EQ(t->valid, test_abs(baud.error) <= UART_BAUD_ERROR_MAX);
+    }
+    
+    // Допустимые скорости собираются с проверкой при компиляции.
+    TEST_CHECK_EQ(uart_calc_baud(96, &baud), E_NO_ERROR);
+    TEST_CHECK_EQ(baud.ubrr, value_96.ubrr);
+    TEST_CHECK_EQ(baud.u2x, value_96.u2x);
+    TEST_CHECK_EQ(baud.error, value_96.error);
+    
+    TEST_CHECK_EQ(uart_calc_baud(384, &baud), E_NO_ERROR);
+    TEST_CHECK_EQ(baud.ubrr, value_384.ubrr);
+    TEST_CHECK_EQ(baud.u2x, value_384.u2x);
+    TEST_CHECK_EQ(baud.error, value_384.error);
+}
+
+//! Вычисление по длительности бита и ошибки.
+static void test_clocks(void)
+{
+    uart_baud_t baud;
+    size_t i;
+    
+    // Длительность бита, кратная делителю, - без отклонения.
+    for(i = 0; i < TEST_BAUDS_COUNT; i ++){
+        if(F_CPU % ((uint32_t)test_bauds[i].hbaud * 100) != 0) continue;
+        
+        TEST_CHECK_EQ(uart_calc_baud_clocks(F_CPU / ((uint32_t)test_bauds[i].hbaud * 100), &baud), E_NO_ERROR);
+        TEST_CHECK_EQ(baud.ubrr, test_bauds[i].value.ubrr);
+        TEST_CHECK_EQ(baud.u2x, test_bauds[i].value.u2x);
+        TEST_CHECK_EQ(baud.error, 0);
+    }
+    
+    // Наибольший делитель.
+    TEST_CHECK_EQ(uart_calc_baud_clocks((uint32_t)(TEST_UBRR_MAX + 1) * 16, &baud), E_NO_ERROR);
+    TEST_CHECK_EQ(baud.ubrr, TEST_UBRR_MAX);
+    TEST_CHECK(!baud.u2x);
+    TEST_CHECK_EQ(baud.error, 0);
+    
+    // Наименьший делитель.
+    TEST_CHECK_EQ(uart_calc_baud_clocks(8, &baud), E_NO_ERROR);
+    TEST_CHECK_EQ(baud.ubrr, 0);
+    TEST_CHECK(baud.u2x);
+    
+    TEST_CHECK_EQ(uart_calc_baud_clocks(0, &baud), E_UART_INVALID_BAUD);
+    TEST_CHECK_EQ(uart_calc_baud_clocks(3, &baud), E_UART_INVALID_BAUD);
+    TEST_CHECK_EQ(uart_calc_baud_clocks((uint32_t)(TEST_UBRR_MAX + 1) * 16 + 9, &baud), E_UART_INVALID_BAUD);
+    TEST_CHECK_EQ(uart_calc_baud_clocks(16, NULL), E_NULL_POINTER);
+    
+    TEST_CHECK_EQ(uart_calc_baud(0, &baud), E_UART_INVALID_BAUD);
+    TEST_CHECK_EQ(uart_calc_baud(96, NULL), E_NULL_POINTER);
+}
+
+int main(void)
+{
+    test_datasheet();
+    test_compile_time();
+    test_clocks();
+    
+    return test_result(F_CPU == 8000000UL ? "test_uart_baud_8mhz" : "test_uart_baud_16mhz");
+}
@@ -0,0 +1,188 @@
+/**
+ * Тесты аппаратного управления потоком UART (RTS/CTS) на ПК.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "uart/uart.h"
+#include "ports/ports.h"
+#include "uart_host.h"
+#include "test.h"
+
+
+//! Размер буфера чтения.
+#define TEST_RX_SIZE 16
+
+//! Пороги RTS.
+#define TEST_RTS_HIGH 12
+#define TEST_RTS_LOW  4
+
+//! Пины RTS и CTS.
+#define TEST_RTS_PIN 4
+#define TEST_CTS_PIN 5
+
+static uint8_t test_rx_buf[TEST_RX_SIZE];
+static uint8_t test_tx_buf[32];
+
+
+/**
+ * Получает состояние линии RTS.
+ * @return Флаг установленного RTS (ноль на линии).
+ */
+static bool test_rts_asserted(void)
+{
+    return !BIT_VALUE(PORTD, TEST_RTS_PIN);
+}
+
+/**
+ * Принимает байты в буфер чтения UART.
+ * @param count Число байт.
+ */
+static void test_receive(size_t count)
+{
+    uint8_t data = 0;
+    
+    while(count --){
+        uart_host_receive(&data, 1);
+        data ++;
+    }
+}
+
+//! Гистерезис RTS при чтении.
+static void test_rts_read(void)
+{
+    uint8_t data[TEST_RX_SIZE];
+    size_t i;
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    TEST_CHECK_EQ(uart_set_rts(PORT_D, TEST_RTS_PIN, 0, 0), E_INVALID_VALUE);
+    TEST_CHECK_EQ(uart_set_rts(PORT_D, TEST_RTS_PIN, TEST_RX_SIZE + 1, 0), E_INVALID_VALUE);
+    TEST_CHECK_EQ(uart_set_rts(PORT_D, TEST_RTS_PIN, TEST_RTS_LOW, TEST_RTS_LOW), E_INVALID_VALUE);
+    TEST_CHECK_EQ(uart_set_rts(PORT_D, TEST_RTS_PIN, TEST_RTS_HIGH, TEST_RTS_LOW), E_NO_ERROR);
+    
+    // Буфер пуст - приём разрешён.
+    TEST_CHECK(BIT_VALUE(DDRD, TEST_RTS_PIN));
+    TEST_CHECK(test_rts_asserted());
+    
+    // До верхнего порога RTS установлен.
+    test_receive(TEST_RTS_HIGH - 1);
+    TEST_CHECK(test_rts_asserted());
+    
+    // Верхний порог - RTS снимается прерыванием приёма.
+    test_receive(1);
+    TEST_CHECK(!test_rts_asserted());
+    test_receive(2);
+    TEST_CHECK(!test_rts_asserted());
+    TEST_CHECK_EQ(uart_data_avail(), TEST_RTS_HIGH + 2);
+    
+    // Выше нижнего порога RTS остаётся снятым.
+    for(i = uart_data_avail(); i > TEST_RTS_LOW + 1; i --){
+        TEST_CHECK_EQ(uart_get(data), 1);
+        TEST_CHECK(!test_rts_asserted());
+    }
+    
+    // Нижний порог - RTS устанавливается.
+    TEST_CHECK_EQ(uart_read(data, 1), 1);
+    TEST_CHECK_EQ(uart_data_avail(), TEST_RTS_LOW);
+    TEST_CHECK(test_rts_asserted());
+    
+    // Снова до верхнего порога.
+    test_receive(TEST_RTS_HIGH - TEST_RTS_LOW);
+    TEST_CHECK(!test_rts_asserted());
+    
+    TEST_CHECK_EQ(uart_read(data, TEST_RTS_HIGH - TEST_RTS_LOW - 1), TEST_RTS_HIGH - TEST_RTS_LOW - 1);
+    TEST_CHECK(!test_rts_asserted());
+    TEST_CHECK_EQ(uart_read(data, sizeof(data)), TEST_RTS_LOW + 1);
+    TEST_CHECK(test_rts_asserted());
+    
+    uart_flow_control_disable();
+    TEST_CHECK(!uart_rts_asserted());
+}
+
+//! Гистерезис RTS при извлечении через peek_region/consume.
+static void test_rts_consume(void)
+{
+    const uint8_t* ptr;
+    size_t n;
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    TEST_CHECK_EQ(uart_set_rts(PORT_D, TEST_RTS_PIN, TEST_RTS_HIGH, TEST_RTS_LOW), E_NO_ERROR);
+    
+    test_receive(TEST_RX_SIZE);
+    TEST_CHECK(!test_rts_asserted());
+    
+    // Непрерывная область может быть короче данных.
+    n = uart_peek_region(&ptr);
+    TEST_CHECK(n != 0);
+    
+    TEST_CHECK_EQ(uart_consume(TEST_RX_SIZE - TEST_RTS_LOW - 1), TEST_RX_SIZE - TEST_RTS_LOW - 1);
+    TEST_CHECK(!test_rts_asserted());
+    TEST_CHECK_EQ(uart_consume(1), 1);
+    TEST_CHECK(test_rts_asserted());
+    
+    uart_flow_control_disable();
+}
+
+//! Приостановка передачи по CTS.
+static void test_cts(void)
+{
+    static const uint8_t data[] = {0x10, 0x20, 0x30};
+    uint8_t out[sizeof(data)];
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    // CTS снят - единица на линии.
+    BIT_ON(PIND, TEST_CTS_PIN);
+    TEST_CHECK_EQ(uart_set_cts(PORT_D, TEST_CTS_PIN), E_NO_ERROR);
+    TEST_CHECK(!BIT_VALUE(DDRD, TEST_CTS_PIN));
+    
+    TEST_CHECK_EQ(uart_write(data, sizeof(data)), sizeof(data));
+    
+    // Прерывание не загружает UDR и запрещает себя.
+    UDR = 0;
+    TEST_CHECK_EQ(uart_host_transmit(out, sizeof(out)), 0);
+    TEST_CHECK_EQ(UDR, 0);
+    TEST_CHECK(!BIT_VALUE(UCSRB, UDRIE));
+    
+    // Изменение без установки CTS не разрешает передачу.
+    uart_cts_changed();
+    TEST_CHECK(!BIT_VALUE(UCSRB, UDRIE));
+    
+    // CTS установлен - uart_cts_changed() разрешает прерывание.
+    BIT_OFF(PIND, TEST_CTS_PIN);
+    uart_cts_changed();
+    TEST_CHECK(BIT_VALUE(UCSRB, UDRIE));
+    
+    TEST_CHECK_EQ(uart_host_transmit(out, sizeof(out)), sizeof(data));
+    TEST_CHECK(memcmp(out, data, sizeof(data)) == 0);
+    
+    // Пустой буфер - прерывание не разрешается.
+    uart_cts_changed();
+    TEST_CHECK(!BIT_VALUE(UCSRB, UDRIE));
+    
+    // Снятие CTS посреди передачи.
+    TEST_CHECK_EQ(uart_write(data, sizeof(data)), sizeof(data));
+    USART_UDRE_vect();
+    TEST_CHECK_EQ(UDR, data[0]);
+    BIT_ON(PIND, TEST_CTS_PIN);
+    TEST_CHECK_EQ(uart_host_transmit(out, sizeof(out)), 0);
+    TEST_CHECK_EQ(UDR, data[0]);
+    
+    // Отключение управления потоком возобновляет передачу.
+    uart_flow_control_disable();
+    TEST_CHECK_EQ(uart_host_transmit(out, sizeof(out)), sizeof(data) - 1);
+    TEST_CHECK_EQ(out[0], data[1]);
+    TEST_CHECK_EQ(out[1], data[2]);
+}
+
+int main(void)
+{
+    test_rts_read();
+    test_rts_consume();
+    test_cts();
+    
+    return test_result("test_uart_flow");
+}
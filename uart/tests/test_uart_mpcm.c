@@ -0,0 +1,215 @@
+/**
+ * Тесты режима мультипроцессорного обмена UART (MPCM) на ПК.
+ * Собирается с UART_RS485: узлы с адресами работают
+ * на общей шине RS-485.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "uart/uart.h"
+#include "ports/ports.h"
+#include "uart_host.h"
+#include "test.h"
+
+
+//! Адрес узла.
+#define TEST_ADDRESS   0x21
+//! Широковещательный адрес.
+#define TEST_BROADCAST 0xff
+//! Адрес другого узла.
+#define TEST_OTHER     0x42
+
+//! Пин DE.
+#define TEST_DE_PIN 2
+
+static uint8_t test_rx_buf[32];
+static uint8_t test_tx_buf[32];
+
+//! Результат передачи адреса в потоке.
+static volatile err_t test_send_err;
+
+
+/**
+ * Принимает байт адреса или данных.
+ * @param data Байт.
+ * @param address Флаг байта адреса (9й бит).
+ */
+static void test_receive(uint8_t data, bool address)
+{
+    BIT_SET(UCSRB, RXB8, address);
+    uart_host_receive(&data, 1);
+    BIT_OFF(UCSRB, RXB8);
+}
+
+/**
+ * Передаёт данные из буфера записи,
+ * проверяя сброс 9го бита у каждого байта данных.
+ * @param data Буфер для переданных данных.
+ * @param size Размер буфера.
+ * @return Число переданных байт.
+ */
+static size_t test_transmit(uint8_t* data, size_t size)
+{
+    size_t n = 0;
+    
+    while(BIT_VALUE(UCSRB, UDRIE)){
+        USART_UDRE_vect();
+        if(!BIT_VALUE(UCSRB, UDRIE)) break;
+        TEST_CHECK(!BIT_VALUE(UCSRB, TXB8));
+        if(n < size) data[n] = UDR;
+        n ++;
+    }
+    
+    return n;
+}
+
+/**
+ * Поток передачи адреса.
+ * @param arg Не используется.
+ * @return NULL.
+ */
+static void* test_send_thread(void* arg)
+{
+    (void)arg;
+    
+    test_send_err = uart_send_address(TEST_OTHER);
+    
+    return NULL;
+}
+
+//! Установка MPCM сохраняет остальные биты UCSRA.
+static void test_mpcm_bits(void)
+{
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    // Режим удвоения скорости, передатчик свободен,
+    // флаг окончания передачи не обработан.
+    UCSRA = BIT(U2X) | BIT(UDRE) | BIT(TXC);
+    BIT_ON(UCSRB, TXB8);
+    
+    uart_set_address(TEST_ADDRESS, TEST_BROADCAST);
+    
+    TEST_CHECK(BIT_VALUE(UCSRA, MPCM));
+    TEST_CHECK(BIT_VALUE(UCSRA, U2X));
+    TEST_CHECK(BIT_VALUE(UCSRA, UDRE));
+    // TXC сбрасывается записью единицы - записан ноль.
+    TEST_CHECK(!BIT_VALUE(UCSRA, TXC));
+    TEST_CHECK(BIT_VALUE(UCSRB, UCSZ2));
+    TEST_CHECK(!BIT_VALUE(UCSRB, TXB8));
+    TEST_CHECK_EQ(uart_rx_address(), TEST_ADDRESS);
+    
+    // Приём своего адреса снимает MPCM, не сбрасывая TXC.
+    BIT_ON(UCSRA, TXC);
+    test_receive(TEST_ADDRESS, true);
+    TEST_CHECK(!BIT_VALUE(UCSRA, MPCM));
+    TEST_CHECK(BIT_VALUE(UCSRA, U2X));
+    TEST_CHECK(!BIT_VALUE(UCSRA, TXC));
+    
+    // Чужой адрес снова включает MPCM.
+    BIT_ON(UCSRA, TXC);
+    test_receive(TEST_OTHER, true);
+    TEST_CHECK(BIT_VALUE(UCSRA, MPCM));
+    TEST_CHECK(BIT_VALUE(UCSRA, U2X));
+    TEST_CHECK(!BIT_VALUE(UCSRA, TXC));
+    
+    // Выключение режима.
+    uart_address_disable();
+    TEST_CHECK(!BIT_VALUE(UCSRA, MPCM));
+    TEST_CHECK(BIT_VALUE(UCSRA, U2X));
+    TEST_CHECK(!BIT_VALUE(UCSRB, UCSZ2));
+}
+
+//! Приём: байты адреса отбрасываются, данные принимаются по своему адресу.
+static void test_mpcm_receive(void)
+{
+    uint8_t data[4];
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    uart_set_address(TEST_ADDRESS, TEST_BROADCAST);
+    
+    test_receive(TEST_ADDRESS, true);
+    test_receive(0x11, false);
+    test_receive(0x12, false);
+    TEST_CHECK_EQ(uart_rx_address(), TEST_ADDRESS);
+    
+    // Широковещательное сообщение.
+    test_receive(TEST_BROADCAST, true);
+    TEST_CHECK(!BIT_VALUE(UCSRA, MPCM));
+    test_receive(0x13, false);
+    TEST_CHECK_EQ(uart_rx_address(), TEST_BROADCAST);
+    
+    // Адреса в буфер чтения не попадают.
+    TEST_CHECK_EQ(uart_read(data, sizeof(data)), 3);
+    TEST_CHECK_EQ(data[0], 0x11);
+    TEST_CHECK_EQ(data[1], 0x12);
+    TEST_CHECK_EQ(data[2], 0x13);
+    
+    uart_address_disable();
+}
+
+//! Передача: 9й бит установлен только у байта адреса.
+static void test_mpcm_send(void)
+{
+    static const uint8_t msg[] = {0x31, 0x32, 0x33};
+    uint8_t out[sizeof(msg)];
+    pthread_t thread;
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    TEST_CHECK_EQ(uart_send_address(TEST_OTHER), E_INVALID_VALUE);
+    
+    uart_set_address(TEST_ADDRESS, TEST_BROADCAST);
+    TEST_CHECK_EQ(uart_set_de(PORT_D, TEST_DE_PIN), E_NO_ERROR);
+    
+    // Данные без адреса.
+    TEST_CHECK_EQ(uart_write(msg, sizeof(msg)), sizeof(msg));
+    TEST_CHECK_EQ(test_transmit(out, sizeof(out)), sizeof(msg));
+    USART_TXC_vect();
+    
+    // Заглушка UCSRA хранит записанное значение: сброс TXC
+    // при установке DE обнуляет и UDRE, поэтому передача адреса
+    // останавливается на ожидании UDRE после записи UDR.
+    UDR = 0;
+    BIT_ON(UCSRA, UDRE);
+    test_send_err = E_BUSY;
+    TEST_CHECK_EQ(pthread_create(&thread, NULL, test_send_thread, NULL), 0);
+    
+    while(UDR != TEST_OTHER) sched_yield();
+    
+    // Байт адреса записан с 9м битом при установленном DE.
+    TEST_CHECK(BIT_VALUE(UCSRB, TXB8));
+    TEST_CHECK(BIT_VALUE(PORTD, TEST_DE_PIN));
+    
+    // Байт адреса передан в сдвиговый регистр.
+    BIT_ON(UCSRA, UDRE);
+    pthread_join(thread, NULL);
+    
+    TEST_CHECK_EQ(test_send_err, E_NO_ERROR);
+    TEST_CHECK(!BIT_VALUE(UCSRB, TXB8));
+    TEST_CHECK(BIT_VALUE(UCSRB, TXCIE));
+    TEST_CHECK(BIT_VALUE(PORTD, TEST_DE_PIN));
+    
+    // Данные сообщения - без 9го бита.
+    TEST_CHECK_EQ(uart_write(msg, sizeof(msg)), sizeof(msg));
+    TEST_CHECK_EQ(test_transmit(out, sizeof(out)), sizeof(msg));
+    TEST_CHECK(memcmp(out, msg, sizeof(msg)) == 0);
+    
+    USART_TXC_vect();
+    TEST_CHECK(!BIT_VALUE(PORTD, TEST_DE_PIN));
+    
+    uart_de_disable();
+    uart_address_disable();
+}
+
+int main(void)
+{
+    test_mpcm_bits();
+    test_mpcm_receive();
+    test_mpcm_send();
+    
+    return test_result("test_uart_mpcm");
+}
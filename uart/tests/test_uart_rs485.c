@@ -0,0 +1,139 @@
+/**
+ * Тесты управления передатчиком RS-485 (DE) UART на ПК.
+ * Прерывания опустошения UDR и окончания передачи
+ * вызываются вручную в порядке работы аппаратуры.
+ * Сборка и запуск: make -C host test.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "uart/uart.h"
+#include "ports/ports.h"
+#include "uart_host.h"
+#include "test.h"
+
+
+//! Пин DE.
+#define TEST_DE_PIN 4
+
+static uint8_t test_rx_buf[16];
+static uint8_t test_tx_buf[16];
+
+
+/**
+ * Получает состояние выхода DE.
+ * Заглушка не связывает PORT и PIN - читается PORT.
+ * @return Флаг установки DE.
+ */
+static bool test_de(void)
+{
+    return BIT_VALUE(PORTD, TEST_DE_PIN);
+}
+
+/**
+ * Передаёт байт из буфера записи в сдвиговый регистр.
+ * @return Флаг наличия байта.
+ */
+static bool test_udre(void)
+{
+    if(!BIT_VALUE(UCSRB, UDRIE)) return false;
+    
+    USART_UDRE_vect();
+    
+    return BIT_VALUE(UCSRB, UDRIE) != 0;
+}
+
+//! DE удерживается до окончания передачи последнего байта.
+static void test_de_until_txc(void)
+{
+    static const uint8_t msg[] = {0x10, 0x20, 0x30};
+    uint8_t out[sizeof(msg)];
+    size_t n = 0;
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    
+    TEST_CHECK_EQ(uart_set_de(PORT_D, TEST_DE_PIN), E_NO_ERROR);
+    TEST_CHECK(BIT_VALUE(DDRD, TEST_DE_PIN));
+    TEST_CHECK(!test_de());
+    TEST_CHECK(!BIT_VALUE(UCSRB, TXCIE));
+    
+    // Флаг TXC от прошлой передачи сбрасывается, U2X сохраняется.
+    UCSRA = BIT(U2X) | BIT(TXC);
+    
+    TEST_CHECK_EQ(uart_write(msg, sizeof(msg)), sizeof(msg));
+    TEST_CHECK(test_de());
+    TEST_CHECK(BIT_VALUE(UCSRA, U2X));
+    // TXC сбрасывается записью единицы.
+    TEST_CHECK(BIT_VALUE(UCSRA, TXC));
+    TEST_CHECK(BIT_VALUE(UCSRB, TXCIE));
+    
+    // Окончание передачи байта при непустом буфере не снимает DE.
+    while(test_udre()){
+        if(n < sizeof(out)) out[n] = UDR;
+        n ++;
+        
+        if(n < sizeof(msg)){
+            USART_TXC_vect();
+            TEST_CHECK(test_de());
+            TEST_CHECK(BIT_VALUE(UCSRB, TXCIE));
+        }
+    }
+    TEST_CHECK_EQ(n, sizeof(msg));
+    TEST_CHECK(memcmp(out, msg, sizeof(msg)) == 0);
+    
+    // Последний байт в сдвиговом регистре - DE установлен.
+    TEST_CHECK(test_de());
+    TEST_CHECK(BIT_VALUE(UCSRB, TXCIE));
+    
+    // Сдвиговый регистр пуст - DE снят.
+    USART_TXC_vect();
+    TEST_CHECK(!test_de());
+    TEST_CHECK(!BIT_VALUE(UCSRB, TXCIE));
+    
+    uart_de_disable();
+}
+
+//! Запись во время передачи продлевает удержание DE.
+static void test_de_append(void)
+{
+    static const uint8_t msg[] = {0x41, 0x42};
+    size_t n = 0;
+    
+    uart_host_init(test_rx_buf, sizeof(test_rx_buf), test_tx_buf, sizeof(test_tx_buf));
+    TEST_CHECK_EQ(uart_set_de(PORT_D, TEST_DE_PIN), E_NO_ERROR);
+    
+    TEST_CHECK_EQ(uart_write(msg, sizeof(msg)), sizeof(msg));
+    while(test_udre()) n ++;
+    
+    // Новые данные до окончания передачи.
+    TEST_CHECK_EQ(uart_write(msg, sizeof(msg)), sizeof(msg));
+    TEST_CHECK(test_de());
+    
+    // TXC за первым сообщением - в буфере есть данные.
+    USART_TXC_vect();
+    TEST_CHECK(test_de());
+    TEST_CHECK(BIT_VALUE(UCSRB, TXCIE));
+    
+    while(test_udre()) n ++;
+    TEST_CHECK_EQ(n, 2 * sizeof(msg));
+    TEST_CHECK(test_de());
+    
+    USART_TXC_vect();
+    TEST_CHECK(!test_de());
+    
+    // Без DE пин не управляется.
+    uart_de_disable();
+    TEST_CHECK_EQ(uart_write(msg, sizeof(msg)), sizeof(msg));
+    TEST_CHECK(!test_de());
+    TEST_CHECK(!BIT_VALUE(UCSRB, TXCIE));
+    while(test_udre());
+}
+
+int main(void)
+{
+    test_de_until_txc();
+    test_de_append();
+    
+    return test_result("test_uart_rs485");
+}
@@ -3,8 +3,18 @@
 #include <avr/interrupt.h>
 #include <string.h>
 #include "bits/bits.h"
+#ifdef UART_LOCK_FREE
+#include "buffer/spsc_buffer.h"
+#else
 #include "buffer/circular_buffer.h"
+#endif
 #include "utils/utils.h"
+#if defined(UART_FLOW_CONTROL) || defined(UART_RS485)
+#include "ports/ports.h"
+#endif
+#ifdef UART_ASYNC_WRITE
+#include "future/future.h"
+#endif
 
 
 #ifndef F_CPU
@@ -12,15 +22,8 @@
 #define F_CPU 1000000UL
 #endif
 
-// Предварительно вычисленные значения частоты.
-#define F_CPU_HHZ (F_CPU / 100)
-#define F_CPU_HHZ_DIV16 (F_CPU_HHZ / 16)
-#define F_CPU_HHZ_DIV8 (F_CPU_HHZ / 8)
-
 //! Максимально возвожное значение в регистрах UBRRH:UBRRL.
 #define UART_UBRR_MAX 4095
-//! Порог значения UBRR, после которого используется U2X.
-#define UART_2X_UBRR_MIN 8
 
 //! Зарезервированные/максимальные значения.
 //! Зарезервированное значение режима контроля чётности.
@@ -30,260 +33,979 @@
 //! Максимальное значение числа стоп-бит.
 #define UART_STOP_BITS_MAX        UART_STOP_BITS_2
 
-#ifdef UART_DISABLE_ALL_INTERRUPTS
-#define __uart_rx_interrupts_save_disable() __interrupts_save_disable()
-#define __uart_rx_interrupts_restore() __interrupts_restore()
-#define __uart_tx_interrupts_save_disable() __interrupts_save_disable()
-#define __uart_tx_interrupts_restore() __interrupts_restore()
+//! Имена бит регистров МК с несколькими USART.
+#ifndef RXCIE
+#define RXC     RXC0
+#define TXC     TXC0
+#define UDRE    UDRE0
+#define FE      FE0
+#define DOR     DOR0
+#define PE      UPE0
+#define U2X     U2X0
+#define MPCM    MPCM0
+#define RXCIE   RXCIE0
+#define TXCIE   TXCIE0
+#define UDRIE   UDRIE0
+#define RXEN    RXEN0
+#define TXEN    TXEN0
+#define UCSZ2   UCSZ02
+#define RXB8    RXB80
+#define TXB8    TXB80
+#define UPM1    UPM01
+#define UPM0    UPM00
+#define USBS    USBS0
+#define UCSZ1   UCSZ01
+#define UCSZ0   UCSZ00
+#endif
+
+//! Бит выбора регистра UCSRC, если регистр разделяет адрес с UBRRH.
+#ifdef URSEL
+#define UART_UCSRC_SELECT (1 << URSEL)
+#else
+#define UART_UCSRC_SELECT 0
+#endif
+
+//! Регистры экземпляра UART.
+#define UART_UDR(uart)   (*(uart)->regs->udr)
+#define UART_UCSRA(uart) (*(uart)->regs->ucsra)
+#define UART_UCSRB(uart) (*(uart)->regs->ucsrb)
+#define UART_UCSRC(uart) (*(uart)->regs->ucsrc)
+#define UART_UBRRH(uart) (*(uart)->regs->ubrrh)
+#define UART_UBRRL(uart) (*(uart)->regs->ubrrl)
+
+#ifdef UART_STATISTICS
+//! Начинает измерение времени запрета прерывания передачи.
+#define uart_stat_tx_lock_begin(uart)\
+                uint16_t __uart_tx_lock_time = UART_STATISTICS_TIME()
+//! Завершает измерение времени запрета прерывания передачи.
+#define uart_stat_tx_lock_end(uart)\
+                uart_stat_tx_lock_update(uart, __uart_tx_lock_time)
+#else
+#define uart_stat_tx_lock_begin(uart)
+#define uart_stat_tx_lock_end(uart)
+#endif
+
+#if defined(UART_DISABLE_ALL_INTERRUPTS)
+#define __uart_rx_interrupts_save_disable(uart) __interrupts_save_disable()
+#define __uart_rx_interrupts_restore(uart) __interrupts_restore()
+#define __uart_tx_interrupts_save_disable(uart)\
+                __interrupts_save_disable();\
+                uart_stat_tx_lock_begin(uart)
+#define __uart_tx_interrupts_restore(uart)\
+                uart_stat_tx_lock_end(uart);\
+                __interrupts_restore()
 #else
 //! Сохраняет и запрещает прерывания чтения UART.
-#define __uart_rx_interrupts_save_disable()\
-                register uint8_t __saved_rxcie_ucsrb = BIT_RAW_VALUE(UCSRB, RXCIE);\
-                BIT_OFF(UCSRB, RXCIE)
+#define __uart_rx_interrupts_save_disable(uart)\
+                register uint8_t __saved_rxcie_ucsrb = BIT_RAW_VALUE(UART_UCSRB(uart), RXCIE);\
+                BIT_OFF(UART_UCSRB(uart), RXCIE)
 //! Восстанавливает значение прерывания чтения UART.
-#define __uart_rx_interrupts_restore()\
-                UCSRB |= __saved_rxcie_ucsrb
+#define __uart_rx_interrupts_restore(uart)\
+                UART_UCSRB(uart) |= __saved_rxcie_ucsrb
 //! Сохраняет и запрещает прерывания записи UART.
-#define __uart_tx_interrupts_save_disable()\
-                register uint8_t __saved_udrie_ucsrb = BIT_RAW_VALUE(UCSRB, UDRIE);\
-                BIT_OFF(UCSRB, UDRIE)
+#define __uart_tx_interrupts_save_disable(uart)\
+                register uint8_t __saved_udrie_ucsrb = BIT_RAW_VALUE(UART_UCSRB(uart), UDRIE);\
+                BIT_OFF(UART_UCSRB(uart), UDRIE);\
+                uart_stat_tx_lock_begin(uart)
 //! Восстанавливает значение прерывания записи UART.
-#define __uart_tx_interrupts_restore()\
-                UCSRB |= __saved_udrie_ucsrb
+#define __uart_tx_interrupts_restore(uart)\
+                uart_stat_tx_lock_end(uart);\
+                UART_UCSRB(uart) |= __saved_udrie_ucsrb
+#endif
+
+#ifdef UART_LOCK_FREE
+//! Индексы буферов без блокировок изменяются одной стороной -
+//! при операциях с буферами запрещать прерывания не нужно.
+//! Остальное разделяемое с прерываниями состояние
+//! защищается __uart_*_interrupts_save_disable().
+#define __uart_rx_buffer_save_disable(uart)
+#define __uart_rx_buffer_restore(uart)
+#define __uart_tx_buffer_save_disable(uart)
+#define __uart_tx_buffer_restore(uart)
+#else
+//! Запрещает прерывания чтения UART на время операции с буфером чтения.
+#define __uart_rx_buffer_save_disable(uart) __uart_rx_interrupts_save_disable(uart)
+//! Восстанавливает прерывания чтения UART после операции с буфером чтения.
+#define __uart_rx_buffer_restore(uart) __uart_rx_interrupts_restore(uart)
+//! Запрещает прерывания записи UART на время операции с буфером записи.
+#define __uart_tx_buffer_save_disable(uart) __uart_tx_interrupts_save_disable(uart)
+//! Восстанавливает прерывания записи UART после операции с буфером записи.
+#define __uart_tx_buffer_restore(uart) __uart_tx_interrupts_restore(uart)
+#endif
+
+#ifdef UART_LOCK_FREE
+//! Тип буфера UART.
+typedef spsc_buffer_t uart_buffer_t;
+//! Функции буфера UART.
+#define uart_buffer_valid       spsc_buffer_valid
+#define uart_buffer_size        spsc_buffer_size
+#define uart_buffer_free_size   spsc_buffer_free_size
+#define uart_buffer_avail_size  spsc_buffer_avail_size
+#define uart_buffer_put         spsc_buffer_put
+#define uart_buffer_get         spsc_buffer_get
+#define uart_buffer_write       spsc_buffer_write
+#define uart_buffer_read        spsc_buffer_read
+#define uart_buffer_write_region spsc_buffer_write_region
+#define uart_buffer_commit      spsc_buffer_commit
+#define uart_buffer_peek_region spsc_buffer_peek_region
+#define uart_buffer_consume     spsc_buffer_consume
+#else
+//! Тип буфера UART.
+typedef circular_buffer_t uart_buffer_t;
+//! Функции буфера UART.
+#define uart_buffer_valid       circular_buffer_valid
+#define uart_buffer_size        circular_buffer_size
+#define uart_buffer_free_size   circular_buffer_free_size
+#define uart_buffer_avail_size  circular_buffer_avail_size
+#define uart_buffer_put         circular_buffer_put
+#define uart_buffer_get         circular_buffer_get
+#define uart_buffer_write       circular_buffer_write
+#define uart_buffer_read        circular_buffer_read
+#define uart_buffer_write_region circular_buffer_write_region
+#define uart_buffer_commit      circular_buffer_commit
+#define uart_buffer_peek_region circular_buffer_peek_region
+#define uart_buffer_consume     circular_buffer_consume
+#endif
+
+#if defined(CIRCULAR_BUFFER_WATERMARKS) && !defined(UART_LOCK_FREE)
+//! Пороги заполнения буферов UART доступны.
+#define UART_WATERMARKS
 #endif
 
 //! Структура состояния UART.
 typedef struct _UsartState{
-    circular_buffer_t write_buffer;
-    circular_buffer_t read_buffer;
+    uart_buffer_t write_buffer;
+    uart_buffer_t read_buffer;
     bool data_overrun;
     uart_callback_t on_receive_callback;
+#ifdef UART_WATERMARKS
+    uart_watermark_callback_t read_watermark_callback;
+    uart_watermark_callback_t write_watermark_callback;
+#endif
+#ifdef UART_FLOW_CONTROL
+    pin_t rts_pin;
+    pin_t cts_pin;
+    size_t rts_high;
+    size_t rts_low;
+    bool rts_enabled;
+    bool cts_enabled;
+#endif
+#ifdef UART_FRAME_RECEIVE
+    uart_frame_callback_t on_frame_callback;
+    size_t frame_size;
+    uint8_t frame_delimiter;
+    bool frame_delimiter_enabled;
+    uint8_t frame_idle_ticks;
+    uint8_t frame_idle_counter;
+#endif
+#ifdef UART_ASYNC_WRITE
+    future_t write_future;
+#endif
+#ifdef UART_STATISTICS
+    uart_statistics_t stats;
+#endif
+#ifdef UART_RS485
+    pin_t de_pin;
+    bool de_enabled;
+#endif
+#ifdef UART_MULTIPROCESSOR
+    bool mpcm_enabled;
+    uint8_t mpcm_address;
+    uint8_t mpcm_broadcast;
+    uint8_t mpcm_rx_address;
+#endif
 }uart_state_t;
 
-//! Состояние UART.
-static uart_state_t state;
 
+//! Регистры экземпляра UART.
+typedef struct _UartRegs{
+    volatile uint8_t* udr;
+    volatile uint8_t* ucsra;
+    volatile uint8_t* ucsrb;
+    volatile uint8_t* ucsrc;
+    volatile uint8_t* ubrrh;
+    volatile uint8_t* ubrrl;
+}uart_regs_t;
 
-ISR(USART_UDRE_vect)
+//! Структура экземпляра UART.
+struct _Uart{
+    //! Регистры.
+    const uart_regs_t* regs;
+    //! Состояние.
+    uart_state_t state;
+};
+
+
+#if defined(UDR0)
+//! Регистры UART0.
+static const uart_regs_t uart0_regs = {
+    &UDR0, &UCSR0A, &UCSR0B, &UCSR0C, &UBRR0H, &UBRR0L
+};
+#if defined(USART0_RX_vect)
+#define UART0_RX_vect   USART0_RX_vect
+#define UART0_UDRE_vect USART0_UDRE_vect
+#define UART0_TX_vect   USART0_TX_vect
+#else
+//! Единственный USART с регистрами UART0 (ATmega328P и подобные).
+#define UART0_RX_vect   USART_RX_vect
+#define UART0_UDRE_vect USART_UDRE_vect
+#define UART0_TX_vect   USART_TX_vect
+#endif
+#else
+//! Регистры UART0.
+static const uart_regs_t uart0_regs = {
+    &UDR, &UCSRA, &UCSRB, &UCSRC, &UBRRH, &UBRRL
+};
+#define UART0_RX_vect   USART_RXC_vect
+#define UART0_UDRE_vect USART_UDRE_vect
+#define UART0_TX_vect   USART_TXC_vect
+#endif
+
+uart_t uart0 = {&uart0_regs};
+
+#ifdef UART1
+//! Регистры UART1.
+static const uart_regs_t uart1_regs = {
+    &UDR1, &UCSR1A, &UCSR1B, &UCSR1C, &UBRR1H, &UBRR1L
+};
+
+uart_t uart1 = {&uart1_regs};
+#endif
+
+#ifdef UART_WATERMARKS
+//! Экземпляры UART для поиска по буферу.
+static uart_t* const uart_instances[] = {
+    UART0
+#ifdef UART1
+    ,UART1
+#endif
+};
+
+/**
+ * Каллбэк порогов заполнения буферов UART.
+ * Вызывает каллбэк пользователя соответствующего буфера.
+ * @param buffer Буфер.
+ * @param high Флаг верхнего порога.
+ */
+static void uart_buffer_watermark_callback(circular_buffer_t* buffer, bool high)
+{
+    uart_t* uart;
+    uint8_t i;
+    
+    for(i = 0; i < sizeof(uart_instances) / sizeof(uart_instances[0]); i ++){
+        uart = uart_instances[i];
+        if(buffer == &uart->state.read_buffer){
+            if(uart->state.read_watermark_callback) uart->state.read_watermark_callback(high);
+            break;
+        }
+        if(buffer == &uart->state.write_buffer){
+            if(uart->state.write_watermark_callback) uart->state.write_watermark_callback(high);
+            break;
+        }
+    }
+}
+
+/**
+ * Устанавливает пороги заполнения буфера UART.
+ * @param uart UART.
+ * @param buffer Буфер.
+ * @param high Верхний порог.
+ * @param low Нижний порог.
+ * @param callback Каллбэк пользователя.
+ * @return Код ошибки.
+ */
+static err_t uart_buffer_set_watermarks(uart_t* uart, circular_buffer_t* buffer, size_t high, size_t low,
+                                        uart_watermark_callback_t callback)
+{
+    if(!circular_buffer_valid(buffer)) return E_INVALID_VALUE;
+    if(low >= high || high > circular_buffer_size(buffer)) return E_INVALID_VALUE;
+    
+    if(buffer == &uart->state.read_buffer) uart->state.read_watermark_callback = callback;
+    else uart->state.write_watermark_callback = callback;
+    
+    circular_buffer_set_watermarks(buffer, high, low,
+                                   callback ? uart_buffer_watermark_callback : NULL);
+    
+    return E_NO_ERROR;
+}
+#endif
+
+#ifdef UART_FLOW_CONTROL
+/**
+ * Снимает RTS при заполнении буфера чтения до верхнего порога.
+ * Вызывается из прерывания приёма.
+ * @param uart UART.
+ */
+ALWAYS_INLINE static void uart_rts_update_rx(uart_t* uart)
+{
+    if(uart->state.rts_enabled &&
+       uart_buffer_avail_size(&uart->state.read_buffer) >= uart->state.rts_high){
+        pin_on(&uart->state.rts_pin);
+    }
+}
+
+/**
+ * Устанавливает RTS при освобождении буфера чтения до нижнего порога.
+ * Вызывается после извлечения данных из буфера чтения,
+ * сама запрещает прерывания приёма.
+ * @param uart UART.
+ */
+static void uart_rts_update(uart_t* uart)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    if(uart->state.rts_enabled &&
+       uart_buffer_avail_size(&uart->state.read_buffer) <= uart->state.rts_low){
+        pin_off(&uart->state.rts_pin);
+    }
+    
+    __uart_rx_interrupts_restore(uart);
+}
+
+/**
+ * Получает разрешение передачи от CTS.
+ * @param uart UART.
+ * @return Флаг разрешения передачи.
+ */
+ALWAYS_INLINE static bool uart_cts_asserted(uart_t* uart)
+{
+    return !uart->state.cts_enabled || pin_get_value(&uart->state.cts_pin) == 0;
+}
+#else
+#define uart_rts_update_rx(uart)
+#define uart_rts_update(uart)
+#define uart_cts_asserted(uart) true
+#endif
+
+#ifdef UART_FRAME_RECEIVE
+/**
+ * Завершает текущий принимаемый кадр.
+ * Вызывается при запрещённых прерываниях приёма.
+ * @param uart UART.
+ */
+static void uart_frame_end(uart_t* uart)
+{
+    size_t size = uart->state.frame_size;
+    
+    uart->state.frame_size = 0;
+    uart->state.frame_idle_counter = 0;
+    
+    if(uart->state.on_frame_callback) uart->state.on_frame_callback(size);
+}
+
+/**
+ * Учитывает принятый байт в текущем кадре.
+ * Вызывается из прерывания приёма.
+ * @param uart UART.
+ * @param data Принятый байт.
+ */
+ALWAYS_INLINE static void uart_frame_rx(uart_t* uart, uint8_t data)
+{
+    uart->state.frame_size ++;
+    uart->state.frame_idle_counter = 0;
+    
+    if(uart->state.frame_delimiter_enabled && data == uart->state.frame_delimiter){
+        uart_frame_end(uart);
+    }
+}
+#else
+#define uart_frame_rx(uart, data)
+#endif
+
+#ifndef UART_LOCK_FREE
+/**
+ * Получает флаг режима перезаписи буфера чтения.
+ * В режиме перезаписи прерывание приёма сдвигает
+ * индекс чтения, поэтому области uart_dev_peek_region
+ * недействительны и чтение без копирования недоступно.
+ * @param uart UART.
+ * @return Флаг режима перезаписи.
+ */
+ALWAYS_INLINE static bool uart_read_overwrite(uart_t* uart)
+{
+    return circular_buffer_overwrite(&uart->state.read_buffer);
+}
+#else
+#define uart_read_overwrite(uart) false
+#endif
+
+#if defined(UART_ASYNC_WRITE) || defined(UART_RS485)
+/**
+ * Сбрасывает флаг окончания передачи TXC.
+ * Флаг сбрасывается записью единицы;
+ * биты U2X и MPCM сохраняются, флаги ошибок записываются нулями.
+ * Вызывается перед разрешением прерывания окончания передачи,
+ * чтобы флаг от предыдущей передачи не вызвал его сразу.
+ * @param uart UART.
+ */
+ALWAYS_INLINE static void uart_txc_clear(uart_t* uart)
+{
+    UART_UCSRA(uart) = (UART_UCSRA(uart) & (BIT(U2X) | BIT(MPCM))) | BIT(TXC);
+}
+#endif
+
+#ifdef UART_RS485
+/**
+ * Начинает передачу по RS-485: устанавливает DE.
+ * Вызывается перед помещением данных в буфер записи.
+ * @param uart UART.
+ */
+ALWAYS_INLINE static void uart_de_begin(uart_t* uart)
+{
+    if(!uart->state.de_enabled) return;
+    
+    // Окончание передачи не должно сработать до помещения данных.
+    BIT_OFF(UART_UCSRB(uart), TXCIE);
+    uart_txc_clear(uart);
+    
+    pin_on(&uart->state.de_pin);
+}
+
+/**
+ * Завершает помещение данных для передачи по RS-485.
+ * DE снимается в прерывании окончания передачи.
+ * @param uart UART.
+ */
+ALWAYS_INLINE static void uart_de_end(uart_t* uart)
+{
+    if(uart->state.de_enabled) BIT_ON(UART_UCSRB(uart), TXCIE);
+}
+
+/**
+ * Снимает DE после освобождения сдвигового регистра.
+ * Вызывается из прерывания окончания передачи.
+ * @param uart UART.
+ */
+ALWAYS_INLINE static void uart_de_release(uart_t* uart)
+{
+    if(uart->state.de_enabled) pin_off(&uart->state.de_pin);
+}
+#else
+#define uart_de_begin(uart)
+#define uart_de_end(uart)
+#define uart_de_release(uart)
+#endif
+
+#ifdef UART_MULTIPROCESSOR
+/**
+ * Устанавливает бит MPCM.
+ * Флаг TXC сбрасывается записью единицы, поэтому не записывается.
+ * @param regs Регистры UART.
+ * @param mpcm Значение бита MPCM.
+ */
+ALWAYS_INLINE static void uart_mpcm_set(const uart_regs_t* regs, bool mpcm)
+{
+    *regs->ucsra = (*regs->ucsra & ~(BIT(TXC) | BIT(MPCM))) | (mpcm ? BIT(MPCM) : 0);
+}
+
+/**
+ * Получает флаг приёма байта адреса.
+ * Вызывается из прерывания приёма до чтения UDR.
+ * @param uart UART.
+ * @param regs Регистры UART.
+ * @return Флаг приёма байта адреса.
+ */
+ALWAYS_INLINE static bool uart_mpcm_address_frame(uart_t* uart, const uart_regs_t* regs)
+{
+    return uart->state.mpcm_enabled && BIT_TEST(*regs->ucsrb, RXB8);
+}
+
+/**
+ * Обрабатывает принятый байт адреса.
+ * Для чужого адреса включает аппаратное отбрасывание данных.
+ * @param uart UART.
+ * @param regs Регистры UART.
+ * @param address Адрес.
+ */
+ALWAYS_INLINE static void uart_mpcm_address(uart_t* uart, const uart_regs_t* regs, uint8_t address)
+{
+    if(address == uart->state.mpcm_address || address == uart->state.mpcm_broadcast){
+        uart->state.mpcm_rx_address = address;
+        uart_mpcm_set(regs, false);
+    }else{
+        uart_mpcm_set(regs, true);
+    }
+}
+#else
+#define uart_mpcm_address_frame(uart, regs) false
+#define uart_mpcm_address(uart, regs, address)
+#endif
+
+#ifdef UART_STATISTICS
+/**
+ * Учитывает принятый байт и ошибки приёма.
+ * Вызывается из прерывания приёма до чтения UDR.
+ * @param uart UART.
+ * @param status Значение регистра UCSRA.
+ */
+ALWAYS_INLINE static void uart_stat_rx(uart_t* uart, uint8_t status)
+{
+    uart->state.stats.rx_bytes ++;
+    
+    if(BIT_TEST(status, PE)) uart->state.stats.parity_errors ++;
+    if(BIT_TEST(status, FE)) uart->state.stats.frame_errors ++;
+    if(BIT_TEST(status, DOR)) uart->state.stats.overrun_errors ++;
+}
+
+/**
+ * Учитывает помещение принятого байта в буфер чтения.
+ * @param uart UART.
+ * @param stored Флаг помещения байта в буфер.
+ */
+ALWAYS_INLINE static void uart_stat_rx_stored(uart_t* uart, bool stored)
+{
+    size_t avail;
+    
+    if(!stored){
+        uart->state.stats.overrun_errors ++;
+        return;
+    }
+    
+    avail = uart_buffer_avail_size(&uart->state.read_buffer);
+    if(avail > uart->state.stats.rx_high_water) uart->state.stats.rx_high_water = avail;
+}
+
+/**
+ * Учитывает заполнение буфера записи.
+ * @param uart UART.
+ */
+ALWAYS_INLINE static void uart_stat_tx_stored(uart_t* uart)
+{
+    size_t avail = uart_buffer_avail_size(&uart->state.write_buffer);
+    
+    if(avail > uart->state.stats.tx_high_water) uart->state.stats.tx_high_water = avail;
+}
+
+/**
+ * Учитывает время запрета прерывания передачи.
+ * @param uart UART.
+ * @param time Время запрета прерывания.
+ */
+ALWAYS_INLINE static void uart_stat_tx_lock_update(uart_t* uart, uint16_t time)
+{
+    time = (uint16_t)(UART_STATISTICS_TIME()) - time;
+    
+    if(time > uart->state.stats.tx_lock_max_time) uart->state.stats.tx_lock_max_time = time;
+}
+
+//! Учитывает переданный байт.
+#define uart_stat_tx(uart) uart->state.stats.tx_bytes ++
+#else
+#define uart_stat_rx(uart, status)
+#define uart_stat_rx_stored(uart, stored)
+#define uart_stat_tx_stored(uart)
+#define uart_stat_tx(uart)
+#endif
+
+
+/*
+ * Обработчики прерываний экземпляра UART.
+ * Регистры передаются отдельно, чтобы при встраивании
+ * в прерывание конкретного экземпляра обращения
+ * к ним компилировались в прямые обращения к портам.
+ */
+
+/**
+ * Обработчик освобождения регистра данных.
+ * @param uart UART.
+ * @param regs Регистры UART.
+ */
+ALWAYS_INLINE static void uart_udre_isr(uart_t* uart, const uart_regs_t* regs)
 {
     uint8_t data;
     
-    if(circular_buffer_get(&state.write_buffer, &data)){
-        UDR = data;
+    // Если CTS снят - передача приостанавливается до uart_cts_changed().
+    if(uart_cts_asserted(uart) && uart_buffer_get(&uart->state.write_buffer, &data)){
+        *regs->udr = data;
+        uart_stat_tx(uart);
     }else{
-        BIT_OFF(UCSRB, UDRIE);
+        BIT_OFF(*regs->ucsrb, UDRIE);
     }
 }
 
-ISR(USART_RXC_vect)
+/**
+ * Обработчик приёма байта.
+ * @param uart UART.
+ * @param regs Регистры UART.
+ */
+ALWAYS_INLINE static void uart_rx_isr(uart_t* uart, const uart_regs_t* regs)
 {
     uint8_t data;
+    bool stored;
+    bool address_frame;
+    
+    // Флаги ошибок и 9й бит действительны только до чтения UDR.
+    uart_stat_rx(uart, *regs->ucsra);
+    address_frame = uart_mpcm_address_frame(uart, regs);
+    
+    data = *regs->udr;
+    
+    if(address_frame){
+        uart_mpcm_address(uart, regs, data);
+        return;
+    }
     
-    data = UDR;
+    stored = uart_buffer_put(&uart->state.read_buffer, data) != 0;
     
-    if(!circular_buffer_put(&state.read_buffer, data)){
-        state.data_overrun = true;
+    if(stored){
+        uart_frame_rx(uart, data);
+    }else{
+        uart->state.data_overrun = true;
+    }
+    uart_stat_rx_stored(uart, stored);
+    uart_rts_update_rx(uart);
+    if(uart->state.on_receive_callback) uart->state.on_receive_callback();
+}
+
+/**
+ * Обработчик окончания передачи.
+ * @param uart UART.
+ * @param regs Регистры UART.
+ */
+ALWAYS_INLINE static void uart_tx_isr(uart_t* uart, const uart_regs_t* regs)
+{
+#if defined(UART_ASYNC_WRITE) || defined(UART_RS485)
+    // Последний байт покинул сдвиговый регистр.
+    if(uart_buffer_avail_size(&uart->state.write_buffer) == 0){
+        BIT_OFF(*regs->ucsrb, TXCIE);
+        uart_de_release(uart);
+#ifdef UART_ASYNC_WRITE
+        if(future_running(&uart->state.write_future)){
+            future_finish(&uart->state.write_future, int_to_pvoid(E_NO_ERROR));
+        }
+#endif
     }
-    if(state.on_receive_callback) state.on_receive_callback();
+#endif
+}
+
+ISR(UART0_UDRE_vect)
+{
+    uart_udre_isr(UART0, &uart0_regs);
+}
+
+ISR(UART0_RX_vect)
+{
+    uart_rx_isr(UART0, &uart0_regs);
+}
+
+ISR(UART0_TX_vect)
+{
+    uart_tx_isr(UART0, &uart0_regs);
+}
+
+#ifdef UART1
+ISR(USART1_UDRE_vect)
+{
+    uart_udre_isr(UART1, &uart1_regs);
+}
+
+ISR(USART1_RX_vect)
+{
+    uart_rx_isr(UART1, &uart1_regs);
 }
 
-ISR(USART_TXC_vect)
+ISR(USART1_TX_vect)
 {
+    uart_tx_isr(UART1, &uart1_regs);
+}
+#endif
+
+err_t uart_dev_init(uart_t* uart, uint16_t hbaud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits)
+{
+    uart_baud_t baud;
+    
+    err_t err = uart_calc_baud(hbaud, &baud);
+    if(err != E_NO_ERROR) return err;
+    
+    return uart_dev_init_baud(uart, &baud, parity, stop_bits);
 }
 
-err_t uart_init(uint16_t hbaud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits)
+err_t uart_dev_init_baud(uart_t* uart, const uart_baud_t* baud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits)
 {
     if(parity == UART_PARITY_MODE_RESERVED || parity > UART_PARITY_MODE_MAX){
         return E_INVALID_VALUE;
     }
     if(stop_bits > UART_STOP_BITS_MAX) return E_INVALID_VALUE;
     
-    UCSRA = 0; // U2X = 0; MPCM = 0;
+    UART_UCSRA(uart) = 0; // U2X = 0; MPCM = 0;
     //Запрет прерываний и приёмника/передатчика,
     //Установка 2го бита размера символа в 0.
-    UCSRB = 0;
+    UART_UCSRB(uart) = 0;
     
-    err_t err = uart_set_baud(hbaud);
+    err_t err = uart_dev_set_baud_value(uart, baud);
     if(err != E_NO_ERROR) return err;
     
     //Асинхронный режим, 8 бит на символ.
-    UCSRC = (1 << URSEL) //Выбор регистра UCSRC
+    UART_UCSRC(uart) = UART_UCSRC_SELECT //Выбор регистра UCSRC
             | (((parity >> 1) & 0x1) << UPM1) //Контроль чётности, 1й бит.
             | ((parity & 0x1) << UPM0) //Контроль чётности, 0й бит.
             | ((stop_bits & 0x1) << USBS) //Число стоп-бит.
             | (1 << UCSZ1) | (1 << UCSZ0); // 8 бит на символ.
     
-    memset(&state, 0x0, sizeof(uart_state_t));
+    memset(&uart->state, 0x0, sizeof(uart_state_t));
+    
+#ifdef UART_ASYNC_WRITE
+    future_init(&uart->state.write_future);
+#endif
     
     return E_NO_ERROR;
 }
 
-err_t uart_set_baud(uint16_t hbaud)
+err_t uart_dev_set_baud(uart_t* uart, uint16_t hbaud)
 {
-    bool u2x = false;
-    uint16_t ubrr = F_CPU_HHZ_DIV16 / hbaud;
+    uart_baud_t baud;
     
-    if(ubrr <= UART_2X_UBRR_MIN){
-        u2x = true;
-        ubrr = F_CPU_HHZ_DIV8 / hbaud;
-    }
+    err_t err = uart_calc_baud(hbaud, &baud);
+    if(err != E_NO_ERROR) return err;
+    
+    return uart_dev_set_baud_value(uart, &baud);
+}
+
+/**
+ * Вычисляет значение UBRR и отклонение скорости для делителя частоты.
+ * Вычисления совпадают с UART_BAUD_VALUE().
+ * @param clocks Частота процессора, либо длительность бита в тактах.
+ * @param rate Частота бит, либо 1 для длительности бита.
+ * @param div Делитель частоты (16, либо 8 при U2X).
+ * @param baud Параметры скорости передачи.
+ * @return Флаг допустимости значения UBRR.
+ */
+static bool uart_calc_ubrr(uint32_t clocks, uint32_t rate, uint8_t div, uart_baud_t* baud)
+{
+    // Шаг UBRR.
+    uint32_t step = (uint32_t)div * rate;
+    // UBRR + 1 с округлением.
+    uint32_t n = (clocks + step / 2) / step;
+    uint32_t actual;
+    
+    if(n == 0 || n > UART_UBRR_MAX + 1) return false;
+    
+    actual = n * step;
+    
+    baud->ubrr = n - 1;
+    baud->u2x = (div == 8);
+    // Разница не превышает половины шага.
+    baud->error = (int16_t)(((int64_t)clocks - (int64_t)actual) * 10000 / (int64_t)actual);
+    
+    return true;
+}
+
+/**
+ * Вычисляет наилучшие значения UBRR и U2X для длительности бита.
+ * @param clocks Частота процессора, либо длительность бита в тактах.
+ * @param rate Частота бит, либо 1 для длительности бита.
+ * @param baud Параметры скорости передачи.
+ * @return Код ошибки.
+ */
+static err_t uart_calc_baud_period(uint32_t clocks, uint32_t rate, uart_baud_t* baud)
+{
+    uart_baud_t baud_2x;
+    
+    bool valid = uart_calc_ubrr(clocks, rate, 16, baud);
+    bool valid_2x = uart_calc_ubrr(clocks, rate, 8, &baud_2x);
     
-    if(ubrr > UART_UBRR_MAX || ubrr == 0){
+    // Без U2X приёмник делает больше выборок на бит.
+    if(valid_2x && (!valid || ABS(baud_2x.error) < ABS(baud->error))){
+        *baud = baud_2x;
+    }else if(!valid){
         return E_UART_INVALID_BAUD;
     }
     
-    ubrr --;
+    return E_NO_ERROR;
+}
+
+err_t uart_calc_baud(uint16_t hbaud, uart_baud_t* baud)
+{
+    if(baud == NULL) return E_NULL_POINTER;
+    if(hbaud == 0) return E_UART_INVALID_BAUD;
+    
+    return uart_calc_baud_period(F_CPU, (uint32_t)hbaud * 100, baud);
+}
+
+err_t uart_calc_baud_clocks(uint32_t bit_clocks, uart_baud_t* baud)
+{
+    if(baud == NULL) return E_NULL_POINTER;
+    // Заведомо больше наибольшего делителя.
+    if(bit_clocks > (uint32_t)(UART_UBRR_MAX + 1) * 16 + 8) return E_UART_INVALID_BAUD;
+    
+    return uart_calc_baud_period(bit_clocks, 1, baud);
+}
+
+err_t uart_dev_set_baud_value(uart_t* uart, const uart_baud_t* baud)
+{
+    if(baud == NULL) return E_NULL_POINTER;
+    if(baud->ubrr > UART_UBRR_MAX) return E_UART_INVALID_BAUD;
     
-    UBRRH = ubrr >> 8;
-    UBRRL = ubrr & 0xff;
+    UART_UBRRH(uart) = baud->ubrr >> 8;
+    UART_UBRRL(uart) = baud->ubrr & 0xff;
     
-    if(u2x) BIT_ON(UCSRA, U2X);
+    BIT_SET(UART_UCSRA(uart), U2X, baud->u2x);
     
     return E_NO_ERROR;
 }
 
-err_t uart_set_read_buffer(uint8_t* ptr, size_t size)
+err_t uart_dev_set_read_buffer(uart_t* uart, uint8_t* ptr, size_t size)
 {
     if(ptr == NULL) return E_NULL_POINTER;
     if(size == 0) return E_INVALID_VALUE;
     
-    circular_buffer_init(&state.read_buffer, ptr, size);
+#ifdef UART_LOCK_FREE
+    return spsc_buffer_init(&uart->state.read_buffer, ptr, size);
+#else
+    circular_buffer_init(&uart->state.read_buffer, ptr, size);
     
     return E_NO_ERROR;
+#endif
 }
 
-err_t uart_set_write_buffer(uint8_t* ptr, size_t size)
+err_t uart_dev_set_write_buffer(uart_t* uart, uint8_t* ptr, size_t size)
 {
     if(ptr == NULL) return E_NULL_POINTER;
     if(size == 0) return E_INVALID_VALUE;
     
-    circular_buffer_init(&state.write_buffer, ptr, size);
+#ifdef UART_LOCK_FREE
+    return spsc_buffer_init(&uart->state.write_buffer, ptr, size);
+#else
+    circular_buffer_init(&uart->state.write_buffer, ptr, size);
     
     return E_NO_ERROR;
+#endif
 }
 
-uart_callback_t uart_receive_callback(void)
+uart_callback_t uart_dev_receive_callback(uart_t* uart)
 {
-    return state.on_receive_callback;
+    return uart->state.on_receive_callback;
 }
 
-void uart_set_receive_callback(uart_callback_t callback)
+void uart_dev_set_receive_callback(uart_t* uart, uart_callback_t callback)
 {
-    __uart_rx_interrupts_save_disable();
+    __uart_rx_interrupts_save_disable(uart);
     
-    state.on_receive_callback = callback;
+    uart->state.on_receive_callback = callback;
     
-    __uart_rx_interrupts_restore();
+    __uart_rx_interrupts_restore(uart);
 }
 
-bool uart_transmitter_enabled(void)
+bool uart_dev_transmitter_enabled(uart_t* uart)
 {
-    return BIT_VALUE(UCSRB, TXEN);
+    return BIT_VALUE(UART_UCSRB(uart), TXEN);
 }
 
-void uart_transmitter_set_enabled(bool enabled)
+void uart_dev_transmitter_set_enabled(uart_t* uart, bool enabled)
 {
-    //BIT_SET(UCSRB, TXCIE, enabled);
-    BIT_SET(UCSRB, TXEN, enabled);
+    //BIT_SET(UART_UCSRB(uart), TXCIE, enabled);
+    BIT_SET(UART_UCSRB(uart), TXEN, enabled);
 }
 
-bool uart_receiver_enabled(void)
+bool uart_dev_receiver_enabled(uart_t* uart)
 {
-    return BIT_VALUE(UCSRB, RXEN);
+    return BIT_VALUE(UART_UCSRB(uart), RXEN);
 }
 
-void uart_receiver_set_enabled(bool enabled)
+void uart_dev_receiver_set_enabled(uart_t* uart, bool enabled)
 {
-    BIT_SET(UCSRB, RXCIE, enabled);
-    BIT_SET(UCSRB, RXEN, enabled);
+    BIT_SET(UART_UCSRB(uart), RXCIE, enabled);
+    BIT_SET(UART_UCSRB(uart), RXEN, enabled);
 }
 
-bool uart_parity_error(void)
+bool uart_dev_parity_error(uart_t* uart)
 {
-    return BIT_VALUE(UCSRA, PE);
+    return BIT_VALUE(UART_UCSRA(uart), PE);
 }
 
-bool uart_data_overrun_error(void)
+bool uart_dev_data_overrun_error(uart_t* uart)
 {
-    return BIT_VALUE(UCSRA, DOR) || state.data_overrun;
+    return BIT_VALUE(UART_UCSRA(uart), DOR) || uart->state.data_overrun;
 }
 
-bool uart_frame_error(void)
+bool uart_dev_frame_error(uart_t* uart)
 {
-    return BIT_VALUE(UCSRA, FE);
+    return BIT_VALUE(UART_UCSRA(uart), FE);
 }
 
-void uart_flush(void)
+void uart_dev_flush(uart_t* uart)
 {
-    while(circular_buffer_avail_size(&state.write_buffer) != 0);
+    while(uart_buffer_avail_size(&uart->state.write_buffer) != 0);
 }
 
-size_t uart_data_avail(void)
+size_t uart_dev_data_avail(uart_t* uart)
 {
-    return circular_buffer_avail_size(&state.read_buffer);
+    return uart_buffer_avail_size(&uart->state.read_buffer);
 }
 
-size_t uart_put(uint8_t data)
+size_t uart_dev_put(uart_t* uart, uint8_t data)
 {
     size_t res;
     
-    if(!circular_buffer_valid(&state.write_buffer) ||
-       !uart_transmitter_enabled()) return 0;
+    if(!uart_buffer_valid(&uart->state.write_buffer) ||
+       !uart_dev_transmitter_enabled(uart)) return 0;
+    
+    while(uart_buffer_free_size(&uart->state.write_buffer) == 0);
     
-    while(circular_buffer_free_size(&state.write_buffer) == 0);
+    uart_de_begin(uart);
     
-    __uart_tx_interrupts_save_disable();
+    __uart_tx_buffer_save_disable(uart);
     
-    res = circular_buffer_put(&state.write_buffer, data);
+    res = uart_buffer_put(&uart->state.write_buffer, data);
     
-    __uart_tx_interrupts_restore();
+    uart_stat_tx_stored(uart);
+    
+    __uart_tx_buffer_restore(uart);
     
     if(res != 0){
-        BIT_ON(UCSRB, UDRIE);
+        BIT_ON(UART_UCSRB(uart), UDRIE);
     }
     
+    uart_de_end(uart);
+    
     return res;
 }
 
-size_t uart_get(uint8_t* data)
+size_t uart_dev_get(uart_t* uart, uint8_t* data)
 {
     size_t res;
     
-    if(!circular_buffer_valid(&state.read_buffer) ||
-       !uart_receiver_enabled()) return 0;
+    if(!uart_buffer_valid(&uart->state.read_buffer) ||
+       !uart_dev_receiver_enabled(uart)) return 0;
     
-    __uart_rx_interrupts_save_disable();
+    __uart_rx_buffer_save_disable(uart);
     
-    res = circular_buffer_get(&state.read_buffer, data);
+    res = uart_buffer_get(&uart->state.read_buffer, data);
     
-    __uart_rx_interrupts_restore();
+    __uart_rx_buffer_restore(uart);
+    
+    uart_rts_update(uart);
     
     return res;
 }
 
-size_t uart_write(const void* data, size_t size)
+size_t uart_dev_write(uart_t* uart, const void* data, size_t size)
 {
     if(size == 0 || data == NULL) return 0;
-    if(!circular_buffer_valid(&state.write_buffer) ||
-       !uart_transmitter_enabled()) return 0;
+    if(!uart_buffer_valid(&uart->state.write_buffer) ||
+       !uart_dev_transmitter_enabled(uart)) return 0;
     
     size_t res_size = 0;
     size_t n;
     
+    uart_de_begin(uart);
+    
     do{
 
         do{
-            n = MIN(circular_buffer_free_size(&state.write_buffer), size);
+            n = MIN(uart_buffer_free_size(&uart->state.write_buffer), size);
         }while(n == 0);
 
-        __uart_tx_interrupts_save_disable();
+        __uart_tx_buffer_save_disable(uart);
 
-        n = circular_buffer_write(&state.write_buffer, data, n);
+        n = uart_buffer_write(&uart->state.write_buffer, data, n);
+        
+        uart_stat_tx_stored(uart);
 
-        __uart_tx_interrupts_restore();
+        __uart_tx_buffer_restore(uart);
 
         if(n != 0){
-            BIT_ON(UCSRB, UDRIE);
+            BIT_ON(UART_UCSRB(uart), UDRIE);
         }else{
             break;
         }
@@ -294,26 +1016,477 @@ size_t uart_write(const void* data, size_t size)
     
     }while(size > 0);
     
+    uart_de_end(uart);
+    
     return res_size;
 }
 
-size_t uart_read(void* data, size_t size)
+size_t uart_dev_read(uart_t* uart, void* data, size_t size)
 {
     if(size == 0 || data == NULL) return 0;
-    if(!circular_buffer_valid(&state.read_buffer) ||
-       !uart_receiver_enabled()) return 0;
+    if(!uart_buffer_valid(&uart->state.read_buffer) ||
+       !uart_dev_receiver_enabled(uart)) return 0;
     
     size_t res_size = 0;
     
-    __uart_rx_interrupts_save_disable();
+    __uart_rx_buffer_save_disable(uart);
+    
+    res_size = uart_buffer_read(&uart->state.read_buffer, data, size);
     
-    res_size = circular_buffer_read(&state.read_buffer, data, size);
+    __uart_rx_buffer_restore(uart);
     
-    __uart_rx_interrupts_restore();
+    uart_rts_update(uart);
     
     if(res_size != 0){
-        state.data_overrun = false;
+        uart->state.data_overrun = false;
     }
     
     return res_size;
 }
+
+size_t uart_dev_write_region(uart_t* uart, uint8_t** ptr)
+{
+    if(!uart_buffer_valid(&uart->state.write_buffer) ||
+       !uart_dev_transmitter_enabled(uart)) return 0;
+    
+    size_t res;
+    
+    __uart_tx_buffer_save_disable(uart);
+    
+    res = uart_buffer_write_region(&uart->state.write_buffer, ptr);
+    
+    __uart_tx_buffer_restore(uart);
+    
+    return res;
+}
+
+size_t uart_dev_commit(uart_t* uart, size_t size)
+{
+    if(size == 0) return 0;
+    if(!uart_buffer_valid(&uart->state.write_buffer) ||
+       !uart_dev_transmitter_enabled(uart)) return 0;
+    
+    size_t res;
+    
+    uart_de_begin(uart);
+    
+    __uart_tx_buffer_save_disable(uart);
+    
+    res = uart_buffer_commit(&uart->state.write_buffer, size);
+    
+    uart_stat_tx_stored(uart);
+    
+    __uart_tx_buffer_restore(uart);
+    
+    if(res != 0){
+        BIT_ON(UART_UCSRB(uart), UDRIE);
+    }
+    
+    uart_de_end(uart);
+    
+    return res;
+}
+
+size_t uart_dev_peek_region(uart_t* uart, const uint8_t** ptr)
+{
+    if(!uart_buffer_valid(&uart->state.read_buffer) ||
+       !uart_dev_receiver_enabled(uart)) return 0;
+    if(uart_read_overwrite(uart)) return 0;
+    
+    size_t res;
+    
+    __uart_rx_buffer_save_disable(uart);
+    
+    res = uart_buffer_peek_region(&uart->state.read_buffer, ptr);
+    
+    __uart_rx_buffer_restore(uart);
+    
+    return res;
+}
+
+size_t uart_dev_consume(uart_t* uart, size_t size)
+{
+    if(size == 0) return 0;
+    if(!uart_buffer_valid(&uart->state.read_buffer) ||
+       !uart_dev_receiver_enabled(uart)) return 0;
+    if(uart_read_overwrite(uart)) return 0;
+    
+    size_t res;
+    
+    __uart_rx_buffer_save_disable(uart);
+    
+    res = uart_buffer_consume(&uart->state.read_buffer, size);
+    
+    __uart_rx_buffer_restore(uart);
+    
+    uart_rts_update(uart);
+    
+    if(res != 0){
+        uart->state.data_overrun = false;
+    }
+    
+    return res;
+}
+
+err_t uart_dev_set_read_overwrite(uart_t* uart, bool overwrite)
+{
+#ifdef UART_LOCK_FREE
+    // Вытеснение требует изменения индекса чтения писателем.
+    if(overwrite) return E_INVALID_VALUE;
+#else
+    __uart_rx_interrupts_save_disable(uart);
+    
+    circular_buffer_set_overwrite(&uart->state.read_buffer, overwrite);
+    
+    __uart_rx_interrupts_restore(uart);
+#endif
+
+    return E_NO_ERROR;
+}
+
+size_t uart_dev_read_dropped(uart_t* uart)
+{
+    size_t res = 0;
+    
+#ifndef UART_LOCK_FREE
+    __uart_rx_interrupts_save_disable(uart);
+    
+    res = circular_buffer_dropped(&uart->state.read_buffer);
+    circular_buffer_reset_dropped(&uart->state.read_buffer);
+    
+    __uart_rx_interrupts_restore(uart);
+#endif
+
+    return res;
+}
+
+err_t uart_dev_set_read_watermarks(uart_t* uart, size_t high, size_t low, uart_watermark_callback_t callback)
+{
+#ifdef UART_WATERMARKS
+    err_t err;
+    
+    __uart_rx_interrupts_save_disable(uart);
+    
+    err = uart_buffer_set_watermarks(uart, &uart->state.read_buffer, high, low, callback);
+    
+    __uart_rx_interrupts_restore(uart);
+    
+    return err;
+#else
+    return E_INVALID_VALUE;
+#endif
+}
+
+err_t uart_dev_set_write_watermarks(uart_t* uart, size_t high, size_t low, uart_watermark_callback_t callback)
+{
+#ifdef UART_WATERMARKS
+    err_t err;
+    
+    __uart_tx_interrupts_save_disable(uart);
+    
+    err = uart_buffer_set_watermarks(uart, &uart->state.write_buffer, high, low, callback);
+    
+    __uart_tx_interrupts_restore(uart);
+    
+    return err;
+#else
+    return E_INVALID_VALUE;
+#endif
+}
+
+#ifdef UART_FLOW_CONTROL
+err_t uart_dev_set_rts(uart_t* uart, uint8_t port_n, uint8_t pin_n, size_t high, size_t low)
+{
+    if(!uart_buffer_valid(&uart->state.read_buffer)) return E_INVALID_VALUE;
+    if(high == 0 || high > uart_buffer_size(&uart->state.read_buffer)) return E_INVALID_VALUE;
+    if(low >= high) return E_INVALID_VALUE;
+    
+    err_t err = E_NO_ERROR;
+    
+    __uart_rx_interrupts_save_disable(uart);
+    
+    uart->state.rts_enabled = false;
+    
+    err = pin_init(&uart->state.rts_pin, port_n, pin_n);
+    
+    if(err == E_NO_ERROR){
+        // Передачу запрещаем до определения заполненности буфера.
+        pin_on(&uart->state.rts_pin);
+        pin_set_out(&uart->state.rts_pin);
+        
+        uart->state.rts_high = high;
+        uart->state.rts_low = low;
+        uart->state.rts_enabled = true;
+        
+        uart_rts_update(uart);
+    }
+    
+    __uart_rx_interrupts_restore(uart);
+    
+    return err;
+}
+
+err_t uart_dev_set_cts(uart_t* uart, uint8_t port_n, uint8_t pin_n)
+{
+    err_t err = E_NO_ERROR;
+    
+    __uart_tx_interrupts_save_disable(uart);
+    
+    uart->state.cts_enabled = false;
+    
+    err = pin_init(&uart->state.cts_pin, port_n, pin_n);
+    
+    if(err == E_NO_ERROR){
+        pin_set_in(&uart->state.cts_pin);
+        pin_pullup_enable(&uart->state.cts_pin);
+        
+        uart->state.cts_enabled = true;
+    }
+    
+    __uart_tx_interrupts_restore(uart);
+    
+    uart_dev_cts_changed(uart);
+    
+    return err;
+}
+
+void uart_dev_flow_control_disable(uart_t* uart)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    if(uart->state.rts_enabled){
+        uart->state.rts_enabled = false;
+        pin_off(&uart->state.rts_pin);
+    }
+    
+    __uart_rx_interrupts_restore(uart);
+    
+    uart->state.cts_enabled = false;
+    
+    uart_dev_cts_changed(uart);
+}
+
+bool uart_dev_rts_asserted(uart_t* uart)
+{
+    return uart->state.rts_enabled && pin_get_value(&uart->state.rts_pin) == 0;
+}
+
+void uart_dev_cts_changed(uart_t* uart)
+{
+    if(uart_cts_asserted(uart) &&
+       uart_buffer_avail_size(&uart->state.write_buffer) != 0){
+        BIT_ON(UART_UCSRB(uart), UDRIE);
+    }
+}
+#endif
+
+#ifdef UART_FRAME_RECEIVE
+uart_frame_callback_t uart_dev_frame_callback(uart_t* uart)
+{
+    return uart->state.on_frame_callback;
+}
+
+void uart_dev_set_frame_callback(uart_t* uart, uart_frame_callback_t callback)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    uart->state.on_frame_callback = callback;
+    
+    __uart_rx_interrupts_restore(uart);
+}
+
+void uart_dev_set_frame_delimiter(uart_t* uart, bool enabled, uint8_t delimiter)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    uart->state.frame_delimiter = delimiter;
+    uart->state.frame_delimiter_enabled = enabled;
+    
+    __uart_rx_interrupts_restore(uart);
+}
+
+void uart_dev_set_frame_idle_ticks(uart_t* uart, uint8_t ticks)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    uart->state.frame_idle_ticks = ticks;
+    uart->state.frame_idle_counter = 0;
+    
+    __uart_rx_interrupts_restore(uart);
+}
+
+void uart_dev_idle_tick(uart_t* uart)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    if(uart->state.frame_idle_ticks != 0 && uart->state.frame_size != 0){
+        if(++ uart->state.frame_idle_counter >= uart->state.frame_idle_ticks){
+            uart_frame_end(uart);
+        }
+    }
+    
+    __uart_rx_interrupts_restore(uart);
+}
+#endif
+
+#ifdef UART_ASYNC_WRITE
+size_t uart_dev_write_async(uart_t* uart, const void* data, size_t size)
+{
+    if(size == 0 || data == NULL) return 0;
+    if(!uart_buffer_valid(&uart->state.write_buffer) ||
+       !uart_dev_transmitter_enabled(uart)) return 0;
+    
+    size_t n;
+    
+    // Не даём завершить будущее до помещения данных в буфер.
+    BIT_OFF(UART_UCSRB(uart), TXCIE);
+    // Флаг от предыдущей передачи завершил бы будущее досрочно.
+    // Сброс безопасен: новые данные помещаются после него,
+    // а при полном буфере передача ещё не завершена.
+    uart_txc_clear(uart);
+    
+    uart_de_begin(uart);
+    
+    __uart_tx_buffer_save_disable(uart);
+    
+    n = MIN(uart_buffer_free_size(&uart->state.write_buffer), size);
+    if(n != 0) n = uart_buffer_write(&uart->state.write_buffer, data, n);
+    
+    uart_stat_tx_stored(uart);
+    
+    __uart_tx_buffer_restore(uart);
+    
+    if(n != 0){
+        future_start(&uart->state.write_future);
+        BIT_ON(UART_UCSRB(uart), UDRIE);
+    }
+    
+    if(future_running(&uart->state.write_future)){
+        BIT_ON(UART_UCSRB(uart), TXCIE);
+    }
+    
+    uart_de_end(uart);
+    
+    return n;
+}
+
+future_t* uart_dev_write_future(uart_t* uart)
+{
+    return &uart->state.write_future;
+}
+#endif
+
+#ifdef UART_STATISTICS
+void uart_dev_statistics(uart_t* uart, uart_statistics_t* stats)
+{
+    __interrupts_save_disable();
+    
+    memcpy(stats, &uart->state.stats, sizeof(uart_statistics_t));
+    
+    __interrupts_restore();
+}
+
+void uart_dev_reset_statistics(uart_t* uart)
+{
+    __interrupts_save_disable();
+    
+    memset(&uart->state.stats, 0x0, sizeof(uart_statistics_t));
+    
+    __interrupts_restore();
+}
+#endif
+
+#ifdef UART_MULTIPROCESSOR
+void uart_dev_set_address(uart_t* uart, uint8_t address, uint8_t broadcast)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    uart->state.mpcm_address = address;
+    uart->state.mpcm_broadcast = broadcast;
+    uart->state.mpcm_rx_address = address;
+    uart->state.mpcm_enabled = true;
+    
+    // Кадры 9 бит, данные отбрасываются до приёма своего адреса.
+    BIT_OFF(UART_UCSRB(uart), TXB8);
+    BIT_ON(UART_UCSRB(uart), UCSZ2);
+    uart_mpcm_set(uart->regs, true);
+    
+    __uart_rx_interrupts_restore(uart);
+}
+
+void uart_dev_address_disable(uart_t* uart)
+{
+    __uart_rx_interrupts_save_disable(uart);
+    
+    uart->state.mpcm_enabled = false;
+    
+    uart_mpcm_set(uart->regs, false);
+    BIT_OFF(UART_UCSRB(uart), UCSZ2);
+    
+    __uart_rx_interrupts_restore(uart);
+}
+
+uint8_t uart_dev_rx_address(uart_t* uart)
+{
+    return uart->state.mpcm_rx_address;
+}
+
+err_t uart_dev_send_address(uart_t* uart, uint8_t address)
+{
+    if(!uart->state.mpcm_enabled || !uart_dev_transmitter_enabled(uart)) return E_INVALID_VALUE;
+    
+    // Байт адреса не должен обогнать данные предыдущего сообщения.
+    uart_dev_flush(uart);
+    WAIT_WHILE_FALSE(BIT_TEST(UART_UCSRA(uart), UDRE));
+    
+    uart_de_begin(uart);
+    
+    BIT_ON(UART_UCSRB(uart), TXB8);
+    UART_UDR(uart) = address;
+    
+    // 9й бит копируется в сдвиговый регистр вместе с UDR.
+    WAIT_WHILE_FALSE(BIT_TEST(UART_UCSRA(uart), UDRE));
+    
+    BIT_OFF(UART_UCSRB(uart), TXB8);
+    
+    uart_de_end(uart);
+    
+    return E_NO_ERROR;
+}
+#endif
+
+#ifdef UART_RS485
+err_t uart_dev_set_de(uart_t* uart, uint8_t port_n, uint8_t pin_n)
+{
+    err_t err;
+    
+    // Дождёмся окончания текущей передачи.
+    uart_dev_de_disable(uart);
+    
+    err = pin_init(&uart->state.de_pin, port_n, pin_n);
+    if(err != E_NO_ERROR) return err;
+    
+    // Приём по умолчанию.
+    pin_off(&uart->state.de_pin);
+    pin_set_out(&uart->state.de_pin);
+    
+    uart->state.de_enabled = true;
+    
+    return E_NO_ERROR;
+}
+
+void uart_dev_de_disable(uart_t* uart)
+{
+    if(!uart->state.de_enabled) return;
+    
+    uart_dev_flush(uart);
+    WAIT_WHILE_TRUE(BIT_TEST(UART_UCSRB(uart), TXCIE));
+    
+    uart->state.de_enabled = false;
+}
+
+bool uart_dev_de_asserted(uart_t* uart)
+{
+    return uart->state.de_enabled && pin_get_value(&uart->state.de_pin) != 0;
+}
+#endif
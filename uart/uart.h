@@ -7,9 +7,14 @@
 #define	UART_H
 
 #include "errors/errors.h"
+#include "defs/defs.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <avr/io.h>
+#ifdef UART_ASYNC_WRITE
+#include "future/future.h"
+#endif
 
 //! Коды ошибок USART
 #define E_UART  (E_USER + 50)
@@ -35,137 +40,969 @@ typedef uint8_t uart_parity_mode_t;
 //! Тип числа стоп-битов.
 typedef uint8_t uart_stop_bits_t;
 
+/**
+ * Параметры скорости передачи UART.
+ */
+typedef struct _Uart_Baud {
+    //! Значение регистров UBRRH:UBRRL.
+    uint16_t ubrr;
+    //! Флаг удвоения скорости (U2X).
+    bool u2x;
+    //! Отклонение получаемой скорости от требуемой, сотые доли процента.
+    //! Положительное значение - скорость выше требуемой.
+    int16_t error;
+}uart_baud_t;
+
 //! Тип каллбэка.
 typedef void (*uart_callback_t)(void);
 
+/**
+ * Тип каллбэка пересечения порогов заполнения буфера UART.
+ * @param high true при достижении верхнего порога, false - нижнего.
+ */
+typedef void (*uart_watermark_callback_t)(bool high);
+
+/**
+ * Тип каллбэка приёма кадра.
+ * Кадр занимает size байт буфера чтения,
+ * следующих за данными ранее принятых кадров;
+ * при обработке кадров по порядку это первые size байт,
+ * доступные через uart_peek_region() или uart_read().
+ * @param size Размер кадра, включая разделитель.
+ */
+typedef void (*uart_frame_callback_t)(size_t size);
+
+/**
+ * Тип экземпляра UART.
+ * Содержит регистры, буферы и каллбэки одного USART.
+ */
+typedef struct _Uart uart_t;
+
+//! UART0 (единственный USART на МК с одним USART).
+extern uart_t uart0;
+//! Указатель на UART0.
+#define UART0 (&uart0)
+
+#if defined(UDR1) && !defined(UART_DISABLE_UART1)
+//! UART1.
+extern uart_t uart1;
+//! Указатель на UART1.
+#define UART1 (&uart1)
+#endif
+
+//! UART, используемый функциями без указания экземпляра.
+#ifndef UART_DEFAULT
+#define UART_DEFAULT UART0
+#endif
+
 /**
  * Инициализирует UART.
+ * @param uart UART.
  * @param hbaud Скорость передачи, гектабод.
  * @param parity Режим контроля чётности.
  * @param bits Число стоп-бит.
  * @return Код ошибки.
  */
-extern err_t uart_init(uint16_t hbaud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits);
+extern err_t uart_dev_init(uart_t* uart, uint16_t hbaud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits);
+
+//! uart_dev_init() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_init(uint16_t hbaud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits)
+{
+    return uart_dev_init(UART_DEFAULT, hbaud, parity, stop_bits);
+}
+
+/**
+ * Инициализирует UART с заданными параметрами скорости передачи.
+ * Не требует вычислений скорости во время выполнения
+ * при использовании UART_BAUD_VALUE().
+ * @param uart UART.
+ * @param baud Параметры скорости передачи.
+ * @param parity Режим контроля чётности.
+ * @param bits Число стоп-бит.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_init_baud(uart_t* uart, const uart_baud_t* baud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits);
+
+//! uart_dev_init_baud() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_init_baud(const uart_baud_t* baud, uart_parity_mode_t parity, uart_stop_bits_t stop_bits)
+{
+    return uart_dev_init_baud(UART_DEFAULT, baud, parity, stop_bits);
+}
+
+//! Инициализирует UART с постоянной скоростью, вычисленной при компиляции.
+#define uart_dev_init_const(uart, hbaud, parity, stop_bits)\
+            uart_dev_init_baud(uart, &UART_BAUD_VALUE(hbaud), parity, stop_bits)
+
+//! uart_dev_init_const() для UART по умолчанию.
+#define uart_init_const(hbaud, parity, stop_bits)\
+            uart_dev_init_const(UART_DEFAULT, hbaud, parity, stop_bits)
 
 /**
  * Устанавливает значение скорости передачи.
+ * @param uart UART.
+ * @param hbaud Скорость передачи, гектабод.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_baud(uart_t* uart, uint16_t hbaud);
+
+//! uart_dev_set_baud() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_baud(uint16_t hbaud)
+{
+    return uart_dev_set_baud(UART_DEFAULT, hbaud);
+}
+
+/**
+ * Вычисляет наилучшие значения UBRR и U2X для скорости передачи.
+ * Из режимов с U2X и без него выбирается режим
+ * с меньшим отклонением скорости, при равном - без U2X.
  * @param hbaud Скорость передачи, гектабод.
+ * @param baud Параметры скорости передачи.
+ * @return Код ошибки.
+ */
+extern err_t uart_calc_baud(uint16_t hbaud, uart_baud_t* baud);
+
+/**
+ * Вычисляет наилучшие значения UBRR и U2X
+ * для длительности бита в тактах процессора.
+ * @param bit_clocks Длительность бита, такты процессора.
+ * @param baud Параметры скорости передачи.
  * @return Код ошибки.
  */
-extern err_t uart_set_baud(uint16_t hbaud);
+extern err_t uart_calc_baud_clocks(uint32_t bit_clocks, uart_baud_t* baud);
+
+/**
+ * Устанавливает вычисленные параметры скорости передачи.
+ * @param uart UART.
+ * @param baud Параметры скорости передачи.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_baud_value(uart_t* uart, const uart_baud_t* baud);
+
+//! uart_dev_set_baud_value() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_baud_value(const uart_baud_t* baud)
+{
+    return uart_dev_set_baud_value(UART_DEFAULT, baud);
+}
+
+/*
+ * Вычисление параметров скорости передачи при компиляции.
+ * Скорость должна быть константой, F_CPU - определён.
+ * Значение UART_BAUD_VALUE(hbaud) не требует деления во время выполнения,
+ * а недопустимая скорость, либо скорость с отклонением
+ * более UART_BAUD_ERROR_MAX, приводит к ошибке компиляции
+ * (отрицательный размер массива в UART_BAUD_BUILD_CHECK).
+ */
+
+//! Максимальное допустимое отклонение скорости, сотые доли процента.
+#ifndef UART_BAUD_ERROR_MAX
+#define UART_BAUD_ERROR_MAX 200
+#endif
+
+//! Делитель частоты в режиме u2x.
+#define UART_BAUD_DIV(u2x) ((u2x) ? 8UL : 16UL)
+//! Делитель частоты на бит (UBRR + 1) с округлением.
+#define UART_BAUD_N(hbaud, u2x)\
+            ((F_CPU + UART_BAUD_DIV(u2x) * (hbaud) * 50UL) / (UART_BAUD_DIV(u2x) * (hbaud) * 100UL))
+//! Флаг допустимости делителя.
+#define UART_BAUD_N_VALID(hbaud, u2x)\
+            (UART_BAUD_N(hbaud, u2x) >= 1 && UART_BAUD_N(hbaud, u2x) <= 4096)
+//! Получаемая частота бит, умноженная на UBRR + 1 (без деления на ноль).
+#define UART_BAUD_ACTUAL(hbaud, u2x)\
+            ((int64_t)UART_BAUD_DIV(u2x) * (int64_t)(hbaud) * 100 *\
+             (int64_t)(UART_BAUD_N(hbaud, u2x) ? UART_BAUD_N(hbaud, u2x) : 1))
+//! Отклонение скорости в режиме u2x, сотые доли процента.
+#define UART_BAUD_ERROR_U2X(hbaud, u2x)\
+            ((int32_t)(((int64_t)(F_CPU) - UART_BAUD_ACTUAL(hbaud, u2x)) * 10000 / UART_BAUD_ACTUAL(hbaud, u2x)))
+//! Модуль отклонения скорости в режиме u2x.
+#define UART_BAUD_ABS_ERROR_U2X(hbaud, u2x)\
+            (UART_BAUD_ERROR_U2X(hbaud, u2x) < 0 ? -UART_BAUD_ERROR_U2X(hbaud, u2x) : UART_BAUD_ERROR_U2X(hbaud, u2x))
+
+//! Флаг удвоения скорости для наилучших параметров (аналогично uart_calc_baud()).
+#define UART_BAUD_U2X(hbaud)\
+            (UART_BAUD_N_VALID(hbaud, 1) && (!UART_BAUD_N_VALID(hbaud, 0) ||\
+             UART_BAUD_ABS_ERROR_U2X(hbaud, 1) < UART_BAUD_ABS_ERROR_U2X(hbaud, 0)))
+//! Значение UBRR для наилучших параметров.
+#define UART_BAUD_UBRR(hbaud) (UART_BAUD_N(hbaud, UART_BAUD_U2X(hbaud)) - 1)
+//! Отклонение скорости для наилучших параметров, сотые доли процента.
+#define UART_BAUD_ERROR(hbaud) UART_BAUD_ERROR_U2X(hbaud, UART_BAUD_U2X(hbaud))
+//! Флаг допустимости скорости.
+#define UART_BAUD_VALID(hbaud)\
+            (UART_BAUD_N_VALID(hbaud, UART_BAUD_U2X(hbaud)) &&\
+             UART_BAUD_ERROR(hbaud) <= UART_BAUD_ERROR_MAX &&\
+             UART_BAUD_ERROR(hbaud) >= -UART_BAUD_ERROR_MAX)
+//! Ошибка компиляции при недопустимой скорости, иначе 0.
+#define UART_BAUD_BUILD_CHECK(hbaud) (0 * sizeof(char[UART_BAUD_VALID(hbaud) ? 1 : -1]))
+
+//! Параметры скорости передачи, вычисленные при компиляции.
+#define UART_BAUD_VALUE(hbaud)\
+            ((uart_baud_t){\
+                (uint16_t)(UART_BAUD_UBRR(hbaud) + UART_BAUD_BUILD_CHECK(hbaud)),\
+                UART_BAUD_U2X(hbaud),\
+                (int16_t)UART_BAUD_ERROR(hbaud)\
+            })
 
 /**
  * Устанавливает буфер для чтения UART.
+ * При UART_LOCK_FREE размер буфера должен быть степенью двойки,
+ * не более SPSC_BUFFER_SIZE_MAX.
+ * @param uart UART.
  * @param ptr Указатель на буфер.
  * @param size Размер буфера.
  * @return Код ошибки.
  */
-extern err_t uart_set_read_buffer(uint8_t* ptr, size_t size);
+extern err_t uart_dev_set_read_buffer(uart_t* uart, uint8_t* ptr, size_t size);
+
+//! uart_dev_set_read_buffer() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_read_buffer(uint8_t* ptr, size_t size)
+{
+    return uart_dev_set_read_buffer(UART_DEFAULT, ptr, size);
+}
 
 /**
  * Устанавливает буфер для записи UART.
+ * При UART_LOCK_FREE размер буфера должен быть степенью двойки,
+ * не более SPSC_BUFFER_SIZE_MAX.
+ * @param uart UART.
  * @param ptr Указатель на буфер.
  * @param size Размер буфера.
  * @return Код ошибки.
  */
-extern err_t uart_set_write_buffer(uint8_t* ptr, size_t size);
+extern err_t uart_dev_set_write_buffer(uart_t* uart, uint8_t* ptr, size_t size);
+
+//! uart_dev_set_write_buffer() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_write_buffer(uint8_t* ptr, size_t size)
+{
+    return uart_dev_set_write_buffer(UART_DEFAULT, ptr, size);
+}
 
 /**
  * Получает каллбэк получения данных.
+ * @param uart UART.
  * @return Каллбэк получения данных.
  */
-extern uart_callback_t uart_receive_callback(void);
+extern uart_callback_t uart_dev_receive_callback(uart_t* uart);
+
+//! uart_dev_receive_callback() для UART по умолчанию.
+ALWAYS_INLINE static uart_callback_t uart_receive_callback(void)
+{
+    return uart_dev_receive_callback(UART_DEFAULT);
+}
 
 /**
  * Устанавливает каллбэк получения данных.
+ * @param uart UART.
  * @param callback Каллбэк получения данных.
  */
-extern void uart_set_receive_callback(uart_callback_t callback);
+extern void uart_dev_set_receive_callback(uart_t* uart, uart_callback_t callback);
+
+//! uart_dev_set_receive_callback() для UART по умолчанию.
+ALWAYS_INLINE static void uart_set_receive_callback(uart_callback_t callback)
+{
+    uart_dev_set_receive_callback(UART_DEFAULT, callback);
+}
 
 /**
  * Получает флаг разрешения передатчика UART.
+ * @param uart UART.
  * @return Флаг разрешения передатчика UART.
  */
-extern bool uart_transmitter_enabled(void);
+extern bool uart_dev_transmitter_enabled(uart_t* uart);
+
+//! uart_dev_transmitter_enabled() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_transmitter_enabled(void)
+{
+    return uart_dev_transmitter_enabled(UART_DEFAULT);
+}
 
 /**
  * Разрешает или запрещает передатчик UART.
+ * @param uart UART.
  * @param enabled Флаг разрешения передатчика UART.
  */
-extern void uart_transmitter_set_enabled(bool enabled);
+extern void uart_dev_transmitter_set_enabled(uart_t* uart, bool enabled);
+
+//! uart_dev_transmitter_set_enabled() для UART по умолчанию.
+ALWAYS_INLINE static void uart_transmitter_set_enabled(bool enabled)
+{
+    uart_dev_transmitter_set_enabled(UART_DEFAULT, enabled);
+}
 
 /**
  * Получает флаг разрешения приёмника UART.
+ * @param uart UART.
  * @return Флаг разрешения приёмника UART.
  */
-extern bool uart_receiver_enabled(void);
+extern bool uart_dev_receiver_enabled(uart_t* uart);
+
+//! uart_dev_receiver_enabled() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_receiver_enabled(void)
+{
+    return uart_dev_receiver_enabled(UART_DEFAULT);
+}
 
 /**
  * Разрешает или запрещает приёмника UART.
+ * @param uart UART.
  * @param enabled Флаг разрешения приёмника UART.
  */
-extern void uart_receiver_set_enabled(bool enabled);
+extern void uart_dev_receiver_set_enabled(uart_t* uart, bool enabled);
+
+//! uart_dev_receiver_set_enabled() для UART по умолчанию.
+ALWAYS_INLINE static void uart_receiver_set_enabled(bool enabled)
+{
+    uart_dev_receiver_set_enabled(UART_DEFAULT, enabled);
+}
 
 /**
  * Получает флаг ошибки чётности.
+ * @param uart UART.
  * @return Флаг ошибки чётности.
  */
-extern bool uart_parity_error(void);
+extern bool uart_dev_parity_error(uart_t* uart);
+
+//! uart_dev_parity_error() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_parity_error(void)
+{
+    return uart_dev_parity_error(UART_DEFAULT);
+}
 
 /**
  * Получает флаг ошибки переполнения.
+ * @param uart UART.
  * @return Флаг ошибки переполнения.
  */
-extern bool uart_data_overrun_error(void);
+extern bool uart_dev_data_overrun_error(uart_t* uart);
+
+//! uart_dev_data_overrun_error() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_data_overrun_error(void)
+{
+    return uart_dev_data_overrun_error(UART_DEFAULT);
+}
 
 /**
  * Получает флаг ошибки кадра.
+ * @param uart UART.
  * @return Флаг ошибки кадра.
  */
-extern bool uart_frame_error(void);
+extern bool uart_dev_frame_error(uart_t* uart);
+
+//! uart_dev_frame_error() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_frame_error(void)
+{
+    return uart_dev_frame_error(UART_DEFAULT);
+}
 
 /**
  * Ждёт окончания передачи данных по UART.
+ * @param uart UART.
  */
-extern void uart_flush(void);
+extern void uart_dev_flush(uart_t* uart);
+
+//! uart_dev_flush() для UART по умолчанию.
+ALWAYS_INLINE static void uart_flush(void)
+{
+    uart_dev_flush(UART_DEFAULT);
+}
 
 /**
  * Получает количество принятых и не считанных байт данных.
+ * @param uart UART.
  * @return Количество принятых и не считанных байт данных.
  */
-extern size_t uart_data_avail(void);
+extern size_t uart_dev_data_avail(uart_t* uart);
+
+//! uart_dev_data_avail() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_data_avail(void)
+{
+    return uart_dev_data_avail(UART_DEFAULT);
+}
 
 /**
  * Копирует байт данных для передачи по UART.
  * При необходимости ждёт освобождения буфера.
+ * @param uart UART.
  * @param data Байт данных.
  * @return Размер скопированных данных.
  */
-extern size_t uart_put(uint8_t data);
+extern size_t uart_dev_put(uart_t* uart, uint8_t data);
+
+//! uart_dev_put() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_put(uint8_t data)
+{
+    return uart_dev_put(UART_DEFAULT, data);
+}
 
 /**
  * Получает асинхронно принятый по UART байт данных.
+ * @param uart UART.
  * @param data Байт данных.
  * @return Размер скопированных данных.
  */
-extern size_t uart_get(uint8_t* data);
+extern size_t uart_dev_get(uart_t* uart, uint8_t* data);
+
+//! uart_dev_get() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_get(uint8_t* data)
+{
+    return uart_dev_get(UART_DEFAULT, data);
+}
 
 /**
  * Копирует данные в буфер для асинхронной передачи по UART.
  * Если буфера нехватает, ждёт освобождения.
+ * @param uart UART.
  * @param data Данные.
  * @param size Размер данных.
  * @return Размер скопированных для передачи байт.
  */
-extern size_t uart_write(const void* data, size_t size);
+extern size_t uart_dev_write(uart_t* uart, const void* data, size_t size);
+
+//! uart_dev_write() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_write(const void* data, size_t size)
+{
+    return uart_dev_write(UART_DEFAULT, data, size);
+}
 
 /**
  * Получает асинхронно принятые по UART данные.
+ * @param uart UART.
  * @param data Буфер для данных.
  * @param size Размер буфера.
  * @return Размер скопированных в буфер данных.
  */
-extern size_t uart_read(void* data, size_t size);
+extern size_t uart_dev_read(uart_t* uart, void* data, size_t size);
+
+//! uart_dev_read() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_read(void* data, size_t size)
+{
+    return uart_dev_read(UART_DEFAULT, data, size);
+}
+
+/**
+ * Получает непрерывную область буфера записи UART
+ * для формирования данных на месте, без копирования.
+ * Записанные данные передаются после вызова uart_commit.
+ * @param uart UART.
+ * @param ptr Указатель для адреса области.
+ * @return Размер области (ноль если места нет).
+ */
+extern size_t uart_dev_write_region(uart_t* uart, uint8_t** ptr);
+
+//! uart_dev_write_region() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_write_region(uint8_t** ptr)
+{
+    return uart_dev_write_region(UART_DEFAULT, ptr);
+}
+
+/**
+ * Передаёт данные, записанные в область,
+ * полученную uart_write_region.
+ * @param uart UART.
+ * @param size Размер записанных данных.
+ * @return Размер данных, поставленных на передачу.
+ */
+extern size_t uart_dev_commit(uart_t* uart, size_t size);
+
+//! uart_dev_commit() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_commit(size_t size)
+{
+    return uart_dev_commit(UART_DEFAULT, size);
+}
+
+/**
+ * Получает непрерывную область буфера чтения UART
+ * с принятыми данными для разбора на месте, без копирования.
+ * Недоступно в режиме перезаписи буфера чтения.
+ * @param uart UART.
+ * @param ptr Указатель для адреса области.
+ * @return Размер области (ноль если нет данных или в режиме перезаписи).
+ */
+extern size_t uart_dev_peek_region(uart_t* uart, const uint8_t** ptr);
+
+//! uart_dev_peek_region() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_peek_region(const uint8_t** ptr)
+{
+    return uart_dev_peek_region(UART_DEFAULT, ptr);
+}
+
+/**
+ * Извлекает принятые данные из буфера чтения UART без копирования.
+ * Недоступно в режиме перезаписи буфера чтения.
+ * @param uart UART.
+ * @param size Размер данных.
+ * @return Размер извлечённых данных (ноль в режиме перезаписи).
+ */
+extern size_t uart_dev_consume(uart_t* uart, size_t size);
+
+//! uart_dev_consume() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_consume(size_t size)
+{
+    return uart_dev_consume(UART_DEFAULT, size);
+}
+
+/**
+ * Устанавливает режим перезаписи буфера чтения UART.
+ * В режиме перезаписи при переполнении буфера
+ * вытесняются самые старые принятые данные,
+ * а их число учитывается счётчиком uart_read_dropped.
+ * Вытеснение из прерывания приёма сдвигает начало данных
+ * и делает недействительной область uart_dev_peek_region,
+ * поэтому в режиме перезаписи uart_dev_peek_region
+ * и uart_dev_consume возвращают ноль - данные
+ * читаются функциями с копированием (uart_dev_read, uart_dev_get).
+ * Недоступно при UART_LOCK_FREE.
+ * @param uart UART.
+ * @param overwrite Флаг режима перезаписи.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_read_overwrite(uart_t* uart, bool overwrite);
+
+//! uart_dev_set_read_overwrite() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_read_overwrite(bool overwrite)
+{
+    return uart_dev_set_read_overwrite(UART_DEFAULT, overwrite);
+}
+
+/**
+ * Получает и сбрасывает число принятых байт,
+ * вытесненных из буфера чтения в режиме перезаписи.
+ * @param uart UART.
+ * @return Число вытесненных байт.
+ */
+extern size_t uart_dev_read_dropped(uart_t* uart);
+
+//! uart_dev_read_dropped() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_read_dropped(void)
+{
+    return uart_dev_read_dropped(UART_DEFAULT);
+}
+
+/**
+ * Устанавливает пороги заполнения буфера чтения UART.
+ * Каллбэк вызывается из прерывания приёма при достижении
+ * верхнего порога (например, для приостановки передатчика)
+ * и из функций чтения при снижении до нижнего порога.
+ * Требует CIRCULAR_BUFFER_WATERMARKS, недоступно при UART_LOCK_FREE.
+ * @param uart UART.
+ * @param high Верхний порог, не более размера буфера.
+ * @param low Нижний порог, меньше верхнего.
+ * @param callback Каллбэк, NULL для отключения.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_read_watermarks(uart_t* uart, size_t high, size_t low, uart_watermark_callback_t callback);
+
+//! uart_dev_set_read_watermarks() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_read_watermarks(size_t high, size_t low, uart_watermark_callback_t callback)
+{
+    return uart_dev_set_read_watermarks(UART_DEFAULT, high, low, callback);
+}
+
+/**
+ * Устанавливает пороги заполнения буфера записи UART.
+ * Каллбэк вызывается из прерывания передачи при снижении
+ * заполнения до нижнего порога, что позволяет писателю
+ * ожидать освобождения места без опроса.
+ * Требует CIRCULAR_BUFFER_WATERMARKS, недоступно при UART_LOCK_FREE.
+ * @param uart UART.
+ * @param high Верхний порог, не более размера буфера.
+ * @param low Нижний порог, меньше верхнего.
+ * @param callback Каллбэк, NULL для отключения.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_write_watermarks(uart_t* uart, size_t high, size_t low, uart_watermark_callback_t callback);
+
+//! uart_dev_set_write_watermarks() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_write_watermarks(size_t high, size_t low, uart_watermark_callback_t callback)
+{
+    return uart_dev_set_write_watermarks(UART_DEFAULT, high, low, callback);
+}
+
+
+#ifdef UART_ASYNC_WRITE
+
+/**
+ * Копирует в буфер записи UART столько данных, сколько в нём помещается,
+ * не ожидая освобождения места.
+ * Если данные приняты, запускает будущее записи,
+ * которое завершается, когда последний байт буфера
+ * покинет сдвиговый регистр передатчика.
+ * @param uart UART.
+ * @param data Данные.
+ * @param size Размер данных.
+ * @return Размер принятых для передачи байт, остаток нужно передать позже.
+ */
+extern size_t uart_dev_write_async(uart_t* uart, const void* data, size_t size);
+
+//! uart_dev_write_async() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_write_async(const void* data, size_t size)
+{
+    return uart_dev_write_async(UART_DEFAULT, data, size);
+}
+
+/**
+ * Получает будущее асинхронной записи.
+ * Результат будущего - код ошибки.
+ * @param uart UART.
+ * @return Будущее асинхронной записи.
+ */
+extern future_t* uart_dev_write_future(uart_t* uart);
+
+//! uart_dev_write_future() для UART по умолчанию.
+ALWAYS_INLINE static future_t* uart_write_future(void)
+{
+    return uart_dev_write_future(UART_DEFAULT);
+}
+
+#endif
+
+
+#ifdef UART_FRAME_RECEIVE
+
+/**
+ * Получает каллбэк приёма кадра.
+ * @param uart UART.
+ * @return Каллбэк приёма кадра.
+ */
+extern uart_frame_callback_t uart_dev_frame_callback(uart_t* uart);
+
+//! uart_dev_frame_callback() для UART по умолчанию.
+ALWAYS_INLINE static uart_frame_callback_t uart_frame_callback(void)
+{
+    return uart_dev_frame_callback(UART_DEFAULT);
+}
+
+/**
+ * Устанавливает каллбэк приёма кадра.
+ * Вызывается однократно на кадр из прерывания приёма
+ * (по разделителю) или из uart_idle_tick() (по паузе).
+ * @param uart UART.
+ * @param callback Каллбэк приёма кадра.
+ */
+extern void uart_dev_set_frame_callback(uart_t* uart, uart_frame_callback_t callback);
+
+//! uart_dev_set_frame_callback() для UART по умолчанию.
+ALWAYS_INLINE static void uart_set_frame_callback(uart_frame_callback_t callback)
+{
+    uart_dev_set_frame_callback(UART_DEFAULT, callback);
+}
+
+/**
+ * Устанавливает байт-разделитель, завершающий кадр.
+ * @param uart UART.
+ * @param enabled Разрешение завершения кадра по разделителю.
+ * @param delimiter Байт-разделитель.
+ */
+extern void uart_dev_set_frame_delimiter(uart_t* uart, bool enabled, uint8_t delimiter);
+
+//! uart_dev_set_frame_delimiter() для UART по умолчанию.
+ALWAYS_INLINE static void uart_set_frame_delimiter(bool enabled, uint8_t delimiter)
+{
+    uart_dev_set_frame_delimiter(UART_DEFAULT, enabled, delimiter);
+}
+
+/**
+ * Устанавливает паузу между байтами, завершающую кадр.
+ * Пауза отсчитывается вызовами uart_idle_tick(),
+ * реальная длительность паузы - от (ticks - 1) до ticks периодов.
+ * @param uart UART.
+ * @param ticks Число периодов, 0 для отключения.
+ */
+extern void uart_dev_set_frame_idle_ticks(uart_t* uart, uint8_t ticks);
+
+//! uart_dev_set_frame_idle_ticks() для UART по умолчанию.
+ALWAYS_INLINE static void uart_set_frame_idle_ticks(uint8_t ticks)
+{
+    uart_dev_set_frame_idle_ticks(UART_DEFAULT, ticks);
+}
+
+/**
+ * Отсчитывает период паузы на линии приёма.
+ * Должна периодически вызываться, например из прерывания таймера.
+ * @param uart UART.
+ */
+extern void uart_dev_idle_tick(uart_t* uart);
+
+//! uart_dev_idle_tick() для UART по умолчанию.
+ALWAYS_INLINE static void uart_idle_tick(void)
+{
+    uart_dev_idle_tick(UART_DEFAULT);
+}
+
+#endif
+
+
+#ifdef UART_FLOW_CONTROL
+
+/**
+ * Включает управление потоком RTS на заданном пине.
+ * Активный уровень RTS - низкий.
+ * RTS снимается из прерывания приёма при заполнении
+ * буфера чтения до верхнего порога и устанавливается
+ * при освобождении буфера до нижнего порога.
+ * Разница порогов исключает дребезг RTS
+ * при заполнении буфера около порога.
+ * Верхний порог должен оставлять в буфере место
+ * для байт, передаваемых после снятия RTS.
+ * Буфер чтения должен быть установлен заранее.
+ * @param uart UART.
+ * @param port_n Номер порта.
+ * @param pin_n Номер пина.
+ * @param high Верхний порог заполнения буфера чтения, не более размера буфера.
+ * @param low Нижний порог заполнения буфера чтения, меньше верхнего.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_rts(uart_t* uart, uint8_t port_n, uint8_t pin_n, size_t high, size_t low);
+
+//! uart_dev_set_rts() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_rts(uint8_t port_n, uint8_t pin_n, size_t high, size_t low)
+{
+    return uart_dev_set_rts(UART_DEFAULT, port_n, pin_n, high, low);
+}
+
+/**
+ * Включает управление потоком CTS на заданном пине.
+ * Активный уровень CTS - низкий, пин подтягивается к питанию.
+ * Пока CTS снят, передача данных из буфера записи приостанавливается.
+ * @param uart UART.
+ * @param port_n Номер порта.
+ * @param pin_n Номер пина.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_cts(uart_t* uart, uint8_t port_n, uint8_t pin_n);
+
+//! uart_dev_set_cts() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_cts(uint8_t port_n, uint8_t pin_n)
+{
+    return uart_dev_set_cts(UART_DEFAULT, port_n, pin_n);
+}
+
+/**
+ * Выключает управление потоком RTS/CTS.
+ * RTS остаётся установленным.
+ * @param uart UART.
+ */
+extern void uart_dev_flow_control_disable(uart_t* uart);
+
+//! uart_dev_flow_control_disable() для UART по умолчанию.
+ALWAYS_INLINE static void uart_flow_control_disable(void)
+{
+    uart_dev_flow_control_disable(UART_DEFAULT);
+}
+
+/**
+ * Получает состояние RTS.
+ * @param uart UART.
+ * @return Флаг установленного RTS.
+ */
+extern bool uart_dev_rts_asserted(uart_t* uart);
+
+//! uart_dev_rts_asserted() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_rts_asserted(void)
+{
+    return uart_dev_rts_asserted(UART_DEFAULT);
+}
+
+/**
+ * Возобновляет передачу после установки CTS.
+ * Должна вызываться при изменении уровня CTS,
+ * например из обработчика внешнего прерывания
+ * или периодически в основном цикле.
+ * @param uart UART.
+ */
+extern void uart_dev_cts_changed(uart_t* uart);
+
+//! uart_dev_cts_changed() для UART по умолчанию.
+ALWAYS_INLINE static void uart_cts_changed(void)
+{
+    uart_dev_cts_changed(UART_DEFAULT);
+}
+
+#endif
+
+
+#ifdef UART_RS485
+
+/*
+ * Управление передатчиком RS-485 в полудуплексном режиме.
+ * DE (активный уровень - высокий) устанавливается
+ * при помещении данных в буфер записи и снимается
+ * в прерывании окончания передачи, когда сдвиговый регистр пуст.
+ */
+
+/**
+ * Включает управление DE на заданном пине.
+ * @param uart UART.
+ * @param port_n Номер порта.
+ * @param pin_n Номер пина.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_set_de(uart_t* uart, uint8_t port_n, uint8_t pin_n);
+
+//! uart_dev_set_de() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_set_de(uint8_t port_n, uint8_t pin_n)
+{
+    return uart_dev_set_de(UART_DEFAULT, port_n, pin_n);
+}
+
+/**
+ * Выключает управление DE, дождавшись окончания передачи.
+ * @param uart UART.
+ */
+extern void uart_dev_de_disable(uart_t* uart);
+
+//! uart_dev_de_disable() для UART по умолчанию.
+ALWAYS_INLINE static void uart_de_disable(void)
+{
+    uart_dev_de_disable(UART_DEFAULT);
+}
+
+/**
+ * Получает флаг установки DE.
+ * @param uart UART.
+ * @return Флаг установки DE.
+ */
+extern bool uart_dev_de_asserted(uart_t* uart);
+
+//! uart_dev_de_asserted() для UART по умолчанию.
+ALWAYS_INLINE static bool uart_de_asserted(void)
+{
+    return uart_dev_de_asserted(UART_DEFAULT);
+}
+
+#endif
+
+
+#ifdef UART_MULTIPROCESSOR
+
+/*
+ * Режим мультипроцессорного обмена (MPCM).
+ * Кадры 9 бит: 9й бит установлен у байта адреса, сброшен у данных.
+ * Пока принятый адрес не совпадает с адресом узла или широковещательным,
+ * аппаратура отбрасывает байты данных без прерывания приёма.
+ * Байты адреса в буфер чтения не помещаются.
+ */
+
+/**
+ * Включает режим мультипроцессорного обмена.
+ * Вызывается после инициализации UART.
+ * @param uart UART.
+ * @param address Адрес узла.
+ * @param broadcast Широковещательный адрес.
+ */
+extern void uart_dev_set_address(uart_t* uart, uint8_t address, uint8_t broadcast);
+
+//! uart_dev_set_address() для UART по умолчанию.
+ALWAYS_INLINE static void uart_set_address(uint8_t address, uint8_t broadcast)
+{
+    uart_dev_set_address(UART_DEFAULT, address, broadcast);
+}
+
+/**
+ * Выключает режим мультипроцессорного обмена (кадры 8 бит).
+ * @param uart UART.
+ */
+extern void uart_dev_address_disable(uart_t* uart);
+
+//! uart_dev_address_disable() для UART по умолчанию.
+ALWAYS_INLINE static void uart_address_disable(void)
+{
+    uart_dev_address_disable(UART_DEFAULT);
+}
+
+/**
+ * Получает адрес, по которому принимаются текущие данные.
+ * Позволяет отличить широковещательное сообщение.
+ * @param uart UART.
+ * @return Адрес.
+ */
+extern uint8_t uart_dev_rx_address(uart_t* uart);
+
+//! uart_dev_rx_address() для UART по умолчанию.
+ALWAYS_INLINE static uint8_t uart_rx_address(void)
+{
+    return uart_dev_rx_address(UART_DEFAULT);
+}
+
+/**
+ * Передаёт байт адреса (с установленным 9м битом).
+ * Дожидается передачи данных из буфера записи.
+ * Последующие данные адресуются выбранному узлу.
+ * @param uart UART.
+ * @param address Адрес.
+ * @return Код ошибки.
+ */
+extern err_t uart_dev_send_address(uart_t* uart, uint8_t address);
+
+//! uart_dev_send_address() для UART по умолчанию.
+ALWAYS_INLINE static err_t uart_send_address(uint8_t address)
+{
+    return uart_dev_send_address(UART_DEFAULT, address);
+}
+
+#endif
+
+
+#ifdef UART_STATISTICS
+
+/*
+ * Статистика работы UART.
+ * Время блокировки прерывания передачи измеряется
+ * в единицах источника UART_STATISTICS_TIME(),
+ * по умолчанию - счётчик таймера 1, который должен быть запущен.
+ */
+
+//! Источник времени для статистики (uint16_t).
+#ifndef UART_STATISTICS_TIME
+#define UART_STATISTICS_TIME() TCNT1
+#endif
+
+/**
+ * Статистика UART.
+ */
+typedef struct _Uart_Statistics {
+    //! Число принятых байт.
+    uint32_t rx_bytes;
+    //! Число переданных байт.
+    uint32_t tx_bytes;
+    //! Число ошибок чётности.
+    uint16_t parity_errors;
+    //! Число ошибок кадра.
+    uint16_t frame_errors;
+    //! Число переполнений (приёмника и буфера чтения).
+    uint16_t overrun_errors;
+    //! Наибольшее заполнение буфера чтения.
+    size_t rx_high_water;
+    //! Наибольшее заполнение буфера записи.
+    size_t tx_high_water;
+    //! Наибольшее время запрета прерывания передачи.
+    uint16_t tx_lock_max_time;
+}uart_statistics_t;
+
+/**
+ * Получает снимок статистики UART.
+ * @param uart UART.
+ * @param stats Статистика.
+ */
+extern void uart_dev_statistics(uart_t* uart, uart_statistics_t* stats);
+
+//! uart_dev_statistics() для UART по умолчанию.
+ALWAYS_INLINE static void uart_statistics(uart_statistics_t* stats)
+{
+    uart_dev_statistics(UART_DEFAULT, stats);
+}
+
+/**
+ * Сбрасывает статистику UART.
+ * @param uart UART.
+ */
+extern void uart_dev_reset_statistics(uart_t* uart);
+
+//! uart_dev_reset_statistics() для UART по умолчанию.
+ALWAYS_INLINE static void uart_reset_statistics(void)
+{
+    uart_dev_reset_statistics(UART_DEFAULT);
+}
+
+#endif
 
 
 #ifdef UART_STDIO
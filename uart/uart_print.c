@@ -0,0 +1,163 @@
+#include "uart_print.h"
+#include <string.h>
+#include <avr/pgmspace.h>
+
+
+//! Размер буфера форматирования: знак, 10 цифр, точка и дробная часть.
+#define UART_PRINT_BUF_SIZE (1 + 10 + 1 + UART_PRINT_DECIMALS_MAX)
+
+//! Максимальное число шестнадцатеричных цифр.
+#define UART_PRINT_HEX_DIGITS_MAX 8
+
+//! Максимальное число бит дробной части.
+#define UART_PRINT_FRACT_BITS_MAX 16
+
+
+/**
+ * Записывает десятичные цифры беззнакового числа перед указателем.
+ * @param end Указатель на позицию после последней цифры.
+ * @param value Число.
+ * @return Указатель на первую цифру.
+ */
+static char* uart_print_format_uint(char* end, uint32_t value)
+{
+    uint16_t value16;
+    
+    // Старшие разряды - 32 битным делением.
+    while(value > 0xffff){
+        *(-- end) = '0' + (value % 10);
+        value /= 10;
+    }
+    
+    // Младшие - более быстрым 16 битным.
+    value16 = (uint16_t)value;
+    do{
+        *(-- end) = '0' + (value16 % 10);
+        value16 /= 10;
+    }while(value16 != 0);
+    
+    return end;
+}
+
+size_t uart_dev_print_str(uart_t* uart, const char* str)
+{
+    if(str == NULL) return 0;
+    
+    return uart_dev_write(uart, str, strlen(str));
+}
+
+size_t uart_dev_print_str_P(uart_t* uart, const char* str)
+{
+    char buf[UART_PRINT_BUF_SIZE];
+    size_t n, written;
+    size_t res = 0;
+    
+    if(str == NULL) return 0;
+    
+    for(;;){
+        // Копируем строку из флеш-памяти частями.
+        for(n = 0; n < UART_PRINT_BUF_SIZE; n ++){
+            buf[n] = pgm_read_byte(str ++);
+            if(buf[n] == 0) break;
+        }
+        
+        written = uart_dev_write(uart, buf, n);
+        res += written;
+        
+        if(written != n || n < UART_PRINT_BUF_SIZE) break;
+    }
+    
+    return res;
+}
+
+size_t uart_dev_print_eol(uart_t* uart)
+{
+    return uart_dev_write(uart, "\r\n", 2);
+}
+
+size_t uart_dev_print_uint(uart_t* uart, uint32_t value)
+{
+    char buf[UART_PRINT_BUF_SIZE];
+    char* end = buf + UART_PRINT_BUF_SIZE;
+    char* ptr = uart_print_format_uint(end, value);
+    
+    return uart_dev_write(uart, ptr, end - ptr);
+}
+
+size_t uart_dev_print_int(uart_t* uart, int32_t value)
+{
+    char buf[UART_PRINT_BUF_SIZE];
+    char* end = buf + UART_PRINT_BUF_SIZE;
+    char* ptr;
+    
+    // Модуль без переполнения для INT32_MIN.
+    ptr = uart_print_format_uint(end, (value < 0) ? 0u - (uint32_t)value : (uint32_t)value);
+    
+    if(value < 0) *(-- ptr) = '-';
+    
+    return uart_dev_write(uart, ptr, end - ptr);
+}
+
+size_t uart_dev_print_hex(uart_t* uart, uint32_t value, uint8_t digits)
+{
+    char buf[UART_PRINT_HEX_DIGITS_MAX];
+    char* end = buf + UART_PRINT_HEX_DIGITS_MAX;
+    char* ptr = end;
+    uint8_t digit;
+    
+    if(digits > UART_PRINT_HEX_DIGITS_MAX) digits = UART_PRINT_HEX_DIGITS_MAX;
+    
+    do{
+        digit = value & 0xf;
+        *(-- ptr) = (digit < 10) ? ('0' + digit) : ('a' - 10 + digit);
+        value >>= 4;
+    }while(value != 0 || (uint8_t)(end - ptr) < digits);
+    
+    return uart_dev_write(uart, ptr, end - ptr);
+}
+
+size_t uart_dev_print_fixed(uart_t* uart, int32_t value, uint8_t fract_bits, uint8_t decimals)
+{
+    char buf[UART_PRINT_BUF_SIZE];
+    char* end = buf + UART_PRINT_BUF_SIZE;
+    char* ptr = end;
+    uint32_t abs_value, int_part, fract;
+    uint32_t scale = 1;
+    bool negative;
+    uint8_t i;
+    
+    if(fract_bits > UART_PRINT_FRACT_BITS_MAX) fract_bits = UART_PRINT_FRACT_BITS_MAX;
+    if(decimals > UART_PRINT_DECIMALS_MAX) decimals = UART_PRINT_DECIMALS_MAX;
+    
+    abs_value = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    
+    int_part = abs_value >> fract_bits;
+    fract = abs_value & (((uint32_t)1 << fract_bits) - 1);
+    
+    for(i = 0; i < decimals; i ++) scale *= 10;
+    
+    // Дробная часть в единицах последнего знака с округлением,
+    // при 16 битах дробной части и 4 знаках произведение меньше 2^30.
+    fract = (fract * scale + (((uint32_t)1 << fract_bits) >> 1)) >> fract_bits;
+    if(fract >= scale){
+        fract -= scale;
+        int_part ++;
+    }
+    
+    // Округлённый до нуля результат выводится без знака.
+    negative = value < 0 && (int_part != 0 || fract != 0);
+    
+    if(decimals != 0){
+        for(i = 0; i < decimals; i ++){
+            *(-- ptr) = '0' + (fract % 10);
+            fract /= 10;
+        }
+        *(-- ptr) = '.';
+    }
+    
+    ptr = uart_print_format_uint(ptr, int_part);
+    
+    if(negative) *(-- ptr) = '-';
+    
+    return uart_dev_write(uart, ptr, end - ptr);
+}
@@ -0,0 +1,147 @@
+/**
+ * @file uart_print.h
+ * Лёгкий форматированный вывод в UART.
+ *
+ * Замена printf для вывода строк, целых, шестнадцатеричных
+ * и чисел с фиксированной запятой без плавающей точки.
+ * Каждое значение форматируется целиком во временный буфер
+ * и помещается в буфер записи UART одной операцией,
+ * то есть с одним запретом прерывания передачи на значение,
+ * а не на каждый символ.
+ * Строки копируются в буфер записи без промежуточного буфера.
+ */
+
+#ifndef UART_PRINT_H
+#define	UART_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "uart.h"
+#include "fixed/fixed16.h"
+#include "fixed/fixed32.h"
+
+
+//! Максимальное число знаков после запятой.
+#define UART_PRINT_DECIMALS_MAX 4
+
+
+/**
+ * Выводит строку.
+ * @param uart UART.
+ * @param str Строка.
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_str(uart_t* uart, const char* str);
+
+//! uart_dev_print_str() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_str(const char* str)
+{
+    return uart_dev_print_str(UART_DEFAULT, str);
+}
+
+/**
+ * Выводит строку из флеш-памяти.
+ * @param uart UART.
+ * @param str Строка во флеш-памяти (PROGMEM).
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_str_P(uart_t* uart, const char* str);
+
+//! uart_dev_print_str_P() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_str_P(const char* str)
+{
+    return uart_dev_print_str_P(UART_DEFAULT, str);
+}
+
+/**
+ * Выводит конец строки ("\r\n").
+ * @param uart UART.
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_eol(uart_t* uart);
+
+//! uart_dev_print_eol() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_eol(void)
+{
+    return uart_dev_print_eol(UART_DEFAULT);
+}
+
+/**
+ * Выводит беззнаковое целое в десятичном виде.
+ * @param uart UART.
+ * @param value Число.
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_uint(uart_t* uart, uint32_t value);
+
+//! uart_dev_print_uint() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_uint(uint32_t value)
+{
+    return uart_dev_print_uint(UART_DEFAULT, value);
+}
+
+/**
+ * Выводит знаковое целое в десятичном виде.
+ * @param uart UART.
+ * @param value Число.
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_int(uart_t* uart, int32_t value);
+
+//! uart_dev_print_int() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_int(int32_t value)
+{
+    return uart_dev_print_int(UART_DEFAULT, value);
+}
+
+/**
+ * Выводит число в шестнадцатеричном виде.
+ * @param uart UART.
+ * @param value Число.
+ * @param digits Минимальное число цифр (дополняется нулями), не более 8.
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_hex(uart_t* uart, uint32_t value, uint8_t digits);
+
+//! uart_dev_print_hex() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_hex(uint32_t value, uint8_t digits)
+{
+    return uart_dev_print_hex(UART_DEFAULT, value, digits);
+}
+
+/**
+ * Выводит число с фиксированной запятой.
+ * Дробная часть округляется до заданного числа знаков.
+ * @param uart UART.
+ * @param value Число с фиксированной запятой.
+ * @param fract_bits Число бит дробной части, не более 16.
+ * @param decimals Число знаков после запятой, не более UART_PRINT_DECIMALS_MAX.
+ * @return Число выведенных символов.
+ */
+extern size_t uart_dev_print_fixed(uart_t* uart, int32_t value, uint8_t fract_bits, uint8_t decimals);
+
+//! uart_dev_print_fixed() для UART по умолчанию.
+ALWAYS_INLINE static size_t uart_print_fixed(int32_t value, uint8_t fract_bits, uint8_t decimals)
+{
+    return uart_dev_print_fixed(UART_DEFAULT, value, fract_bits, decimals);
+}
+
+//! Выводит число fixed16_t.
+ALWAYS_INLINE static size_t uart_print_fixed16(fixed16_t value, uint8_t decimals)
+{
+    return uart_dev_print_fixed(UART_DEFAULT, value, FIXED16_FRACT_BITS, decimals);
+}
+
+//! Выводит число fixed10_6_t.
+ALWAYS_INLINE static size_t uart_print_fixed10_6(fixed10_6_t value, uint8_t decimals)
+{
+    return uart_dev_print_fixed(UART_DEFAULT, value, FIXED10_6_FRACT_BITS, decimals);
+}
+
+//! Выводит число fixed32_t.
+ALWAYS_INLINE static size_t uart_print_fixed32(fixed32_t value, uint8_t decimals)
+{
+    return uart_dev_print_fixed(UART_DEFAULT, value, FIXED32_FRACT_BITS, decimals);
+}
+
+#endif	/* UART_PRINT_H */